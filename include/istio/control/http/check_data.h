@@ -16,7 +16,9 @@
 #ifndef ISTIO_CONTROL_HTTP_CHECK_DATA_H
 #define ISTIO_CONTROL_HTTP_CHECK_DATA_H
 
+#include <functional>
 #include <map>
+#include <set>
 #include <string>
 
 #include "google/protobuf/struct.pb.h"
@@ -25,6 +27,9 @@ namespace istio {
 namespace control {
 namespace http {
 
+// A set of lower case HTTP header names, it can be searched by string views.
+typedef std::set<std::string, std::less<>> HeaderNameSet;
+
 // The interface to extract HTTP data for Mixer check.
 // Implemented by the environment (Envoy) and used by the library.
 class CheckData {
@@ -44,6 +49,19 @@ class CheckData {
   // Get request HTTP headers
   virtual std::map<std::string, std::string> GetRequestHeaders() const = 0;
 
+  // Copy request HTTP headers into "headers".  If "names" is not null, only
+  // the headers with these names are copied.  Environments should override
+  // it to copy the selected headers without building the full header map.
+  virtual void CopyRequestHeaders(
+      const HeaderNameSet *names,
+      ::google::protobuf::Map<std::string, std::string> *headers) const {
+    for (const auto &it : GetRequestHeaders()) {
+      if (names == nullptr || names->count(it.first) > 0) {
+        (*headers)[it.first] = it.second;
+      }
+    }
+  }
+
   // Returns true if connection is mutual TLS enabled.
   virtual bool IsMutualTLS() const = 0;
 
@@ -105,6 +123,9 @@ class HeaderUpdate {
 
   // Base64 encode data, and add it as "x-istio-attributes" HTTP header.
   virtual void AddIstioAttributes(const std::string &data) = 0;
+
+  // Add base64 encoded data as "x-istio-attributes" HTTP header.
+  virtual void AddEncodedIstioAttributes(const std::string &encoded) = 0;
 };
 
 }  // namespace http
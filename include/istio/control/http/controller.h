@@ -57,6 +57,16 @@ class Controller {
     // If it is empty, destination_service is used to lookup
     // service_configs map in the HttpClientConfig.
     std::string service_config_id;
+
+    // A precomputed non-zero key identifying the per-route service config,
+    // usually its hash.  If set together with service_config, the service
+    // context is found by the key, service_config_id and
+    // AddServiceConfig() are not needed.
+    uint64_t route_key{};
+
+    // The per-route service config, it only needs to stay valid during
+    // CreateRequestHandler().
+    const ::istio::mixer::v1::config::client::ServiceConfig* service_config{};
   };
 
   // Creates a HTTP request handler.
@@ -85,6 +95,14 @@ class Controller {
     // If not set or is 0 default value, the cache size is 1000.
     int service_config_cache_size{};
 
+    // If project_report_headers is set, only the request headers referenced
+    // by Mixer policies and the headers in report_header_allowlist are
+    // reported in the request.headers and response.headers attributes.
+    // By default all headers are reported.  Check attributes always carry
+    // all request headers.
+    bool project_report_headers{};
+    std::vector<std::string> report_header_allowlist;
+
     const ::istio::utils::LocalNode& local_node;
   };
 
@@ -20,6 +20,7 @@
 #include <map>
 
 #include "google/protobuf/struct.pb.h"
+#include "include/istio/control/http/check_data.h"
 
 namespace istio {
 namespace control {
@@ -34,6 +35,18 @@ class ReportData {
   // Get response HTTP headers.
   virtual std::map<std::string, std::string> GetResponseHeaders() const = 0;
 
+  // Copy response HTTP headers into "headers".  If "names" is not null,
+  // only the headers with these names are copied.
+  virtual void CopyResponseHeaders(
+      const HeaderNameSet *names,
+      ::google::protobuf::Map<std::string, std::string> *headers) const {
+    for (const auto &it : GetResponseHeaders()) {
+      if (names == nullptr || names->count(it.first) > 0) {
+        (*headers)[it.first] = it.second;
+      }
+    }
+  }
+
   // Get tracing headers from HTTP request headers.
   virtual void GetTracingHeaders(
       std::map<std::string, std::string> &) const = 0;
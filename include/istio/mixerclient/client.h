@@ -57,7 +57,8 @@ struct Statistics {
   //
   // total_check_calls = total_check_hits + total_check_misses
   // total_check_hits = total_check_hit_accepts + total_check_hit_denies
-  // total_remote_check_calls = total_check_misses
+  // total_check_misses + total_check_cache_refreshes =
+  // total_remote_check_calls + total_coalesced_check_calls
   // total_remote_check_calls >= total_remote_check_accepts +
   // total_remote_check_denies
   //    ^ Transport errors are responsible for the >=
@@ -71,6 +72,8 @@ struct Statistics {
   uint64_t total_remote_check_calls_{0};       // 1.0
   uint64_t total_remote_check_accepts_{0};     // 1.1
   uint64_t total_remote_check_denies_{0};      // 1.1
+  uint64_t total_coalesced_check_calls_{0};
+  uint64_t total_check_cache_refreshes_{0};
 
   //
   // Quota check counters
@@ -125,6 +128,8 @@ struct Statistics {
   uint64_t total_remote_report_send_errors_{0};  // 1.1
   // Remote report calls that fail do to some other error
   uint64_t total_remote_report_other_errors_{0};  // 1.1
+  // Reports dropped because the report aggregator was full
+  uint64_t total_report_drops_{0};
 };
 
 class MixerClient {
@@ -157,6 +162,15 @@ class MixerClient {
 std::unique_ptr<MixerClient> CreateMixerClient(
     const MixerClientOptions& options);
 
+// Creates a report aggregator to be shared by the MixerClient objects of all
+// worker threads through Environment::report_aggregator.
+std::shared_ptr<ReportAggregator> CreateReportAggregator(
+    const ReportAggregatorOptions& options);
+
+// Creates a quota pool to be shared by the MixerClient objects of all worker
+// threads through Environment::quota_pool.
+std::shared_ptr<QuotaPool> CreateQuotaPool();
+
 }  // namespace mixerclient
 }  // namespace istio
 
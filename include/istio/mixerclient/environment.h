@@ -16,6 +16,8 @@
 #ifndef ISTIO_MIXERCLIENT_ENVIRONMENT_H
 #define ISTIO_MIXERCLIENT_ENVIRONMENT_H
 
+#include <memory>
+
 #include "check_response.h"
 #include "google/protobuf/stubs/status.h"
 #include "mixer/v1/mixer.pb.h"
@@ -24,6 +26,9 @@
 namespace istio {
 namespace mixerclient {
 
+class QuotaPool;
+class ReportAggregator;
+
 // Defines a function prototype used when an asynchronous transport call
 // is completed.
 // Uses UNAVAILABLE status code to indicate network failure.
@@ -49,6 +54,10 @@ using TransportReportFunc = std::function<CancelFunc(
 // Defines a function prototype to generate an UUID
 using UUIDGenerateFunc = std::function<std::string()>;
 
+// Defines a function prototype to run a function on the thread owning the
+// transport functions. It must be safe to call from any thread.
+using PostFunc = std::function<void(std::function<void()>)>;
+
 // Store functions provided by the Environments, such as
 // * transport function to make remote Check and Report calls
 // * timer function to create a timer
@@ -66,6 +75,18 @@ struct Environment {
   // UUID generating function
   UUIDGenerateFunc uuid_generate_func;
 
+  // Post function, required by report_aggregator.
+  PostFunc post_func;
+
+  // The report aggregator shared by the clients of all worker threads.
+  // If set, reports are compressed and batched by it instead of by the
+  // per-client report batch.
+  std::shared_ptr<ReportAggregator> report_aggregator;
+
+  // The quota pool shared by the clients of all worker threads.
+  // If set, the quota caches of all clients share their prefetched amounts.
+  std::shared_ptr<QuotaPool> quota_pool;
+
   // TODO: Add logging function here.
 };
 
@@ -50,10 +50,20 @@ struct CheckOptions {
 
   // Max milliseconds to sleep between retries.
   uint32_t max_retry_ms{1000};
+
+  // If > 0, an expired cache entry allowing requests is still used for up to
+  // max_stale_ms while a single background Check refreshes it.
+  uint32_t max_stale_ms{0};
+
+  // If true, a Check missing the cache waits for an in-flight remote Check
+  // with the same cache signature instead of sending its own.
+  bool coalesce_checks{true};
 };
 
 const int DEFAULT_BATCH_REPORT_MAX_ENTRIES = 100;
 const int DEFAULT_BATCH_REPORT_MAX_TIME_MS = 1000;
+const int DEFAULT_BATCH_REPORT_MIN_ENTRIES = 10;
+const int DEFAULT_BATCH_REPORT_MIN_TIME_MS = 10;
 
 // Options controlling report batch.
 struct ReportOptions {
@@ -73,6 +83,53 @@ struct ReportOptions {
 
   // Maximum milliseconds a report item stayed in the buffer for batching.
   const int max_batch_time_ms;
+
+  // If true, batched reports are delta encoded: each report only carries the
+  // attributes changed from the previous one in the batch.
+  bool delta_encoding{false};
+};
+
+const int DEFAULT_REPORT_AGGREGATOR_QUEUE_ENTRIES = 4096;
+const int DEFAULT_REPORT_AGGREGATOR_PENDING_BATCHES = 16;
+
+// Options controlling the report aggregator shared by all worker threads.
+struct ReportAggregatorOptions {
+  // Default constructor.
+  ReportAggregatorOptions()
+      : max_batch_entries(DEFAULT_BATCH_REPORT_MAX_ENTRIES),
+        max_batch_time_ms(DEFAULT_BATCH_REPORT_MAX_TIME_MS) {}
+
+  // Constructor.
+  ReportAggregatorOptions(int max_batch_entries, int max_batch_time_ms)
+      : max_batch_entries(max_batch_entries),
+        max_batch_time_ms(max_batch_time_ms) {}
+
+  // Maximum number of reports in one proxy wide batch.
+  const int max_batch_entries;
+
+  // Maximum milliseconds a report item stayed in the aggregator.
+  const int max_batch_time_ms;
+
+  // Capacity of each per-worker queue. Reports pushed into a full queue are
+  // dropped and counted.
+  int max_queue_entries{DEFAULT_REPORT_AGGREGATOR_QUEUE_ENTRIES};
+
+  // Maximum number of finished batches waiting to be sent by the worker
+  // threads. Batches finished beyond it are dropped and counted.
+  int max_pending_batches{DEFAULT_REPORT_AGGREGATOR_PENDING_BATCHES};
+
+  // If true, batched reports are delta encoded.
+  bool delta_encoding{false};
+
+  // If max_batch_bytes > 0, the batch size and the flush interval adapt to
+  // the observed load and transport latency, targeting batches of about
+  // max_batch_bytes serialized bytes. max_batch_entries and max_batch_time_ms
+  // are then upper bounds.
+  int max_batch_bytes{0};
+
+  // Lower bounds of the adaptive batch size and flush interval.
+  int min_batch_entries{DEFAULT_BATCH_REPORT_MIN_ENTRIES};
+  int min_batch_time_ms{DEFAULT_BATCH_REPORT_MIN_TIME_MS};
 };
 
 // Options controlling quota behavior.
@@ -0,0 +1,86 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ISTIO_PREFETCH_DEMAND_ESTIMATOR_H_
+#define ISTIO_PREFETCH_DEMAND_ESTIMATOR_H_
+
+#include <chrono>
+#include <memory>
+
+namespace istio {
+namespace prefetch {
+
+// Estimates the quota demand to size prefetch requests.
+// A prefetch is made when the available amount is less than half of the
+// desired amount. It is not thread safe, QuotaPrefetch calls it under its
+// lock.
+class DemandEstimator {
+ public:
+  // Define a time stamp type, the same as QuotaPrefetch::Tick.
+  typedef std::chrono::time_point<std::chrono::system_clock> Tick;
+
+  virtual ~DemandEstimator() {}
+
+  // Record the amount checked at t.
+  virtual void Inc(int amount, Tick t) = 0;
+
+  // Record the round trip time of a prefetch call responded at t.
+  virtual void OnResponse(std::chrono::milliseconds round_trip, Tick t) = 0;
+
+  // Return the desired prefetch amount at t, as if `extra` more amount had
+  // been checked at t. It does not decrease as `extra` increases.
+  virtual int Desired(int extra, Tick t) = 0;
+
+  // Return the time until which Desired() only changes with the checked
+  // amount.
+  virtual Tick NextUpdate() const = 0;
+
+  // Desire the amount checked in the last predict window, the original
+  // prefetch algorithm.
+  static std::unique_ptr<DemandEstimator> CreateWindowCount(
+      std::chrono::milliseconds predict_window, int min_amount, Tick t);
+
+  // The options of the EWMA rate estimator.
+  struct EwmaRateOptions {
+    // The interval to sample the check rate.
+    std::chrono::milliseconds interval;
+
+    // The weight of a new rate or round trip sample.
+    double weight;
+
+    // The number of standard deviations added to the average rate.
+    double deviations;
+
+    // The time to cover before a round trip time is measured.
+    std::chrono::milliseconds initial_round_trip;
+
+    // The minimum desired amount.
+    int min_amount;
+
+    // Constructor with default values.
+    EwmaRateOptions();
+  };
+
+  // Track the check rate and its variance with exponentially weighted moving
+  // averages. Desire the amount expected to be checked in two prefetch round
+  // trips, so half of it lasts until the next prefetch is responded.
+  static std::unique_ptr<DemandEstimator> CreateEwmaRate(
+      const EwmaRateOptions& options, Tick t);
+};
+
+}  // namespace prefetch
+}  // namespace istio
+
+#endif  // ISTIO_PREFETCH_DEMAND_ESTIMATOR_H_
@@ -20,6 +20,8 @@
 #include <functional>
 #include <memory>
 
+#include "include/istio/prefetch/demand_estimator.h"
+
 namespace istio {
 namespace prefetch {
 
@@ -45,6 +47,11 @@ class QuotaPrefetch {
     // negative. (Its request amount is not granted).
     std::chrono::milliseconds close_wait_window;
 
+    // Creates the estimator to size prefetch requests. If not set, the
+    // amount checked in the predict window is used, but at least the
+    // minimum prefetch amount.
+    std::function<std::unique_ptr<DemandEstimator>(Tick t)> create_estimator;
+
     // Constructor with default values.
     Options();
   };
@@ -67,6 +74,19 @@ class QuotaPrefetch {
 
   // Perform a quota check with the amount. Return true if granted.
   virtual bool Check(int amount, Tick t) = 0;
+
+  // Perform a quota check with the amount, a prefetch needed by this check is
+  // made with the given transport. Return true if granted.
+  // Checks can be called concurrently from multiple threads, if enough
+  // amount is available and no prefetch is needed, a check only takes an
+  // atomic operation.
+  virtual bool Check(int amount, TransportFunc transport, Tick t) = 0;
+
+  // Move the amount available in this object to other, which replaces it.
+  // The amounts granted later to the prefetches in flight are moved to other
+  // as well. Other has to be created by Create(), and never merged back.
+  virtual void MergeInto(const std::shared_ptr<QuotaPrefetch>& other,
+                         Tick t) = 0;
 };
 
 }  // namespace prefetch
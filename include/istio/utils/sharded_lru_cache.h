@@ -0,0 +1,301 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A thread-safe cache with the ScopedLookup style API of SimpleLRUCache,
+// meant to be shared by multiple worker threads.
+//
+// Entries are hashed into independently locked shards.  Within a shard,
+// replacement approximates LRU with the CLOCK algorithm: a hit only sets a
+// "referenced" bit on the entry, the eviction hand clears the bit and gives
+// the entry a second chance.  So a lookup only takes a shared lock of its
+// shard and never relinks a list; concurrent hits of different keys don't
+// write to shared cache lines.
+//
+// A looked up value stays valid until the ScopedLookup is destroyed, even if
+// the entry is removed or evicted from the cache in the meantime.  The value
+// is deleted once the entry is out of the cache and no lookup pins it.
+//
+// With SetAgeBasedEviction(), an entry older than the given age is treated
+// as missing by lookups, and is freed by RemoveExpiredEntries() or when its
+// shard needs room.
+
+#ifndef ISTIO_UTILS_SHARDED_LRU_CACHE_H_
+#define ISTIO_UTILS_SHARDED_LRU_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "include/istio/utils/google_macros.h"
+#include "include/istio/utils/simple_lru_cache_inl.h"
+
+namespace istio {
+namespace utils {
+
+template <typename Key, typename Value,
+          typename H = internal::SimpleLRUHash<Key>,
+          typename EQ = std::equal_to<Key> >
+class ShardedLRUCache {
+  struct Elem;
+
+ public:
+  static const int kDefaultShards = 16;
+
+  // Create a cache holding at most "total_units" units, split evenly into
+  // "num_shards" shards.  "num_shards" is rounded up to a power of two.
+  explicit ShardedLRUCache(int64_t total_units,
+                           int num_shards = kDefaultShards)
+      : max_units_(total_units), units_(0), entries_(0), max_age_(-1) {
+    int shard_bits = 0;
+    while ((1 << shard_bits) < num_shards) ++shard_bits;
+    shard_shift_ = 64 - shard_bits;
+    shards_.reset(new Shard[1 << shard_bits]);
+    num_shards_ = 1 << shard_bits;
+    shard_max_units_ = (total_units + num_shards_ - 1) / num_shards_;
+  }
+
+  ~ShardedLRUCache() { RemoveAll(); }
+
+  // Pin the value of "key", if found, until it goes out of scope.
+  // Example:
+  //   ShardedLRUCache<std::string, Foo>::ScopedLookup lookup(&cache, key);
+  //   if (lookup.Found()) {
+  //     lookup.value()->...
+  class ScopedLookup {
+   public:
+    ScopedLookup(ShardedLRUCache* cache, const Key& key)
+        : elem_(cache->Lookup(key)) {}
+    ~ScopedLookup() {
+      if (elem_ != nullptr) Unref(elem_);
+    }
+    bool Found() const { return elem_ != nullptr; }
+    Value* value() const { return elem_ ? elem_->value : nullptr; }
+
+   private:
+    Elem* const elem_;
+
+    GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ScopedLookup);
+  };
+
+  // Entries older than "seconds" are treated as expired.  A negative value
+  // disables age-based eviction.  Not thread-safe, call it before the
+  // cache is shared.
+  void SetAgeBasedEviction(double seconds) {
+    max_age_ = seconds < 0 ? -1
+                           : static_cast<int64_t>(
+                                 seconds * SimpleCycleTimer::Frequency());
+  }
+
+  // Insert "value", which occupies "units" units, for "key".  The cache
+  // takes ownership of "value".  Any old entry for "key" is removed.
+  // If the shard becomes overfull, entries are evicted in CLOCK order.
+  void Insert(const Key& key, Value* value, int64_t units) {
+    Elem* elem = new Elem(key, value, units, SimpleCycleTimer::Now());
+    Shard& shard = GetShard(key);
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+    auto it = shard.table.find(key);
+    if (it != shard.table.end()) {
+      RemoveLocked(&shard, it->second);
+    }
+    MakeRoomLocked(&shard, units, elem->insert_time);
+    elem->clock_index = shard.clock.size();
+    shard.clock.push_back(elem);
+    shard.table.emplace(key, elem);
+    shard.units += units;
+    units_ += units;
+    ++entries_;
+  }
+
+  // Remove the entry for "key".  A pinned value is deleted when its last
+  // ScopedLookup goes away.
+  void Remove(const Key& key) {
+    Shard& shard = GetShard(key);
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+    auto it = shard.table.find(key);
+    if (it != shard.table.end()) {
+      RemoveLocked(&shard, it->second);
+    }
+  }
+
+  // Remove all entries.
+  void RemoveAll() {
+    for (int i = 0; i < num_shards_; ++i) {
+      Shard& shard = shards_[i];
+      std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+      while (!shard.clock.empty()) {
+        RemoveLocked(&shard, shard.clock.back());
+      }
+    }
+  }
+
+  // Remove all entries which have exceeded the age set with
+  // SetAgeBasedEviction().
+  void RemoveExpiredEntries() {
+    if (max_age_ < 0) return;
+    int64_t now = SimpleCycleTimer::Now();
+    for (int i = 0; i < num_shards_; ++i) {
+      Shard& shard = shards_[i];
+      std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+      for (size_t j = 0; j < shard.clock.size();) {
+        if (IsExpired(shard.clock[j], now)) {
+          // The last entry is moved to j.
+          RemoveLocked(&shard, shard.clock[j]);
+        } else {
+          ++j;
+        }
+      }
+    }
+  }
+
+  // Return the units of all entries in the cache.
+  int64_t Size() const { return units_.load(std::memory_order_relaxed); }
+
+  // Return the number of entries in the cache.
+  int64_t Entries() const { return entries_.load(std::memory_order_relaxed); }
+
+  // Return the maximum size of the cache.
+  int64_t MaxSize() const { return max_units_; }
+
+  // Return the number of shards.
+  int NumShards() const { return num_shards_; }
+
+ private:
+  struct Elem {
+    Elem(const Key& key, Value* value, int64_t units, int64_t insert_time)
+        : key(key),
+          value(value),
+          units(units),
+          insert_time(insert_time),
+          clock_index(0),
+          referenced(false),
+          refs(1) {}
+    ~Elem() { delete value; }
+
+    const Key key;
+    Value* const value;
+    const int64_t units;
+    const int64_t insert_time;
+    // Position in the shard clock, guarded by the shard mutex.
+    size_t clock_index;
+    // Set by lookups, cleared by the clock hand.
+    std::atomic<bool> referenced;
+    // One for the cache membership plus one per pinning lookup.
+    std::atomic<int> refs;
+  };
+
+  struct Shard {
+    Shard() : hand(0), units(0) {}
+
+    std::shared_timed_mutex mutex;
+    std::unordered_map<Key, Elem*, H, EQ> table;
+    // The entries in clock order.
+    std::vector<Elem*> clock;
+    size_t hand;
+    int64_t units;
+  };
+
+  static void Unref(Elem* elem) {
+    if (elem->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete elem;
+    }
+  }
+
+  Shard& GetShard(const Key& key) const {
+    // Mix the hash so that the shard does not correlate with the bucket of
+    // the shard table.
+    uint64_t hash = static_cast<uint64_t>(H()(key)) * 0x9E3779B97F4A7C15ull;
+    return shards_[shard_shift_ >= 64 ? 0 : hash >> shard_shift_];
+  }
+
+  bool IsExpired(const Elem* elem, int64_t now) const {
+    return max_age_ >= 0 && now - elem->insert_time > max_age_;
+  }
+
+  Elem* Lookup(const Key& key) {
+    Shard& shard = GetShard(key);
+    std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+    auto it = shard.table.find(key);
+    if (it == shard.table.end()) {
+      return nullptr;
+    }
+    Elem* elem = it->second;
+    if (max_age_ >= 0 && IsExpired(elem, SimpleCycleTimer::Now())) {
+      return nullptr;
+    }
+    // Avoid dirtying the cache line if the bit is already set.
+    if (!elem->referenced.load(std::memory_order_relaxed)) {
+      elem->referenced.store(true, std::memory_order_relaxed);
+    }
+    elem->refs.fetch_add(1, std::memory_order_relaxed);
+    return elem;
+  }
+
+  // Take "elem" out of the shard and drop the cache reference.
+  void RemoveLocked(Shard* shard, Elem* elem) {
+    size_t index = elem->clock_index;
+    Elem* last = shard->clock.back();
+    shard->clock[index] = last;
+    last->clock_index = index;
+    shard->clock.pop_back();
+    if (shard->hand >= shard->clock.size()) {
+      shard->hand = 0;
+    }
+    shard->table.erase(elem->key);
+    shard->units -= elem->units;
+    units_ -= elem->units;
+    --entries_;
+    Unref(elem);
+  }
+
+  // Evict entries until "units" more units fit in the shard.  Expired and
+  // unreferenced entries go first; a referenced entry has its bit cleared
+  // and is skipped once.
+  void MakeRoomLocked(Shard* shard, int64_t units, int64_t now) {
+    while (!shard->clock.empty() &&
+           shard->units + units > shard_max_units_) {
+      Elem* elem = shard->clock[shard->hand];
+      if (!IsExpired(elem, now) &&
+          elem->referenced.exchange(false, std::memory_order_relaxed)) {
+        shard->hand = (shard->hand + 1) % shard->clock.size();
+      } else {
+        // The last entry is moved under the hand.
+        RemoveLocked(shard, elem);
+      }
+    }
+  }
+
+  const int64_t max_units_;
+  int64_t shard_max_units_;
+  int shard_shift_;
+  int num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+
+  std::atomic<int64_t> units_;
+  std::atomic<int64_t> entries_;
+
+  // The max age in SimpleCycleTimer cycles, -1 if disabled.
+  int64_t max_age_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ShardedLRUCache);
+};
+
+}  // namespace utils
+}  // namespace istio
+
+#endif  // ISTIO_UTILS_SHARDED_LRU_CACHE_H_
@@ -15,7 +15,6 @@
 
 #include "src/envoy/http/alpn/alpn_filter.h"
 
-#include "common/network/application_protocol.h"
 #include "envoy/upstream/cluster_manager.h"
 
 namespace Envoy {
@@ -32,9 +31,15 @@ AlpnFilterConfig::AlpnFilterConfig(
     for (const auto &protocol : pair.alpn_override()) {
       application_protocols.push_back(protocol);
     }
+    if (application_protocols.empty()) {
+      continue;
+    }
 
-    alpn_overrides_.insert({getHttpProtocol(pair.upstream_protocol()),
-                            std::move(application_protocols)});
+    // Built once, so that requests attach it without copying the list.
+    alpn_overrides_.insert(
+        {getHttpProtocol(pair.upstream_protocol()),
+         std::make_shared<Network::ApplicationProtocols>(
+             std::move(application_protocols))});
   }
 }
 
@@ -75,13 +80,12 @@ Http::FilterHeadersStatus AlpnFilter::decodeHeaders(Http::RequestHeaderMap &,
 
   Http::Protocol protocol = cluster->info()->upstreamHttpProtocol(
       decoder_callbacks_->streamInfo().protocol());
-  const auto &alpn_override = config_->alpnOverrides(protocol);
+  auto alpn_override = config_->alpnOverrides(protocol);
 
-  if (!alpn_override.empty()) {
-    ENVOY_LOG(debug, "override with {} ALPNs", alpn_override.size());
+  if (alpn_override) {
+    ENVOY_LOG(debug, "override with {} ALPNs", alpn_override->value().size());
     decoder_callbacks_->streamInfo().filterState()->setData(
-        Network::ApplicationProtocols::key(),
-        std::make_unique<Network::ApplicationProtocols>(alpn_override),
+        Network::ApplicationProtocols::key(), std::move(alpn_override),
         Envoy::StreamInfo::FilterState::StateType::ReadOnly);
   } else {
     ENVOY_LOG(debug, "ALPN override is empty");
@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include "common/network/application_protocol.h"
 #include "envoy/config/filter/http/alpn/v2alpha1/config.pb.h"
 #include "extensions/filters/http/common/pass_through_filter.h"
 
@@ -34,12 +35,15 @@ class AlpnFilterConfig {
 
   Upstream::ClusterManager &clusterManager() { return cluster_manager_; }
 
-  const std::vector<std::string> alpnOverrides(
+  // The ALPN override for an upstream protocol, nullptr if there is none.
+  // It is shared by all the requests and must not be modified.
+  std::shared_ptr<Network::ApplicationProtocols> alpnOverrides(
       const Http::Protocol &protocol) const {
-    if (alpn_overrides_.count(protocol)) {
-      return alpn_overrides_.at(protocol);
+    auto it = alpn_overrides_.find(protocol);
+    if (it != alpn_overrides_.end()) {
+      return it->second;
     }
-    return {};
+    return nullptr;
   }
 
  private:
@@ -47,7 +51,9 @@ class AlpnFilterConfig {
       const istio::envoy::config::filter::http::alpn::v2alpha1::FilterConfig::
           Protocol &protocol);
 
-  AlpnOverrides alpn_overrides_;
+  absl::flat_hash_map<Http::Protocol,
+                      std::shared_ptr<Network::ApplicationProtocols>>
+      alpn_overrides_;
   Upstream::ClusterManager &cluster_manager_;
 };
 
@@ -148,6 +148,39 @@ TEST_F(AlpnFilterTest, OverrideAlpn) {
   }
 }
 
+TEST_F(AlpnFilterTest, OverrideAlpnSharedAcrossRequests) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  ON_CALL(callbacks_, streamInfo()).WillByDefault(ReturnRef(stream_info));
+  ON_CALL(stream_info, protocol())
+      .WillByDefault(Return(Http::Protocol::Http11));
+  const AlpnOverrides alpn = {{Http::Protocol::Http11, {"baz"}}};
+  auto filter = makeAlpnOverrideFilter(alpn);
+
+  ON_CALL(cluster_manager_, get(_)).WillByDefault(Return(fake_cluster_.get()));
+  ON_CALL(*fake_cluster_, info()).WillByDefault(Return(cluster_info_));
+  ON_CALL(*cluster_info_, upstreamHttpProtocol(_))
+      .WillByDefault([](absl::optional<Http::Protocol> protocol) {
+        return protocol.value();
+      });
+
+  std::vector<const Network::ApplicationProtocols *> overrides;
+  for (int i = 0; i < 2; ++i) {
+    Envoy::StreamInfo::FilterStateSharedPtr filter_state(
+        std::make_shared<Envoy::StreamInfo::FilterStateImpl>(
+            Envoy::StreamInfo::FilterState::LifeSpan::FilterChain));
+    EXPECT_CALL(stream_info, filterState()).WillOnce(ReturnRef(filter_state));
+    EXPECT_EQ(filter->decodeHeaders(headers_, false),
+              Http::FilterHeadersStatus::Continue);
+    overrides.push_back(
+        &filter_state->getDataReadOnly<Network::ApplicationProtocols>(
+            Network::ApplicationProtocols::key()));
+  }
+
+  // Both requests reference the override built with the config.
+  EXPECT_EQ(overrides[0], overrides[1]);
+  EXPECT_EQ(overrides[0]->value(), alpn.at(Http::Protocol::Http11));
+}
+
 TEST_F(AlpnFilterTest, EmptyOverrideAlpn) {
   NiceMock<StreamInfo::MockStreamInfo> stream_info;
   ON_CALL(callbacks_, streamInfo()).WillByDefault(ReturnRef(stream_info));
@@ -18,6 +18,7 @@
 #include "common/common/assert.h"
 #include "common/config/metadata.h"
 #include "src/envoy/http/authn/authn_utils.h"
+#include "src/envoy/utils/connection_identity.h"
 #include "src/envoy/utils/filter_names.h"
 #include "src/envoy/utils/utils.h"
 
@@ -41,6 +42,18 @@ bool FindHeaderOfExchangedToken(const iaapi::Jwt& jwt) {
               LowerCaseString(jwt.jwt_headers(0)));
 }
 
+// Key of the validation of the peer certificate in the filter context.
+std::string X509ValidationKey(const iaapi::MutualTls& mtls) {
+  return "x509/" + iaapi::MutualTls::Mode_Name(mtls.mode());
+}
+
+// Key of the validation of a JWT in the filter context. The token and its
+// claims only depend on the issuer and on whether it is an exchanged token.
+std::string JwtValidationKey(const iaapi::Jwt& jwt) {
+  return (FindHeaderOfExchangedToken(jwt) ? "jwt-exchanged/" : "jwt/") +
+         jwt.issuer();
+}
+
 }  // namespace
 
 AuthenticatorBase::AuthenticatorBase(FilterContext* filter_context)
@@ -50,8 +63,10 @@ AuthenticatorBase::~AuthenticatorBase() {}
 
 bool AuthenticatorBase::validateTrustDomain(
     const Network::Connection* connection) const {
+  // HTTP requests are decoded after the TLS handshake completed.
+  const auto identity = Utils::ConnectionIdentity::get(*connection, true);
   std::string peer_trust_domain;
-  if (!Utils::GetTrustDomain(connection, true, &peer_trust_domain)) {
+  if (!identity->trustDomain(true, &peer_trust_domain)) {
     ENVOY_CONN_LOG(
         error, "trust domain validation failed: cannot get peer trust domain",
         *connection);
@@ -59,7 +74,7 @@ bool AuthenticatorBase::validateTrustDomain(
   }
 
   std::string local_trust_domain;
-  if (!Utils::GetTrustDomain(connection, false, &local_trust_domain)) {
+  if (!identity->trustDomain(false, &local_trust_domain)) {
     ENVOY_CONN_LOG(
         error, "trust domain validation failed: cannot get local trust domain",
         *connection);
@@ -80,6 +95,19 @@ bool AuthenticatorBase::validateTrustDomain(
 
 bool AuthenticatorBase::validateX509(const iaapi::MutualTls& mtls,
                                      Payload* payload) const {
+  const std::string key = X509ValidationKey(mtls);
+  const auto* cached = filter_context_.cachedValidation(key);
+  if (cached == nullptr) {
+    FilterContext::CachedValidation validation;
+    validation.success = validateX509Uncached(mtls, &validation.payload);
+    cached = &filter_context_.cacheValidation(key, std::move(validation));
+  }
+  payload->MergeFrom(cached->payload);
+  return cached->success;
+}
+
+bool AuthenticatorBase::validateX509Uncached(const iaapi::MutualTls& mtls,
+                                             Payload* payload) const {
   const Network::Connection* connection = filter_context_.connection();
   if (connection == nullptr) {
     // It's wrong if connection does not exist.
@@ -90,8 +118,8 @@ bool AuthenticatorBase::validateX509(const iaapi::MutualTls& mtls,
   const bool has_user =
       connection->ssl() != nullptr &&
       connection->ssl()->peerCertificatePresented() &&
-      Utils::GetPrincipal(connection, true,
-                          payload->mutable_x509()->mutable_user());
+      Utils::ConnectionIdentity::get(*connection, true)
+          ->principal(true, payload->mutable_x509()->mutable_user());
 
   ENVOY_CONN_LOG(debug, "validateX509 mode {}: ssl={}, has_user={}",
                  *connection, iaapi::MutualTls::Mode_Name(mtls.mode()),
@@ -122,6 +150,48 @@ bool AuthenticatorBase::validateX509(const iaapi::MutualTls& mtls,
 }
 
 bool AuthenticatorBase::validateJwt(const iaapi::Jwt& jwt, Payload* payload) {
+  const std::string key = JwtValidationKey(jwt);
+  const auto* cached = filter_context_.cachedValidation(key);
+  if (cached == nullptr) {
+    FilterContext::CachedValidation validation;
+    validation.success = validateJwtUncached(jwt, &validation.payload,
+                                             &validation.jwt_claims);
+    cached = &filter_context_.cacheValidation(key, std::move(validation));
+  }
+  payload->MergeFrom(cached->payload);
+  if (!cached->success) {
+    return false;
+  }
+  filter_context_.setJwtPayloadClaims(cached->jwt_claims);
+  return true;
+}
+
+bool AuthenticatorBase::validateJwtUncached(
+    const iaapi::Jwt& jwt, Payload* payload,
+    const ProtobufWkt::Struct** claims_out) {
+  // Prefer the claims verified by Envoy jwt_authn filter, they are read
+  // directly without a round trip through JSON.
+  const ProtobufWkt::Struct* claims =
+      filter_context()->getJwtClaimsFromEnvoyJwtFilter(jwt.issuer());
+  if (claims != nullptr) {
+    if (FindHeaderOfExchangedToken(jwt)) {
+      // The original claims of an exchanged token are used as its claims.
+      claims = AuthnUtils::FindOriginalClaims(*claims);
+      if (claims == nullptr) {
+        ENVOY_LOG(error,
+                  "Expect exchanged-token with original payload claim for "
+                  "issuer {}",
+                  jwt.issuer());
+        return false;
+      }
+    }
+    if (!AuthnUtils::ProcessJwtPayload(*claims, payload->mutable_jwt())) {
+      return false;
+    }
+    *claims_out = claims;
+    return true;
+  }
+
   std::string jwt_payload;
   if (filter_context()->getJwtPayload(jwt.issuer(), &jwt_payload)) {
     std::string payload_to_process = jwt_payload;
@@ -143,8 +213,12 @@ bool AuthenticatorBase::validateJwt(const iaapi::Jwt& jwt, Payload* payload) {
         return false;
       }
     }
-    return AuthnUtils::ProcessJwtPayload(payload_to_process,
-                                         payload->mutable_jwt());
+    if (!AuthnUtils::ProcessJwtPayload(payload_to_process,
+                                       payload->mutable_jwt())) {
+      return false;
+    }
+    *claims_out = nullptr;
+    return true;
   }
   return false;
 }
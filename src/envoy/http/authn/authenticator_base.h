@@ -57,6 +57,14 @@ class AuthenticatorBase : public Logger::Loggable<Logger::Id::filter> {
   FilterContext& filter_context_;
 
   bool validateTrustDomain(const Network::Connection* connection) const;
+
+  // Validate the credentials without the cache of the filter context.
+  bool validateX509Uncached(
+      const istio::authentication::v1alpha1::MutualTls& params,
+      istio::authn::Payload* payload) const;
+  bool validateJwtUncached(const istio::authentication::v1alpha1::Jwt& params,
+                           istio::authn::Payload* payload,
+                           const ProtobufWkt::Struct** claims_out);
 };
 
 }  // namespace AuthN
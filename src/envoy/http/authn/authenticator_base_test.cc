@@ -219,6 +219,24 @@ TEST_P(ValidateX509Test, SslConnectionWithPeerMalformedSpiffeCert) {
   EXPECT_EQ(payload_->x509().user(), "spiffe:foo");
 }
 
+TEST_P(ValidateX509Test, ValidatedOncePerRequest) {
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  ON_CALL(*ssl, peerCertificatePresented()).WillByDefault(Return(true));
+  ON_CALL(*ssl, uriSanPeerCertificate())
+      .WillByDefault(Return(std::vector<std::string>{"spiffe://td/foo"}));
+  ON_CALL(*ssl, uriSanLocalCertificate())
+      .WillByDefault(Return(std::vector<std::string>{"spiffe://td/bar"}));
+  EXPECT_CALL(Const(connection_), ssl()).WillRepeatedly(Return(ssl));
+  EXPECT_TRUE(authenticator_.validateX509(mtls_params_, payload_));
+
+  // Another authenticator of the request reuses the result.
+  EXPECT_CALL(Const(connection_), ssl()).Times(0);
+  MockAuthenticatorBase authenticator{&filter_context_};
+  Payload payload;
+  EXPECT_TRUE(authenticator.validateX509(mtls_params_, &payload));
+  EXPECT_TRUE(MessageDifferencer::Equals(*payload_, payload));
+}
+
 INSTANTIATE_TEST_SUITE_P(ValidateX509Tests, ValidateX509Test,
                          testing::Values(iaapi::MutualTls::STRICT,
                                          iaapi::MutualTls::PERMISSIVE));
@@ -435,6 +453,99 @@ TEST_F(ValidateJwtTest, OriginalPayloadOfExchangedTokenNotInIntendedHeader) {
   EXPECT_TRUE(MessageDifferencer::Equals(expected_payload, *payload_));
 }
 
+TEST_F(ValidateJwtTest, JwtClaimsFromEnvoyJwtFilter) {
+  jwt_.set_issuer("issuer@foo.com");
+  ProtobufWkt::Struct claims;
+  JsonStringToMessage(kSecIstioAuthUserinfoHeaderValue, &claims,
+                      google::protobuf::util::JsonParseOptions{});
+  (*(*dynamic_metadata_.mutable_filter_metadata())
+        [Extensions::HttpFilters::HttpFilterNames::get().JwtAuthn]
+            .mutable_fields())["issuer@foo.com"]
+      .mutable_struct_value()
+      ->CopyFrom(claims);
+
+  Payload expected_payload;
+  JsonStringToMessage(
+      R"({
+             "jwt": {
+               "user": "issuer@foo.com/sub@foo.com",
+               "audiences": ["aud1", "aud2"],
+               "claims": {
+                 "aud": ["aud1", "aud2"],
+                 "iss": ["issuer@foo.com"],
+                 "some-other-string-claims": ["some-claims-kept"],
+                 "sub": ["sub@foo.com"],
+               }
+             }
+           }
+        )",
+      &expected_payload, google::protobuf::util::JsonParseOptions{});
+
+  // The claims are read from the Struct, the raw claims are left to the
+  // origin result.
+  EXPECT_TRUE(authenticator_.validateJwt(jwt_, payload_));
+  EXPECT_TRUE(MessageDifferencer::Equals(expected_payload, *payload_));
+
+  filter_context_.setOriginResult(payload_);
+  EXPECT_FALSE(
+      filter_context_.authenticationResult().origin().raw_claims().empty());
+}
+
+TEST_F(ValidateJwtTest, ValidatedOncePerRequest) {
+  jwt_.set_issuer("issuer@foo.com");
+  ProtobufWkt::Struct claims;
+  JsonStringToMessage(kSecIstioAuthUserinfoHeaderValue, &claims,
+                      google::protobuf::util::JsonParseOptions{});
+  (*(*dynamic_metadata_.mutable_filter_metadata())
+        [Extensions::HttpFilters::HttpFilterNames::get().JwtAuthn]
+            .mutable_fields())["issuer@foo.com"]
+      .mutable_struct_value()
+      ->CopyFrom(claims);
+  EXPECT_TRUE(authenticator_.validateJwt(jwt_, payload_));
+
+  // The claims are not read again by another authenticator of the request.
+  dynamic_metadata_.clear_filter_metadata();
+  MockAuthenticatorBase authenticator{&filter_context_};
+  Payload payload;
+  EXPECT_TRUE(authenticator.validateJwt(jwt_, &payload));
+  EXPECT_TRUE(MessageDifferencer::Equals(*payload_, payload));
+
+  // An exchanged token of the same issuer is validated separately.
+  jwt_.add_jwt_headers(kExchangedTokenHeaderName);
+  EXPECT_FALSE(authenticator.validateJwt(jwt_, &payload));
+}
+
+TEST_F(ValidateJwtTest, OriginalClaimsOfExchangedTokenFromEnvoyJwtFilter) {
+  jwt_.set_issuer("token-service");
+  jwt_.add_jwt_headers(kExchangedTokenHeaderName);
+  ProtobufWkt::Struct claims;
+  JsonStringToMessage(kExchangedTokenPayload, &claims,
+                      google::protobuf::util::JsonParseOptions{});
+  (*(*dynamic_metadata_.mutable_filter_metadata())
+        [Extensions::HttpFilters::HttpFilterNames::get().JwtAuthn]
+            .mutable_fields())["token-service"]
+      .mutable_struct_value()
+      ->CopyFrom(claims);
+
+  Payload expected_payload;
+  JsonStringToMessage(
+      R"({
+             "jwt": {
+               "user": "https://accounts.example.com/example-subject",
+               "claims": {
+                 "iss": ["https://accounts.example.com"],
+                 "sub": ["example-subject"],
+                 "email": ["user@example.com"]
+               }
+             }
+           }
+        )",
+      &expected_payload, google::protobuf::util::JsonParseOptions{});
+
+  EXPECT_TRUE(authenticator_.validateJwt(jwt_, payload_));
+  EXPECT_TRUE(MessageDifferencer::Equals(expected_payload, *payload_));
+}
+
 }  // namespace
 }  // namespace AuthN
 }  // namespace Istio
@@ -19,9 +19,8 @@
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_split.h"
-#include "common/json/json_loader.h"
 #include "google/protobuf/struct.pb.h"
-#include "src/envoy/http/jwt_auth/jwt.h"
+#include "src/envoy/http/jwt_auth/jwt_claims.h"
 
 namespace Envoy {
 namespace Http {
@@ -40,56 +39,42 @@ static const std::string kExchangedTokenOriginalPayload = "original_claims";
 // A string claim is extracted as a string list of 1 item.
 // A string claim with whitespace is extracted as a string list with each
 // sub-string delimited with the whitespace.
-void ExtractStringList(const std::string& key, const Envoy::Json::Object& obj,
-                       std::vector<std::string>* list) {
-  // First, try as string
-  try {
-    // Try as string, will throw execption if object type is not string.
-    const std::vector<std::string> keys =
-        absl::StrSplit(obj.getString(key), ' ', absl::SkipEmpty());
-    for (auto key : keys) {
-      list->push_back(key);
+void ExtractStringList(const JwtAuth::JwtClaim& claim,
+                       std::vector<absl::string_view>* list) {
+  if (claim.type == JwtAuth::JwtClaim::Type::STRING) {
+    for (absl::string_view s :
+         absl::StrSplit(claim.string_value, ' ', absl::SkipEmpty())) {
+      list->push_back(s);
     }
-  } catch (Json::Exception& e) {
-    // Not convertable to string
-  }
-  // Next, try as string array
-  try {
-    std::vector<std::string> vector = obj.getStringArray(key);
-    for (const std::string v : vector) {
-      list->push_back(v);
-    }
-  } catch (Json::Exception& e) {
-    // Not convertable to string array
+  } else if (claim.is_string_list) {
+    list->insert(list->end(), claim.string_list.begin(),
+                 claim.string_list.end());
   }
 }
-};  // namespace
 
-bool AuthnUtils::ProcessJwtPayload(const std::string& payload_str,
-                                   istio::authn::JwtPayload* payload) {
-  Envoy::Json::ObjectSharedPtr json_obj;
-  try {
-    json_obj = Json::Factory::loadFromString(payload_str);
-    ENVOY_LOG(debug, "{}: json object is {}", __FUNCTION__,
-              json_obj->asJsonString());
-  } catch (...) {
-    return false;
+// Extract a claim value from Envoy jwt_authn filter as a string list, in the
+// same way as a JSON claim.
+void ExtractStringList(const ProtobufWkt::Value& value,
+                       std::vector<absl::string_view>* list) {
+  if (value.kind_case() == ProtobufWkt::Value::kStringValue) {
+    for (absl::string_view s :
+         absl::StrSplit(value.string_value(), ' ', absl::SkipEmpty())) {
+      list->push_back(s);
+    }
+  } else if (value.kind_case() == ProtobufWkt::Value::kListValue) {
+    for (const auto& v : value.list_value().values()) {
+      if (v.kind_case() != ProtobufWkt::Value::kStringValue) {
+        list->clear();
+        return;
+      }
+      list->push_back(v.string_value());
+    }
   }
+}
 
-  *payload->mutable_raw_claims() = payload_str;
-
+// Sets the audiences, user and presenter from the extracted claims.
+void SetRegisteredClaims(istio::authn::JwtPayload* payload) {
   auto claims = payload->mutable_claims()->mutable_fields();
-  // Extract claims as string lists
-  json_obj->iterate([json_obj, claims](const std::string& key,
-                                       const Json::Object&) -> bool {
-    // In current implementation, only string/string list objects are extracted
-    std::vector<std::string> list;
-    ExtractStringList(key, *json_obj, &list);
-    for (auto s : list) {
-      (*claims)[key].mutable_list_value()->add_values()->set_string_value(s);
-    }
-    return true;
-  });
   // Copy audience to the audience in context.proto
   if (claims->find(kJwtAudienceKey) != claims->end()) {
     for (const auto& v : (*claims)[kJwtAudienceKey].list_value().values()) {
@@ -109,40 +94,100 @@ bool AuthnUtils::ProcessJwtPayload(const std::string& payload_str,
     payload->set_presenter(
         (*claims)["azp"].list_value().values().Get(0).string_value());
   }
+}
+};  // namespace
+
+bool AuthnUtils::ProcessJwtPayload(const std::string& payload_str,
+                                   istio::authn::JwtPayload* payload) {
+  JwtAuth::JwtClaims jwt_claims;
+  if (!jwt_claims.Parse(payload_str)) {
+    return false;
+  }
+  ENVOY_LOG(debug, "{}: jwt payload is {}", __FUNCTION__, payload_str);
+
+  *payload->mutable_raw_claims() = payload_str;
 
+  auto claims = payload->mutable_claims()->mutable_fields();
+  // Extract claims as string lists
+  std::vector<absl::string_view> list;
+  for (const auto& claim : jwt_claims.claims()) {
+    // In current implementation, only string/string list objects are extracted
+    list.clear();
+    ExtractStringList(claim, &list);
+    if (list.empty()) {
+      continue;
+    }
+    // A duplicated claim replaces the previous one.
+    auto* list_value = (*claims)[std::string(claim.name)].mutable_list_value();
+    auto* values = list_value->mutable_values();
+    values->Clear();
+    for (absl::string_view s : list) {
+      values->Add()->set_string_value(s.data(), s.size());
+    }
+  }
+
+  SetRegisteredClaims(payload);
   return true;
 }
 
-bool AuthnUtils::ExtractOriginalPayload(const std::string& token,
-                                        std::string* original_payload) {
-  Envoy::Json::ObjectSharedPtr json_obj;
-  try {
-    json_obj = Json::Factory::loadFromString(token);
-  } catch (...) {
+bool AuthnUtils::ProcessJwtPayload(const ProtobufWkt::Struct& jwt_claims,
+                                   istio::authn::JwtPayload* payload) {
+  if (jwt_claims.fields().empty()) {
     return false;
   }
 
-  if (json_obj->hasObject(kExchangedTokenOriginalPayload) == false) {
+  auto claims = payload->mutable_claims()->mutable_fields();
+  // Extract claims as string lists
+  std::vector<absl::string_view> list;
+  for (const auto& field : jwt_claims.fields()) {
+    // In current implementation, only string/string list values are extracted
+    list.clear();
+    ExtractStringList(field.second, &list);
+    if (list.empty()) {
+      continue;
+    }
+    auto* values =
+        (*claims)[field.first].mutable_list_value()->mutable_values();
+    for (absl::string_view s : list) {
+      values->Add()->set_string_value(s.data(), s.size());
+    }
+  }
+  SetRegisteredClaims(payload);
+  return true;
+}
+
+bool AuthnUtils::ExtractOriginalPayload(const std::string& token,
+                                        std::string* original_payload) {
+  JwtAuth::JwtClaims jwt_claims;
+  if (!jwt_claims.Parse(token)) {
     return false;
   }
 
-  Envoy::Json::ObjectSharedPtr original_payload_obj;
-  try {
-    auto original_payload_obj =
-        json_obj->getObject(kExchangedTokenOriginalPayload);
-    *original_payload = original_payload_obj->asJsonString();
-    ENVOY_LOG(debug, "{}: the original payload in exchanged token is {}",
-              __FUNCTION__, *original_payload);
-  } catch (...) {
-    ENVOY_LOG(debug,
-              "{}: original_payload in exchanged token is of invalid format.",
-              __FUNCTION__);
+  const JwtAuth::JwtClaim* original_claims =
+      jwt_claims.Find(kExchangedTokenOriginalPayload);
+  if (original_claims == nullptr ||
+      original_claims->type != JwtAuth::JwtClaim::Type::OBJECT) {
     return false;
   }
 
+  // The raw JSON text of the claim is a valid JSON object.
+  original_payload->assign(original_claims->raw.data(),
+                           original_claims->raw.size());
+  ENVOY_LOG(debug, "{}: the original payload in exchanged token is {}",
+            __FUNCTION__, *original_payload);
   return true;
 }
 
+const ProtobufWkt::Struct* AuthnUtils::FindOriginalClaims(
+    const ProtobufWkt::Struct& claims) {
+  const auto it = claims.fields().find(kExchangedTokenOriginalPayload);
+  if (it == claims.fields().end() ||
+      it->second.kind_case() != ProtobufWkt::Value::kStructValue) {
+    return nullptr;
+  }
+  return &it->second.struct_value();
+}
+
 bool AuthnUtils::MatchString(absl::string_view str,
                              const iaapi::StringMatch& match) {
   switch (match.match_type_case()) {
@@ -17,6 +17,7 @@
 
 #include "authentication/v1alpha1/policy.pb.h"
 #include "common/common/logger.h"
+#include "common/protobuf/protobuf.h"
 #include "common/common/utility.h"
 #include "envoy/http/header_map.h"
 #include "envoy/json/json_object.h"
@@ -38,12 +39,23 @@ class AuthnUtils : public Logger::Loggable<Logger::Id::filter> {
   static bool ProcessJwtPayload(const std::string& jwt_payload_str,
                                 istio::authn::JwtPayload* payload);
 
+  // Populates JwtPayload object from the JWT claims verified by Envoy jwt_authn
+  // filter, without the raw JSON claims which are only serialized on demand.
+  // Returns false if there are no claims.
+  static bool ProcessJwtPayload(const ProtobufWkt::Struct& claims,
+                                istio::authn::JwtPayload* payload);
+
   // Parses the original_payload in an exchanged JWT.
   // Returns true if original_payload can be
   // parsed successfully. Otherwise, returns false.
   static bool ExtractOriginalPayload(const std::string& token,
                                      std::string* original_payload);
 
+  // Returns the original_payload claims in the claims of an exchanged JWT, or
+  // nullptr if they don't exist.
+  static const ProtobufWkt::Struct* FindOriginalClaims(
+      const ProtobufWkt::Struct& claims);
+
   // Returns true if str is matched to match.
   static bool MatchString(absl::string_view str,
                           const iaapi::StringMatch& match);
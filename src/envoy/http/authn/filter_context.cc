@@ -52,6 +52,11 @@ void FilterContext::setOriginResult(const Payload* payload) {
   // it's ok just to check jwt payload.
   if (payload != nullptr && payload->has_jwt()) {
     *result_.mutable_origin() = payload->jwt();
+    if (result_.origin().raw_claims().empty() &&
+        jwt_payload_claims_ != nullptr) {
+      Protobuf::util::MessageToJsonString(
+          *jwt_payload_claims_, result_.mutable_origin()->mutable_raw_claims());
+    }
   }
 }
 
@@ -73,43 +78,51 @@ void FilterContext::setPrincipal(const iaapi::PrincipalBinding& binding) {
   }
 }
 
+const FilterContext::CachedValidation* FilterContext::cachedValidation(
+    const std::string& key) const {
+  const auto it = validations_.find(key);
+  return it != validations_.end() ? &it->second : nullptr;
+}
+
+const FilterContext::CachedValidation& FilterContext::cacheValidation(
+    const std::string& key, CachedValidation validation) {
+  return validations_[key] = std::move(validation);
+}
+
 bool FilterContext::getJwtPayload(const std::string& issuer,
                                   std::string* payload) const {
   // Prefer to use the jwt payload from Envoy jwt filter over the Istio jwt
   // filter's one.
-  return getJwtPayloadFromEnvoyJwtFilter(issuer, payload) ||
-         getJwtPayloadFromIstioJwtFilter(issuer, payload);
+  const ProtobufWkt::Struct* claims = getJwtClaimsFromEnvoyJwtFilter(issuer);
+  if (claims != nullptr) {
+    Protobuf::util::MessageToJsonString(*claims, payload);
+    return true;
+  }
+  return getJwtPayloadFromIstioJwtFilter(issuer, payload);
 }
 
-bool FilterContext::getJwtPayloadFromEnvoyJwtFilter(
-    const std::string& issuer, std::string* payload) const {
+const ProtobufWkt::Struct* FilterContext::getJwtClaimsFromEnvoyJwtFilter(
+    const std::string& issuer) const {
   // Try getting the Jwt payload from Envoy jwt_authn filter.
   auto filter_it = dynamic_metadata_.filter_metadata().find(
       Extensions::HttpFilters::HttpFilterNames::get().JwtAuthn);
   if (filter_it == dynamic_metadata_.filter_metadata().end()) {
     ENVOY_LOG(debug, "No dynamic_metadata found for filter {}",
               Extensions::HttpFilters::HttpFilterNames::get().JwtAuthn);
-    return false;
+    return nullptr;
   }
 
   const auto& data_struct = filter_it->second;
 
   const auto entry_it = data_struct.fields().find(issuer);
   if (entry_it == data_struct.fields().end()) {
-    return false;
+    return nullptr;
   }
 
   if (entry_it->second.struct_value().fields().empty()) {
-    return false;
+    return nullptr;
   }
-
-  // Serialize the payload from Envoy jwt filter first before writing it to
-  // |payload|.
-  // TODO (pitlv2109): Return protobuf Struct instead of string, once Istio jwt
-  // filter is removed. Also need to change how Istio authn filter processes the
-  // jwt payload.
-  Protobuf::util::MessageToJsonString(entry_it->second.struct_value(), payload);
-  return true;
+  return &entry_it->second.struct_value();
 }
 
 bool FilterContext::getJwtPayloadFromIstioJwtFilter(
@@ -15,8 +15,11 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include "authentication/v1alpha1/policy.pb.h"
 #include "common/common/logger.h"
+#include "common/protobuf/protobuf.h"
 #include "envoy/config/core/v3/base.pb.h"
 #include "envoy/config/filter/http/authn/v2alpha1/config.pb.h"
 #include "envoy/http/filter.h"
@@ -33,6 +36,16 @@ namespace AuthN {
 // and result data for authentication process.
 class FilterContext : public Logger::Loggable<Logger::Id::filter> {
  public:
+  // The outcome of validating a credential, which is reused by all the peer
+  // and origin methods using the same credential in the request.
+  struct CachedValidation {
+    bool success{};
+    // The payload extracted from the credential, from an empty payload.
+    istio::authn::Payload payload;
+    // The Envoy jwt_authn filter claims a JWT payload was built from.
+    const ProtobufWkt::Struct* jwt_claims{};
+  };
+
   FilterContext(
       const envoy::config::core::v3::Metadata& dynamic_metadata,
       const RequestHeaderMap& header_map, const Network::Connection* connection,
@@ -49,9 +62,16 @@ class FilterContext : public Logger::Loggable<Logger::Id::filter> {
   void setPeerResult(const istio::authn::Payload* payload);
 
   // Sets origin result based on authenticated payload. Input payload can be
-  // null, which basically changes nothing.
+  // null, which basically changes nothing. The raw claims of a JWT payload
+  // built from Envoy jwt_authn filter claims are serialized here.
   void setOriginResult(const istio::authn::Payload* payload);
 
+  // Sets the Envoy jwt_authn filter claims the last validated JWT payload was
+  // built from, or nullptr if it was built from a JSON string.
+  void setJwtPayloadClaims(const ProtobufWkt::Struct* claims) {
+    jwt_payload_claims_ = claims;
+  }
+
   // Sets principal based on binding rule, and the existing peer and origin
   // result.
   void setPrincipal(
@@ -73,13 +93,22 @@ class FilterContext : public Logger::Loggable<Logger::Id::filter> {
   // returns false.
   bool getJwtPayload(const std::string& issuer, std::string* payload) const;
 
+  // Gets the JWT claims verified by Envoy jwt_authn filter for given issuer.
+  // Returns nullptr if there are no claims.
+  const ProtobufWkt::Struct* getJwtClaimsFromEnvoyJwtFilter(
+      const std::string& issuer) const;
+
   const RequestHeaderMap& headerMap() const { return header_map_; }
 
+  // Returns the cached validation of the credential identified by key, or
+  // nullptr if it has not been validated yet.
+  const CachedValidation* cachedValidation(const std::string& key) const;
+
+  // Caches the validation of the credential identified by key.
+  const CachedValidation& cacheValidation(const std::string& key,
+                                          CachedValidation validation);
+
  private:
-  // Helper function for getJwtPayload(). It gets the jwt payload from Envoy jwt
-  // filter metadata and write to |payload|.
-  bool getJwtPayloadFromEnvoyJwtFilter(const std::string& issuer,
-                                       std::string* payload) const;
   // Helper function for getJwtPayload(). It gets the jwt payload from Istio jwt
   // filter metadata and write to |payload|.
   bool getJwtPayloadFromIstioJwtFilter(const std::string& issuer,
@@ -99,6 +128,12 @@ class FilterContext : public Logger::Loggable<Logger::Id::filter> {
   // Holds authentication attribute outputs.
   istio::authn::Result result_;
 
+  // The Envoy jwt_authn filter claims of the last validated JWT, not owned.
+  const ProtobufWkt::Struct* jwt_payload_claims_{};
+
+  // The credentials validated in the request.
+  std::unordered_map<std::string, CachedValidation> validations_;
+
   // Store the Istio authn filter config.
   const istio::envoy::config::filter::http::authn::v2alpha1::FilterConfig&
       filter_config_;
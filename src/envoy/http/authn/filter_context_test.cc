@@ -63,6 +63,22 @@ TEST_F(FilterContextTest, SetOriginResult) {
                                       filter_context_.authenticationResult()));
 }
 
+TEST_F(FilterContextTest, SetOriginResultWithJwtPayloadClaims) {
+  ProtobufWkt::Struct claims;
+  (*claims.mutable_fields())["sub"].set_string_value("bar");
+  filter_context_.setJwtPayloadClaims(&claims);
+  filter_context_.setOriginResult(&jwt_payload_);
+  // The raw claims are serialized from the claims only for the origin.
+  EXPECT_TRUE(TestUtility::protoEqual(TestUtilities::AuthNResultFromString(R"(
+        origin {
+          user: "bar"
+          presenter: "istio.io"
+          raw_claims: "{\"sub\":\"bar\"}"
+        }
+      )"),
+                                      filter_context_.authenticationResult()));
+}
+
 TEST_F(FilterContextTest, SetBoth) {
   filter_context_.setPeerResult(&x509_payload_);
   filter_context_.setOriginResult(&jwt_payload_);
@@ -41,7 +41,14 @@ struct RcDetailsValues {
 typedef ConstSingleton<RcDetailsValues> RcDetails;
 
 AuthenticationFilter::AuthenticationFilter(const FilterConfig& filter_config)
-    : filter_config_(filter_config) {}
+    : AuthenticationFilter(filter_config, std::make_shared<JwtTriggerMatcher>(
+                                              filter_config.policy())) {}
+
+AuthenticationFilter::AuthenticationFilter(
+    const FilterConfig& filter_config,
+    std::shared_ptr<const JwtTriggerMatcher> jwt_trigger_matcher)
+    : filter_config_(filter_config),
+      jwt_trigger_matcher_(std::move(jwt_trigger_matcher)) {}
 
 AuthenticationFilter::~AuthenticationFilter() {}
 
@@ -131,7 +138,7 @@ std::unique_ptr<Istio::AuthN::AuthenticatorBase>
 AuthenticationFilter::createOriginAuthenticator(
     Istio::AuthN::FilterContext* filter_context) {
   return std::make_unique<Istio::AuthN::OriginAuthenticator>(
-      filter_context, filter_config_.policy());
+      filter_context, filter_config_.policy(), jwt_trigger_matcher_);
 }
 
 }  // namespace AuthN
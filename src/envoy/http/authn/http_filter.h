@@ -20,6 +20,7 @@
 #include "envoy/http/filter.h"
 #include "src/envoy/http/authn/authenticator_base.h"
 #include "src/envoy/http/authn/filter_context.h"
+#include "src/envoy/http/authn/jwt_trigger_matcher.h"
 
 namespace Envoy {
 namespace Http {
@@ -33,6 +34,12 @@ class AuthenticationFilter : public StreamDecoderFilter,
   AuthenticationFilter(
       const istio::envoy::config::filter::http::authn::v2alpha1::FilterConfig&
           config);
+  // Uses the origin trigger rules of config compiled in jwt_trigger_matcher,
+  // which is shared by the filters of the same config.
+  AuthenticationFilter(
+      const istio::envoy::config::filter::http::authn::v2alpha1::FilterConfig&
+          config,
+      std::shared_ptr<const JwtTriggerMatcher> jwt_trigger_matcher);
   ~AuthenticationFilter();
 
   // Http::StreamFilterBase
@@ -68,6 +75,9 @@ class AuthenticationFilter : public StreamDecoderFilter,
   const istio::envoy::config::filter::http::authn::v2alpha1::FilterConfig&
       filter_config_;
 
+  // The compiled trigger rules of the origin JWTs.
+  std::shared_ptr<const JwtTriggerMatcher> jwt_trigger_matcher_;
+
   StreamDecoderFilterCallbacks* decoder_callbacks_{};
 
   enum State { INIT, PROCESSING, COMPLETE, REJECTED };
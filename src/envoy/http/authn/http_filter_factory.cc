@@ -56,15 +56,19 @@ class AuthnFilterConfig : public NamedHttpFilterConfigFactory,
     // TODO(incfly): add a test to simulate different config can be handled
     // correctly similar to multiplexing on different port.
     auto filter_config = std::make_shared<FilterConfig>(config_pb);
+    // The trigger rules are compiled once for all the requests.
+    auto jwt_trigger_matcher =
+        std::make_shared<const Http::Istio::AuthN::JwtTriggerMatcher>(
+            filter_config->policy());
     // Print a log to remind user to upgrade to the mTLS setting. This will only
     // be called when a new config is received by Envoy.
     warnPermissiveMode(*filter_config);
-    return
-        [filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-          callbacks.addStreamDecoderFilter(
-              std::make_shared<Http::Istio::AuthN::AuthenticationFilter>(
-                  *filter_config));
-        };
+    return [filter_config, jwt_trigger_matcher](
+               Http::FilterChainFactoryCallbacks& callbacks) -> void {
+      callbacks.addStreamDecoderFilter(
+          std::make_shared<Http::Istio::AuthN::AuthenticationFilter>(
+              *filter_config, jwt_trigger_matcher));
+    };
   }
 
   void warnPermissiveMode(const FilterConfig& filter_config) {
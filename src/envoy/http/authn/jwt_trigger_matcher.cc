@@ -0,0 +1,175 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/http/authn/jwt_trigger_matcher.h"
+
+namespace iaapi = istio::authentication::v1alpha1;
+
+namespace Envoy {
+namespace Http {
+namespace Istio {
+namespace AuthN {
+
+JwtTriggerMatcher::JwtTriggerMatcher(const iaapi::Policy& policy)
+    : origins_(policy.origins_size()), prefix_trie_(1), suffix_trie_(1) {
+  for (int origin = 0; origin < policy.origins_size(); ++origin) {
+    const auto& jwt = policy.origins(origin).jwt();
+    if (jwt.trigger_rules_size() == 0) {
+      untriggered_origins_.push_back(origin);
+      continue;
+    }
+    for (const auto& rule : jwt.trigger_rules()) {
+      int index = rule_origins_.size();
+      rule_origins_.push_back(origin);
+      rule_has_included_.push_back(rule.included_paths_size() > 0);
+      for (const auto& excluded : rule.excluded_paths()) {
+        AddPath(excluded, {index, true});
+      }
+      for (const auto& included : rule.included_paths()) {
+        AddPath(included, {index, false});
+      }
+    }
+  }
+}
+
+void JwtTriggerMatcher::AddPath(const iaapi::StringMatch& match,
+                                PathRef ref) {
+  switch (match.match_type_case()) {
+    case iaapi::StringMatch::kExact:
+      prefix_trie_[AddNode(&prefix_trie_, match.exact(), false)]
+          .exact.push_back(ref);
+      break;
+    case iaapi::StringMatch::kPrefix:
+      prefix_trie_[AddNode(&prefix_trie_, match.prefix(), false)]
+          .partial.push_back(ref);
+      break;
+    case iaapi::StringMatch::kSuffix:
+      suffix_trie_[AddNode(&suffix_trie_, match.suffix(), true)]
+          .partial.push_back(ref);
+      break;
+    case iaapi::StringMatch::kRegex: {
+      auto it = regexes_.begin();
+      while (it != regexes_.end() && it->pattern != match.regex()) {
+        ++it;
+      }
+      if (it == regexes_.end()) {
+        it = regexes_.insert(regexes_.end(),
+                             {match.regex(), std::regex(match.regex()), {}});
+      }
+      it->refs.push_back(ref);
+      break;
+    }
+    default:
+      // An empty match never matches.
+      break;
+  }
+}
+
+int JwtTriggerMatcher::AddNode(std::vector<TrieNode>* trie,
+                               absl::string_view key, bool reverse) {
+  int node = 0;
+  for (size_t i = 0; i < key.size(); ++i) {
+    char c = reverse ? key[key.size() - 1 - i] : key[i];
+    int next = 0;
+    for (const auto& child : (*trie)[node].children) {
+      if (child.first == c) {
+        next = child.second;
+        break;
+      }
+    }
+    if (next == 0) {
+      next = trie->size();
+      (*trie)[node].children.emplace_back(c, next);
+      trie->emplace_back();
+    }
+    node = next;
+  }
+  return node;
+}
+
+void JwtTriggerMatcher::Walk(const std::vector<TrieNode>& trie,
+                             absl::string_view path, bool reverse,
+                             std::vector<uint8_t>* hits) {
+  int node = 0;
+  RecordHits(trie[node].partial, hits);
+  for (size_t i = 0; i < path.size(); ++i) {
+    char c = reverse ? path[path.size() - 1 - i] : path[i];
+    int next = 0;
+    for (const auto& child : trie[node].children) {
+      if (child.first == c) {
+        next = child.second;
+        break;
+      }
+    }
+    if (next == 0) {
+      return;
+    }
+    node = next;
+    RecordHits(trie[node].partial, hits);
+  }
+  RecordHits(trie[node].exact, hits);
+}
+
+void JwtTriggerMatcher::RecordHits(const std::vector<PathRef>& refs,
+                                   std::vector<uint8_t>* hits) {
+  for (const auto& ref : refs) {
+    (*hits)[ref.rule] |= ref.excluded ? EXCLUDED_HIT : INCLUDED_HIT;
+  }
+}
+
+void JwtTriggerMatcher::Match(absl::string_view path,
+                              std::vector<bool>* triggered) const {
+  // An empty path, which shouldn't happen for a HTTP request, triggers all
+  // the JWTs.
+  triggered->assign(origins_, path.empty());
+  if (path.empty()) {
+    return;
+  }
+  for (int origin : untriggered_origins_) {
+    (*triggered)[origin] = true;
+  }
+
+  std::vector<uint8_t> hits(rule_origins_.size());
+  Walk(prefix_trie_, path, false, &hits);
+  Walk(suffix_trie_, path, true, &hits);
+  for (const auto& regex : regexes_) {
+    // Skip the regex if it cannot change the result of its rules.
+    bool needed = false;
+    for (const auto& ref : regex.refs) {
+      uint8_t hit = hits[ref.rule];
+      if (!(hit & EXCLUDED_HIT) && (ref.excluded || !(hit & INCLUDED_HIT))) {
+        needed = true;
+        break;
+      }
+    }
+    if (needed && std::regex_match(path.begin(), path.end(), regex.regex)) {
+      RecordHits(regex.refs, &hits);
+    }
+  }
+
+  // A rule is matched if none of its excluded paths matched, and either it
+  // has no included paths or one of them matched.
+  for (size_t rule = 0; rule < hits.size(); ++rule) {
+    if (!(hits[rule] & EXCLUDED_HIT) &&
+        (!rule_has_included_[rule] || (hits[rule] & INCLUDED_HIT))) {
+      (*triggered)[rule_origins_[rule]] = true;
+    }
+  }
+}
+
+}  // namespace AuthN
+}  // namespace Istio
+}  // namespace Http
+}  // namespace Envoy
@@ -0,0 +1,104 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "authentication/v1alpha1/policy.pb.h"
+
+namespace Envoy {
+namespace Http {
+namespace Istio {
+namespace AuthN {
+
+// Decides which origin JWTs of a policy are validated for a request path.
+//
+// The trigger rules of all the origins are compiled once: exact and prefix
+// paths into a trie walked from the start of the path, suffix paths into a
+// trie walked from its end, and identical regexes are shared. For a path,
+// each trie is walked once and each regex is evaluated at most once, then
+// the rules are decided from the excluded and included paths they hit.
+class JwtTriggerMatcher {
+ public:
+  explicit JwtTriggerMatcher(
+      const istio::authentication::v1alpha1::Policy& policy);
+
+  // Sets (*triggered)[i] to true if the JWT of the i-th origin should be
+  // validated for path, as AuthnUtils::ShouldValidateJwtPerPath does.
+  void Match(absl::string_view path, std::vector<bool>* triggered) const;
+
+ private:
+  // A path of a trigger rule.
+  struct PathRef {
+    int rule;
+    bool excluded;
+  };
+
+  struct TrieNode {
+    std::vector<std::pair<char, int>> children;
+    // Paths which are a prefix (or suffix) ending at this node.
+    std::vector<PathRef> partial;
+    // Exact paths ending at this node.
+    std::vector<PathRef> exact;
+  };
+
+  // The paths of a rule hit by a request.
+  enum HitFlag : uint8_t { EXCLUDED_HIT = 1, INCLUDED_HIT = 2 };
+
+  struct RegexPath {
+    std::string pattern;
+    std::regex regex;
+    std::vector<PathRef> refs;
+  };
+
+  // Adds a path of a trigger rule.
+  void AddPath(const istio::authentication::v1alpha1::StringMatch& match,
+               PathRef ref);
+
+  // Returns the node of the trie for key, adding it if needed.
+  static int AddNode(std::vector<TrieNode>* trie, absl::string_view key,
+                     bool reverse);
+
+  // Walks the trie with path, recording the hits in hits.
+  static void Walk(const std::vector<TrieNode>& trie, absl::string_view path,
+                   bool reverse, std::vector<uint8_t>* hits);
+
+  // Records the hits of refs.
+  static void RecordHits(const std::vector<PathRef>& refs,
+                         std::vector<uint8_t>* hits);
+
+  // Number of origins.
+  int origins_{};
+  // Origins without trigger rules, their JWT is always validated.
+  std::vector<int> untriggered_origins_;
+  // The origin of each rule.
+  std::vector<int> rule_origins_;
+  // Whether each rule has included paths.
+  std::vector<bool> rule_has_included_;
+  // Exact and prefix paths.
+  std::vector<TrieNode> prefix_trie_;
+  // Suffix paths, keyed from their end.
+  std::vector<TrieNode> suffix_trie_;
+  std::vector<RegexPath> regexes_;
+};
+
+}  // namespace AuthN
+}  // namespace Istio
+}  // namespace Http
+}  // namespace Envoy
@@ -0,0 +1,130 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/http/authn/jwt_trigger_matcher.h"
+
+#include "common/protobuf/protobuf.h"
+#include "gtest/gtest.h"
+#include "src/envoy/http/authn/authn_utils.h"
+
+namespace iaapi = istio::authentication::v1alpha1;
+
+namespace Envoy {
+namespace Http {
+namespace Istio {
+namespace AuthN {
+namespace {
+
+const char kPolicy[] = R"(
+  origins {
+    jwt {
+      issuer: "no-rules"
+    }
+  }
+  origins {
+    jwt {
+      issuer: "api"
+      trigger_rules {
+        included_paths { prefix: "/api/" }
+        excluded_paths { exact: "/api/health" }
+        excluded_paths { suffix: ".css" }
+      }
+    }
+  }
+  origins {
+    jwt {
+      issuer: "admin"
+      trigger_rules {
+        included_paths { regex: "/admin(/.*)?" }
+      }
+      trigger_rules {
+        included_paths { exact: "/login" }
+        included_paths { suffix: "/private" }
+      }
+    }
+  }
+  origins {
+    jwt {
+      issuer: "except-static"
+      trigger_rules {
+        excluded_paths { prefix: "/static" }
+        excluded_paths { regex: "/admin(/.*)?" }
+      }
+    }
+  }
+)";
+
+class JwtTriggerMatcherTest : public testing::Test {
+ public:
+  void SetUp() override {
+    ASSERT_TRUE(Protobuf::TextFormat::ParseFromString(kPolicy, &policy_));
+  }
+
+  // Returns the origins triggered for path, as a string of 0 and 1.
+  std::string Match(const JwtTriggerMatcher& matcher, absl::string_view path) {
+    std::vector<bool> triggered;
+    matcher.Match(path, &triggered);
+    std::string result;
+    for (bool t : triggered) {
+      result += t ? '1' : '0';
+    }
+    return result;
+  }
+
+  iaapi::Policy policy_;
+};
+
+TEST_F(JwtTriggerMatcherTest, MatchPaths) {
+  JwtTriggerMatcher matcher(policy_);
+  EXPECT_EQ(Match(matcher, ""), "1111");
+  EXPECT_EQ(Match(matcher, "/"), "1001");
+  EXPECT_EQ(Match(matcher, "/api/users"), "1101");
+  EXPECT_EQ(Match(matcher, "/api/health"), "1001");
+  EXPECT_EQ(Match(matcher, "/api/main.css"), "1001");
+  EXPECT_EQ(Match(matcher, "/admin"), "1010");
+  EXPECT_EQ(Match(matcher, "/admin/users"), "1010");
+  EXPECT_EQ(Match(matcher, "/administrator"), "1001");
+  EXPECT_EQ(Match(matcher, "/login"), "1011");
+  EXPECT_EQ(Match(matcher, "/static/private"), "1010");
+  EXPECT_EQ(Match(matcher, "/static"), "1000");
+}
+
+TEST_F(JwtTriggerMatcherTest, SameAsPerJwtMatch) {
+  JwtTriggerMatcher matcher(policy_);
+  for (const char* path :
+       {"", "/", "/a", "/api", "/api/", "/api/health", "/api/health/x",
+        "/api/x.css", "/admin", "/admin/", "/admin/x.css", "/login",
+        "/login/private", "/private", "/static", "/staticx", "/x/private"}) {
+    std::vector<bool> triggered;
+    matcher.Match(path, &triggered);
+    ASSERT_EQ(triggered.size(), static_cast<size_t>(policy_.origins_size()));
+    for (int i = 0; i < policy_.origins_size(); ++i) {
+      EXPECT_EQ(triggered[i], AuthnUtils::ShouldValidateJwtPerPath(
+                                  path, policy_.origins(i).jwt()))
+          << path << " " << i;
+    }
+  }
+}
+
+TEST_F(JwtTriggerMatcherTest, NoOrigins) {
+  JwtTriggerMatcher matcher(iaapi::Policy::default_instance());
+  EXPECT_EQ(Match(matcher, "/"), "");
+}
+
+}  // namespace
+}  // namespace AuthN
+}  // namespace Istio
+}  // namespace Http
+}  // namespace Envoy
@@ -41,7 +41,15 @@ bool isCORSPreflightRequest(const Http::RequestHeaderMap& headers) {
 
 OriginAuthenticator::OriginAuthenticator(FilterContext* filter_context,
                                          const iaapi::Policy& policy)
-    : AuthenticatorBase(filter_context), policy_(policy) {}
+    : OriginAuthenticator(filter_context, policy,
+                          std::make_shared<JwtTriggerMatcher>(policy)) {}
+
+OriginAuthenticator::OriginAuthenticator(
+    FilterContext* filter_context, const iaapi::Policy& policy,
+    std::shared_ptr<const JwtTriggerMatcher> jwt_trigger_matcher)
+    : AuthenticatorBase(filter_context),
+      policy_(policy),
+      jwt_trigger_matcher_(std::move(jwt_trigger_matcher)) {}
 
 bool OriginAuthenticator::run(Payload* payload) {
   if (policy_.origins_size() == 0 &&
@@ -81,12 +89,15 @@ bool OriginAuthenticator::run(Payload* payload) {
               "validation");
   }
 
+  std::vector<bool> jwt_triggered;
+  jwt_trigger_matcher_->Match(path, &jwt_triggered);
+
   bool triggered = false;
   bool triggered_success = false;
-  for (const auto& method : policy_.origins()) {
-    const auto& jwt = method.jwt();
+  for (int i = 0; i < policy_.origins_size(); ++i) {
+    const auto& jwt = policy_.origins(i).jwt();
 
-    if (AuthnUtils::ShouldValidateJwtPerPath(path, jwt)) {
+    if (jwt_triggered[i]) {
       ENVOY_LOG(debug, "Validating request path {} for jwt {}", path,
                 jwt.DebugString());
       // set triggered to true if any of the jwt trigger rule matched.
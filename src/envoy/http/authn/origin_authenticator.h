@@ -17,6 +17,7 @@
 
 #include "authentication/v1alpha1/policy.pb.h"
 #include "src/envoy/http/authn/authenticator_base.h"
+#include "src/envoy/http/authn/jwt_trigger_matcher.h"
 
 namespace Envoy {
 namespace Http {
@@ -29,12 +30,21 @@ class OriginAuthenticator : public AuthenticatorBase {
   OriginAuthenticator(FilterContext* filter_context,
                       const istio::authentication::v1alpha1::Policy& policy);
 
+  // Uses the trigger rules of policy compiled in jwt_trigger_matcher.
+  OriginAuthenticator(
+      FilterContext* filter_context,
+      const istio::authentication::v1alpha1::Policy& policy,
+      std::shared_ptr<const JwtTriggerMatcher> jwt_trigger_matcher);
+
   bool run(istio::authn::Payload*) override;
 
  private:
   // Reference to the authentication policy that the authenticator should
   // enforce. Typically, the actual object is owned by filter.
   const istio::authentication::v1alpha1::Policy& policy_;
+
+  // The compiled trigger rules of the origin JWTs.
+  std::shared_ptr<const JwtTriggerMatcher> jwt_trigger_matcher_;
 };
 
 }  // namespace AuthN
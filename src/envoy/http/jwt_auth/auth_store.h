@@ -15,12 +15,16 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+
 #include "common/common/logger.h"
 #include "common/protobuf/utility.h"
 #include "envoy/config/filter/http/jwt_auth/v2alpha1/config.pb.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/thread_local/thread_local.h"
 #include "src/envoy/http/jwt_auth/pubkey_cache.h"
+#include "src/envoy/http/jwt_auth/pubkey_fetcher.h"
 #include "src/envoy/http/jwt_auth/token_extractor.h"
 
 namespace Envoy {
@@ -32,13 +36,20 @@ typedef std::shared_ptr<const ::istio::envoy::config::filter::http::jwt_auth::
     JwtAuthenticationConstSharedPtr;
 
 // The JWT auth store object to store config and caches.
-// It only has pubkey_cache for now. In the future it will have token cache.
+// It has pubkey_cache and the pending pubkey fetches for now. In the future it
+// will have token cache.
 // It is per-thread and stored in thread local.
 class JwtAuthStore : public ThreadLocal::ThreadLocalObject {
  public:
-  // Load the config from envoy config.
-  JwtAuthStore(JwtAuthenticationConstSharedPtr config)
-      : config_(config), pubkey_cache_(*config_), token_extractor_(*config_) {}
+  // Load the config from envoy config. "max_kidless_attempts" bounds the
+  // keys tried for a JWT whose "kid" selects no key.
+  JwtAuthStore(
+      JwtAuthenticationConstSharedPtr config,
+      size_t max_kidless_attempts = Verifier::kDefaultMaxKidlessAttempts)
+      : config_(config),
+        max_kidless_attempts_(max_kidless_attempts),
+        pubkey_cache_(*config_),
+        token_extractor_(*config_) {}
 
   // Get the Config.
   const ::istio::envoy::config::filter::http::jwt_auth::v2alpha1::
@@ -47,21 +58,42 @@ class JwtAuthStore : public ThreadLocal::ThreadLocalObject {
     return *config_;
   }
 
+  // Get the bound of the keys tried for a JWT whose "kid" selects no key.
+  size_t max_kidless_attempts() const { return max_kidless_attempts_; }
+
   // Get the pubkey cache.
   PubkeyCache& pubkey_cache() { return pubkey_cache_; }
 
   // Get the private token extractor.
   const JwtTokenExtractor& token_extractor() const { return token_extractor_; }
 
+  // Get the pubkey fetcher of an issuer, shared by all its requests.
+  PubkeyFetcher& pubkey_fetcher(PubkeyCacheItem& issuer) {
+    auto& fetcher = pubkey_fetchers_[issuer.jwt_config().issuer()];
+    if (!fetcher) {
+      fetcher.reset(new PubkeyFetcher(issuer));
+    }
+    return *fetcher;
+  }
+
  private:
   // Store the config.
   JwtAuthenticationConstSharedPtr config_;
+  // The bound of the keys tried for a JWT whose "kid" selects no key.
+  size_t max_kidless_attempts_;
   // The public key cache, indexed by issuer.
   PubkeyCache pubkey_cache_;
   // The object to extract token.
   JwtTokenExtractor token_extractor_;
+  // The pubkey fetchers, indexed by issuer.
+  std::unordered_map<std::string, std::unique_ptr<PubkeyFetcher>>
+      pubkey_fetchers_;
 };
 
+// Runtime key to bound the keys tried for a JWT whose "kid" selects no key,
+// all keys are tried if it is not set.
+const char kMaxKidlessAttemptsKey[] = "jwt_auth.max_kidless_attempts";
+
 // The factory to create per-thread auth store object.
 class JwtAuthStoreFactory : public Logger::Loggable<Logger::Id::config> {
  public:
@@ -73,9 +105,12 @@ class JwtAuthStoreFactory : public Logger::Loggable<Logger::Id::config> {
             config)),
         dummy_store_(config_),
         tls_(context.threadLocal().allocateSlot()) {
-    tls_->set([config = this->config_](Event::Dispatcher&)
+    // The runtime is only read here, changes apply to the next config update.
+    const size_t max_kidless_attempts = context.runtime().snapshot().getInteger(
+        kMaxKidlessAttemptsKey, Verifier::kDefaultMaxKidlessAttempts);
+    tls_->set([config = this->config_, max_kidless_attempts](Event::Dispatcher&)
                   -> ThreadLocal::ThreadLocalObjectSharedPtr {
-      return std::make_shared<JwtAuthStore>(config);
+      return std::make_shared<JwtAuthStore>(config, max_kidless_attempts);
     });
     ENVOY_LOG(debug, "Loaded JwtAuthConfig: {}",
               MessageUtil::getJsonStringFromMessage(*config_, true));
@@ -32,6 +32,7 @@
 #include "openssl/evp.h"
 #include "openssl/rsa.h"
 #include "openssl/sha.h"
+#include "src/envoy/http/jwt_auth/jwt_claims.h"
 
 namespace Envoy {
 namespace Http {
@@ -239,7 +240,8 @@ class EvpPkeyGetter : public WithStatus {
 
 }  // namespace
 
-Jwt::Jwt(const std::string &jwt) {
+Jwt::Jwt(const std::string &jwt)
+    : exp_(0), header_parsed_(false), payload_parsed_(false) {
   // jwt must have exactly 2 dots
   if (std::count(jwt.begin(), jwt.end(), '.') != 2) {
     UpdateStatus(Status::JWT_BAD_FORMAT);
@@ -254,24 +256,24 @@ Jwt::Jwt(const std::string &jwt) {
   // Parse header json
   header_str_base64url_ = std::string(jwt_split[0].begin(), jwt_split[0].end());
   header_str_ = Base64UrlDecode(header_str_base64url_);
-  try {
-    header_ = Json::Factory::loadFromString(header_str_);
-  } catch (Json::Exception &e) {
+  JwtClaims header;
+  if (!header.Parse(header_str_)) {
     UpdateStatus(Status::JWT_HEADER_PARSE_ERROR);
     return;
   }
+  header_parsed_ = true;
 
   // Header should contain "alg".
-  if (!header_->hasObject("alg")) {
+  const JwtClaim *alg = header.Find("alg");
+  if (alg == nullptr) {
     UpdateStatus(Status::JWT_HEADER_NO_ALG);
     return;
   }
-  try {
-    alg_ = header_->getString("alg");
-  } catch (Json::Exception &e) {
+  if (alg->type != JwtClaim::Type::STRING) {
     UpdateStatus(Status::JWT_HEADER_BAD_ALG);
     return;
   }
+  alg_ = std::string(alg->string_value);
 
   if (alg_ != "RS256" && alg_ != "ES256" && alg_ != "RS384" &&
       alg_ != "RS512") {
@@ -280,38 +282,52 @@ Jwt::Jwt(const std::string &jwt) {
   }
 
   // Header may contain "kid", which should be a string if exists.
-  try {
-    kid_ = header_->getString("kid", "");
-  } catch (Json::Exception &e) {
-    UpdateStatus(Status::JWT_HEADER_BAD_KID);
-    return;
+  const JwtClaim *kid = header.Find("kid");
+  if (kid != nullptr) {
+    if (kid->type != JwtClaim::Type::STRING) {
+      UpdateStatus(Status::JWT_HEADER_BAD_KID);
+      return;
+    }
+    kid_ = std::string(kid->string_value);
   }
 
   // Parse payload json
   payload_str_base64url_ =
       std::string(jwt_split[1].begin(), jwt_split[1].end());
   payload_str_ = Base64UrlDecode(payload_str_base64url_);
-  try {
-    payload_ = Json::Factory::loadFromString(payload_str_);
-  } catch (Json::Exception &e) {
+  JwtClaims payload;
+  if (!payload.Parse(payload_str_)) {
     UpdateStatus(Status::JWT_PAYLOAD_PARSE_ERROR);
     return;
   }
+  payload_parsed_ = true;
 
-  iss_ = payload_->getString("iss", "");
-  sub_ = payload_->getString("sub", "");
-  exp_ = payload_->getInteger("exp", 0);
+  // "iss" and "sub" should be strings, "exp" an integer if they exist.
+  const JwtClaim *iss = payload.Find("iss");
+  const JwtClaim *sub = payload.Find("sub");
+  const JwtClaim *exp = payload.Find("exp");
+  if ((iss != nullptr && iss->type != JwtClaim::Type::STRING) ||
+      (sub != nullptr && sub->type != JwtClaim::Type::STRING) ||
+      (exp != nullptr && !exp->is_integer)) {
+    UpdateStatus(Status::JWT_PAYLOAD_PARSE_ERROR);
+    return;
+  }
+  if (iss != nullptr) {
+    iss_ = std::string(iss->string_value);
+  }
+  if (sub != nullptr) {
+    sub_ = std::string(sub->string_value);
+  }
+  exp_ = exp != nullptr ? exp->integer_value : 0;
 
   // "aud" can be either string array or string.
-  // Try as string array, read it as empty array if doesn't exist.
-  try {
-    aud_ = payload_->getStringArray("aud", true);
-  } catch (Json::Exception &e) {
-    // Try as string
-    try {
-      auto audience = payload_->getString("aud");
-      aud_.push_back(audience);
-    } catch (Json::Exception &e) {
+  const JwtClaim *aud = payload.Find("aud");
+  if (aud != nullptr) {
+    if (aud->is_string_list) {
+      aud_.assign(aud->string_list.begin(), aud->string_list.end());
+    } else if (aud->type == JwtClaim::Type::STRING) {
+      aud_.emplace_back(aud->string_value);
+    } else {
       UpdateStatus(Status::JWT_PAYLOAD_PARSE_ERROR);
       return;
     }
@@ -395,42 +411,66 @@ bool Verifier::Verify(const Jwt &jwt, const Pubkeys &pubkeys) {
 
   std::string signed_data =
       jwt.header_str_base64url_ + '.' + jwt.payload_str_base64url_;
-  bool kid_alg_matched = false;
-  for (auto &pubkey : pubkeys.keys_) {
-    // If kid is specified in JWT, JWK with the same kid is used for
-    // verification.
-    // If kid is not specified in JWT, try all JWK.
-    if (jwt.kid_ != "" && pubkey->kid_specified_ && pubkey->kid_ != jwt.kid_) {
-      continue;
-    }
+  const bool jwt_is_ec = jwt.alg_ == "ES256";
+  const EVP_MD *md;
+  if (jwt.alg_ == "RS384") {
+    md = EVP_sha384();
+  } else if (jwt.alg_ == "RS512") {
+    md = EVP_sha512();
+  } else {
+    // default to SHA256
+    md = EVP_sha256();
+  }
 
+  bool kid_alg_matched = false;
+  size_t kidless_attempts = 0;
+  // Returns true if the signature is verified by the key.
+  auto try_key = [&](const Pubkeys::Pubkey &pubkey, bool kid_selected) {
     // The same alg must be used.
-    if (pubkey->alg_specified_ && pubkey->alg_ != jwt.alg_) {
-      continue;
+    if (pubkey.alg_specified_ && pubkey.alg_ != jwt.alg_) {
+      return false;
     }
     kid_alg_matched = true;
+    // An EC key can't verify a RSA signature, and vice versa.
+    if (pubkey.is_ec_ != jwt_is_ec) {
+      return false;
+    }
+    if (!kid_selected && ++kidless_attempts > max_kidless_attempts_) {
+      return false;
+    }
+    if (pubkey.is_ec_) {
+      return VerifySignatureEC(pubkey.ec_key_.get(), jwt.signature_,
+                               signed_data);
+    }
+    return VerifySignatureRSA(pubkey.evp_pkey_.get(), md, jwt.signature_,
+                              signed_data);
+  };
 
-    if (pubkey->kty_ == "EC" &&
-        VerifySignatureEC(pubkey->ec_key_.get(), jwt.signature_, signed_data)) {
-      // Verification succeeded.
-      return true;
-    } else if (pubkey->pem_format_ || pubkey->kty_ == "RSA") {
-      const EVP_MD *md;
-      if (jwt.alg_ == "RS384") {
-        md = EVP_sha384();
-      } else if (jwt.alg_ == "RS512") {
-        md = EVP_sha512();
-      } else {
-        // default to SHA256
-        md = EVP_sha256();
+  if (jwt.kid_ == "") {
+    // If kid is not specified in JWT, try all JWK.
+    for (const auto &pubkey : pubkeys.keys_) {
+      if (try_key(*pubkey, false)) {
+        return true;
       }
-      if (VerifySignatureRSA(pubkey->evp_pkey_.get(), md, jwt.signature_,
-                             signed_data)) {
-        // Verification succeeded.
+    }
+  } else {
+    // If kid is specified in JWT, JWK with the same kid is used for
+    // verification, or JWK without kid.
+    const auto it = pubkeys.kid_index_.find(jwt.kid_);
+    if (it != pubkeys.kid_index_.end()) {
+      for (const auto *pubkey : it->second) {
+        if (try_key(*pubkey, true)) {
+          return true;
+        }
+      }
+    }
+    for (const auto *pubkey : pubkeys.kidless_keys_) {
+      if (try_key(*pubkey, false)) {
         return true;
       }
     }
   }
+
   // Verification failed.
   if (kid_alg_matched) {
     UpdateStatus(Status::JWT_INVALID_SIGNATURE);
@@ -440,16 +480,36 @@ bool Verifier::Verify(const Jwt &jwt, const Pubkeys &pubkeys) {
   return false;
 }
 
-// Returns the parsed header.
-Json::ObjectSharedPtr Jwt::Header() { return header_; }
+// Returns the parsed header, the JSON tree is only built on demand.
+Json::ObjectSharedPtr Jwt::Header() {
+  if (header_parsed_ && !header_) {
+    try {
+      header_ = Json::Factory::loadFromString(header_str_);
+    } catch (Json::Exception &e) {
+      // Not a JSON the Envoy loader accepts, don't try again.
+      header_parsed_ = false;
+    }
+  }
+  return header_;
+}
 
 const std::string &Jwt::HeaderStr() { return header_str_; }
 const std::string &Jwt::HeaderStrBase64Url() { return header_str_base64url_; }
 const std::string &Jwt::Alg() { return alg_; }
 const std::string &Jwt::Kid() { return kid_; }
 
-// Returns payload JSON.
-Json::ObjectSharedPtr Jwt::Payload() { return payload_; }
+// Returns payload JSON, the JSON tree is only built on demand.
+Json::ObjectSharedPtr Jwt::Payload() {
+  if (payload_parsed_ && !payload_) {
+    try {
+      payload_ = Json::Factory::loadFromString(payload_str_);
+    } catch (Json::Exception &e) {
+      // Not a JSON the Envoy loader accepts, don't try again.
+      payload_parsed_ = false;
+    }
+  }
+  return payload_;
+}
 
 const std::string &Jwt::PayloadStr() { return payload_str_; }
 const std::string &Jwt::PayloadStrBase64Url() { return payload_str_base64url_; }
@@ -580,6 +640,7 @@ void Pubkeys::ExtractPubkeyFromJwkEC(Json::ObjectSharedPtr jwk_json) {
   }
 
   EvpPkeyGetter e;
+  pubkey->is_ec_ = true;
   pubkey->ec_key_ = e.EcKeyFromJwkEC(x_str, y_str);
   if (e.GetStatus() == Status::OK) {
     keys_.push_back(std::move(pubkey));
@@ -588,6 +649,18 @@ void Pubkeys::ExtractPubkeyFromJwkEC(Json::ObjectSharedPtr jwk_json) {
   }
 }
 
+void Pubkeys::BuildIndex() {
+  kid_index_.clear();
+  kidless_keys_.clear();
+  for (const auto &pubkey : keys_) {
+    if (pubkey->kid_specified_) {
+      kid_index_[pubkey->kid_].push_back(pubkey.get());
+    } else {
+      kidless_keys_.push_back(pubkey.get());
+    }
+  }
+}
+
 std::unique_ptr<Pubkeys> Pubkeys::CreateFrom(const std::string &pkey,
                                              Type type) {
   std::unique_ptr<Pubkeys> keys(new Pubkeys());
@@ -601,6 +674,7 @@ std::unique_ptr<Pubkeys> Pubkeys::CreateFrom(const std::string &pkey,
     default:
       PANIC("can not reach here");
   }
+  keys->BuildIndex();
   return keys;
 }
 
@@ -15,7 +15,9 @@
 
 #pragma once
 
+#include <limits>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -148,6 +150,15 @@ class Jwt;
 //   }
 class Verifier : public WithStatus {
  public:
+  // By default, all keys are tried for a JWT whose "kid" selects no key.
+  static const size_t kDefaultMaxKidlessAttempts =
+      std::numeric_limits<size_t>::max();
+
+  // "max_kidless_attempts" bounds the signature verifications against keys
+  // not selected by the JWT "kid", e.g. all keys for a JWT without "kid".
+  explicit Verifier(size_t max_kidless_attempts = kDefaultMaxKidlessAttempts)
+      : max_kidless_attempts_(max_kidless_attempts) {}
+
   // This function verifies JWT signature.
   // If verification failed, GetStatus() returns the failture reason.
   // When the given JWT has a format error, this verification always fails and
@@ -171,6 +182,8 @@ class Verifier : public WithStatus {
   bool VerifySignatureEC(EC_KEY* key, const uint8_t* signature,
                          size_t signature_len, const uint8_t* signed_data,
                          size_t signed_data_len);
+
+  const size_t max_kidless_attempts_;
 };
 
 // Class to parse and a hold a JWT.
@@ -188,7 +201,8 @@ class Jwt : public WithStatus {
   Jwt(const std::string& jwt);
 
   // It returns a pointer to a JSON object of the header of the given JWT.
-  // When the given JWT has a format error, it returns nullptr.
+  // When the given JWT has a format error, or the Envoy JSON loader rejects
+  // the header, it returns nullptr.
   // It returns the header JSON even if the signature is invalid.
   Json::ObjectSharedPtr Header();
 
@@ -205,7 +219,8 @@ class Jwt : public WithStatus {
   const std::string& Kid();
 
   // It returns a pointer to a JSON object of the payload of the given JWT.
-  // When the given jWT has a format error, it returns nullptr.
+  // When the given jWT has a format error, or the Envoy JSON loader rejects
+  // the payload, it returns nullptr.
   // It returns the payload JSON even if the signature is invalid.
   Json::ObjectSharedPtr Payload();
 
@@ -244,6 +259,9 @@ class Jwt : public WithStatus {
   std::vector<std::string> aud_;
   std::string sub_;
   int64_t exp_;
+  // Whether the header and the payload are valid JSON objects.
+  bool header_parsed_;
+  bool payload_parsed_;
 
   /*
    * TODO: try not to use friend function
@@ -274,6 +292,9 @@ class Pubkeys : public WithStatus {
   void ExtractPubkeyFromJwkRSA(Json::ObjectSharedPtr jwk_json);
   void ExtractPubkeyFromJwkEC(Json::ObjectSharedPtr jwk_json);
 
+  // Indexes keys_ by "kid", called once the keys are extracted.
+  void BuildIndex();
+
   class Pubkey {
    public:
     Pubkey(){};
@@ -285,8 +306,14 @@ class Pubkeys : public WithStatus {
     bool kid_specified_ = false;
     bool pem_format_ = false;
     std::string alg_;
+    // Whether the key verifies ES256 or RS* signatures.
+    bool is_ec_ = false;
   };
   std::vector<std::unique_ptr<Pubkey> > keys_;
+  // The keys with a "kid", indexed by it.
+  std::unordered_map<std::string, std::vector<const Pubkey*> > kid_index_;
+  // The keys without a "kid", they may verify any JWT.
+  std::vector<const Pubkey*> kidless_keys_;
 
   /*
    * TODO: try not to use friend function
@@ -15,8 +15,7 @@
 
 #include "src/envoy/http/jwt_auth/jwt_authenticator.h"
 
-#include "common/http/message_impl.h"
-#include "common/http/utility.h"
+#include "common/http/headers.h"
 
 namespace Envoy {
 namespace Http {
@@ -26,28 +25,6 @@ namespace {
 // The HTTP header to pass verified token payload.
 const LowerCaseString kJwtPayloadKey("sec-istio-auth-userinfo");
 
-// Extract host and path from a URI
-void ExtractUriHostPath(const std::string &uri, std::string *host,
-                        std::string *path) {
-  // Example:
-  // uri  = "https://example.com/certs"
-  // pos  :          ^
-  // pos1 :                     ^
-  // host = "example.com"
-  // path = "/certs"
-  auto pos = uri.find("://");
-  pos = pos == std::string::npos ? 0 : pos + 3;  // Start position of host
-  auto pos1 = uri.find("/", pos);
-  if (pos1 == std::string::npos) {
-    // If uri doesn't have "/", the whole string is treated as host.
-    *host = uri.substr(pos);
-    *path = "/";
-  } else {
-    *host = uri.substr(pos, pos1 - pos);
-    *path = "/" + uri.substr(pos1 + 1);
-  }
-}
-
 }  // namespace
 
 JwtAuthenticator::JwtAuthenticator(Upstream::ClusterManager &cm,
@@ -141,75 +118,38 @@ void JwtAuthenticator::Verify(RequestHeaderMap &headers,
 }
 
 void JwtAuthenticator::FetchPubkey(PubkeyCacheItem *issuer) {
-  uri_ = issuer->jwt_config().remote_jwks().http_uri().uri();
-  std::string host, path;
-  ExtractUriHostPath(uri_, &host, &path);
-
-  RequestMessagePtr message(new RequestMessageImpl());
-  message->headers().setReferenceMethod(Http::Headers::get().MethodValues.Get);
-  message->headers().setPath(path);
-  message->headers().setHost(host);
-
-  const auto &cluster = issuer->jwt_config().remote_jwks().http_uri().cluster();
-  if (cm_.get(cluster) == nullptr) {
-    DoneWithStatus(Status::FAILED_FETCH_PUBKEY);
+  // A recently failed fetch is not retried.
+  Status status = issuer->FetchFailure();
+  if (status != Status::OK) {
+    ENVOY_LOG(debug, "fetch pubkey for issuer {}: recently failed",
+              jwt_->Iss());
+    DoneWithStatus(status);
     return;
   }
-
-  ENVOY_LOG(debug, "fetch pubkey from [uri = {}]: start", uri_);
-  request_ = cm_.httpAsyncClientForCluster(cluster).send(
-      std::move(message), *this, Http::AsyncClient::RequestOptions());
-}
-
-void JwtAuthenticator::onSuccess(ResponseMessagePtr &&response) {
-  request_ = nullptr;
-  uint64_t status_code = Http::Utility::getResponseStatus(response->headers());
-  if (status_code == 200) {
-    ENVOY_LOG(debug, "fetch pubkey [uri = {}]: success", uri_);
-    std::string body;
-    if (response->body()) {
-      auto len = response->body()->length();
-      body = std::string(static_cast<char *>(response->body()->linearize(len)),
-                         len);
-    } else {
-      ENVOY_LOG(debug, "fetch pubkey [uri = {}]: body is empty", uri_);
-    }
-    OnFetchPubkeyDone(body);
-  } else {
-    ENVOY_LOG(debug, "fetch pubkey [uri = {}]: response status code {}", uri_,
-              status_code);
-    DoneWithStatus(Status::FAILED_FETCH_PUBKEY);
-  }
-}
-
-void JwtAuthenticator::onFailure(AsyncClient::FailureReason) {
-  request_ = nullptr;
-  ENVOY_LOG(debug, "fetch pubkey [uri = {}]: failed", uri_);
-  DoneWithStatus(Status::FAILED_FETCH_PUBKEY);
+  fetcher_ = &store_.pubkey_fetcher(*issuer);
+  fetcher_->Fetch(cm_, this);
 }
 
 void JwtAuthenticator::onDestroy() {
-  if (request_) {
-    request_->cancel();
-    request_ = nullptr;
-    ENVOY_LOG(debug, "fetch pubkey [uri = {}]: canceled", uri_);
+  if (fetcher_) {
+    fetcher_->Cancel(this);
+    fetcher_ = nullptr;
   }
 }
 
 // Handle the public key fetch done event.
-void JwtAuthenticator::OnFetchPubkeyDone(const std::string &pubkey) {
-  auto issuer = store_.pubkey_cache().LookupByIssuer(jwt_->Iss());
-  Status status = issuer->SetRemoteJwks(pubkey);
+void JwtAuthenticator::OnFetchPubkeyDone(Status status) {
+  fetcher_ = nullptr;
   if (status != Status::OK) {
     DoneWithStatus(status);
-  } else {
-    VerifyKey(*issuer);
+    return;
   }
+  VerifyKey(*store_.pubkey_cache().LookupByIssuer(jwt_->Iss()));
 }
 
 // Verify with a specific public key.
 void JwtAuthenticator::VerifyKey(const PubkeyCacheItem &issuer_item) {
-  JwtAuth::Verifier v;
+  JwtAuth::Verifier v(store_.max_kidless_attempts());
   if (!v.Verify(*jwt_, *issuer_item.pubkey())) {
     DoneWithStatus(v.GetStatus());
     return;
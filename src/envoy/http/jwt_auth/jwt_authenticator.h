@@ -16,7 +16,6 @@
 #pragma once
 
 #include "common/common/logger.h"
-#include "envoy/http/async_client.h"
 #include "src/envoy/http/jwt_auth/auth_store.h"
 
 namespace Envoy {
@@ -26,7 +25,7 @@ namespace JwtAuth {
 // A per-request JWT authenticator to handle all JWT authentication:
 // * fetch remote public keys and cache them.
 class JwtAuthenticator : public Logger::Loggable<Logger::Id::filter>,
-                         public AsyncClient::Callbacks {
+                         public PubkeyFetcher::Callbacks {
  public:
   JwtAuthenticator(Upstream::ClusterManager& cm, JwtAuthStore& store);
 
@@ -49,15 +48,12 @@ class JwtAuthenticator : public Logger::Loggable<Logger::Id::filter>,
  private:
   // Fetch a remote public key.
   void FetchPubkey(PubkeyCacheItem* issuer);
-  // Following two functions are for AyncClient::Callbacks
-  void onSuccess(ResponseMessagePtr&& response);
-  void onFailure(AsyncClient::FailureReason);
 
   // Verify with a specific public key.
   void VerifyKey(const PubkeyCacheItem& issuer);
 
-  // Handle the public key fetch done event.
-  void OnFetchPubkeyDone(const std::string& pubkey);
+  // Handle the public key fetch done event, for PubkeyFetcher::Callbacks.
+  void OnFetchPubkeyDone(Status status) override;
 
   // Calls the callback with status.
   void DoneWithStatus(const Status& status);
@@ -79,10 +75,8 @@ class JwtAuthenticator : public Logger::Loggable<Logger::Id::filter>,
   // The on_done function.
   Callbacks* callback_{};
 
-  // The pending uri_, only used for logging.
-  std::string uri_;
-  // The pending remote request so it can be canceled.
-  AsyncClient::Request* request_{};
+  // The fetcher of the pending public key fetch so it can be canceled.
+  PubkeyFetcher* fetcher_{};
 };
 
 }  // namespace JwtAuth
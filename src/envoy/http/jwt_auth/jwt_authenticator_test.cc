@@ -466,6 +466,36 @@ TEST_F(JwtAuthenticatorTest, TestOkJWTPubkeyNoKid) {
   EXPECT_EQ(mock_pubkey.called_count(), 1);
 }
 
+TEST_F(JwtAuthenticatorTest, TestMaxKidlessAttempts) {
+  // No key is selected by "kid" and no kid-less key may be tried.
+  store_.reset(new JwtAuthStore(config_ptr_, 0));
+  auth_.reset(new JwtAuthenticator(mock_cm_, *store_));
+
+  std::string kid_claim1 =
+      ",  \"kid\": \"62a93512c9ee4c7f8067b5a216dade2763d32a47\"";
+  std::string kid_claim2 =
+      ",  \"kid\": \"b3319a147514df7ee5e4bcdee51350cc890cc89e\"";
+  std::string pubkey_no_kid = kPublicKey;
+  std::size_t kid_pos = pubkey_no_kid.find(kid_claim1);
+  pubkey_no_kid.erase(kid_pos, kid_claim1.length());
+  kid_pos = pubkey_no_kid.find(kid_claim2);
+  pubkey_no_kid.erase(kid_pos, kid_claim2.length());
+
+  MockUpstream mock_pubkey(mock_cm_, pubkey_no_kid);
+
+  auto headers =
+      TestRequestHeaderMapImpl{{"Authorization", "Bearer " + kGoodToken}};
+
+  MockJwtAuthenticatorCallbacks mock_cb;
+  EXPECT_CALL(mock_cb, onDone(_)).WillOnce(Invoke([](const Status &status) {
+    ASSERT_EQ(status, Status::JWT_INVALID_SIGNATURE);
+  }));
+
+  auth_->Verify(headers, &mock_cb);
+
+  EXPECT_EQ(mock_pubkey.called_count(), 1);
+}
+
 // Verifies that a JWT with alg=RS384 is verified successfully
 TEST_F(JwtAuthenticatorTest, TestOKJWTAlgRs384) {
   MockUpstream mock_pubkey(mock_cm_, kPublicKey);
@@ -863,6 +893,79 @@ TEST_F(JwtAuthenticatorTest, TestOnDestroy) {
   auth_->onDestroy();
 }
 
+TEST_F(JwtAuthenticatorTest, TestConcurrentPubkeyFetch) {
+  NiceMock<Http::MockAsyncClient> async_client;
+  EXPECT_CALL(mock_cm_, httpAsyncClientForCluster(_))
+      .WillOnce(Invoke([&](const std::string &) -> Http::AsyncClient & {
+        return async_client;
+      }));
+
+  // Only one fetch is sent for the concurrent requests.
+  MockAsyncClientRequest request(&async_client);
+  AsyncClient::Callbacks *callbacks;
+  EXPECT_CALL(async_client, send_(_, _, _))
+      .WillOnce(Invoke([&](Http::RequestMessagePtr &,
+                           AsyncClient::Callbacks &cb,
+                           const Http::AsyncClient::RequestOptions &)
+                           -> AsyncClient::Request * {
+        callbacks = &cb;
+        return &request;
+      }));
+  // The fetch is not canceled while a request waits for it.
+  EXPECT_CALL(request, cancel()).Times(0);
+
+  JwtAuthenticator auth1(mock_cm_, *store_);
+  JwtAuthenticator auth2(mock_cm_, *store_);
+  MockJwtAuthenticatorCallbacks mock_cb1;
+  MockJwtAuthenticatorCallbacks mock_cb2;
+  EXPECT_CALL(mock_cb_, onDone(Status::OK));
+  EXPECT_CALL(mock_cb_, savePayload(kJwtIssuer, kGoodTokenPayload));
+  EXPECT_CALL(mock_cb1, onDone(_)).Times(0);
+  EXPECT_CALL(mock_cb2, onDone(Status::OK));
+  EXPECT_CALL(mock_cb2, savePayload(kJwtIssuer, kGoodTokenPayload));
+
+  auto headers =
+      TestRequestHeaderMapImpl{{"Authorization", "Bearer " + kGoodToken}};
+  auto headers1 =
+      TestRequestHeaderMapImpl{{"Authorization", "Bearer " + kGoodToken}};
+  auto headers2 =
+      TestRequestHeaderMapImpl{{"Authorization", "Bearer " + kGoodToken}};
+  auth_->Verify(headers, &mock_cb_);
+  auth1.Verify(headers1, &mock_cb1);
+  auth2.Verify(headers2, &mock_cb2);
+  auth1.onDestroy();
+
+  Http::ResponseMessagePtr response_message(new ResponseMessageImpl(
+      ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{{":status", "200"}}}));
+  response_message->body().reset(new Buffer::OwnedImpl(kPublicKey));
+  callbacks->onSuccess(std::move(response_message));
+}
+
+TEST_F(JwtAuthenticatorTest, TestPubkeyFetchFailCached) {
+  NiceMock<Http::MockAsyncClient> async_client;
+  EXPECT_CALL(mock_cm_, httpAsyncClientForCluster(_))
+      .WillOnce(Invoke([&](const std::string &) -> Http::AsyncClient & {
+        return async_client;
+      }));
+  EXPECT_CALL(async_client, send_(_, _, _))
+      .WillOnce(Invoke([&](Http::RequestMessagePtr &,
+                           AsyncClient::Callbacks &cb,
+                           const Http::AsyncClient::RequestOptions &)
+                           -> AsyncClient::Request * {
+        cb.onFailure(AsyncClient::FailureReason::Reset);
+        return nullptr;
+      }));
+
+  // The failure is cached, the second request does not fetch again.
+  for (int i = 0; i < 2; i++) {
+    auto headers =
+        TestRequestHeaderMapImpl{{"Authorization", "Bearer " + kGoodToken}};
+    MockJwtAuthenticatorCallbacks mock_cb;
+    EXPECT_CALL(mock_cb, onDone(Status::FAILED_FETCH_PUBKEY));
+    auth_->Verify(headers, &mock_cb);
+  }
+}
+
 TEST_F(JwtAuthenticatorTest, TestNoForwardPayloadHeader) {
   // The flag (forward_payload_header) is deprecated and have no impact. The
   // current behavior is always save JWT payload to request info (dynamic
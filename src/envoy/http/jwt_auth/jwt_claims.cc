@@ -0,0 +1,510 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/http/jwt_auth/jwt_claims.h"
+
+#include <limits>
+#include <utility>
+
+namespace Envoy {
+namespace Http {
+namespace JwtAuth {
+namespace {
+
+// Bounds the recursion on nested claim values.
+const int kMaxDepth = 64;
+
+bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+void AppendUtf8(uint32_t code_point, std::string* out) {
+  if (code_point < 0x80) {
+    out->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+}  // namespace
+
+// A recursive descent parser over the JSON text.  The members of nested
+// values are only validated, the top-level members are decoded as claims.
+class JwtClaims::Parser {
+ public:
+  Parser(absl::string_view json, JwtClaims* claims)
+      : pos_(json.data()), end_(json.data() + json.size()), claims_(claims) {}
+
+  bool ParseObject() {
+    SkipSpace();
+    if (!Consume('{')) {
+      return false;
+    }
+    SkipSpace();
+    if (Consume('}')) {
+      return AtEnd();
+    }
+    while (true) {
+      JwtClaim claim;
+      SkipSpace();
+      if (!ParseString(&claim.name)) {
+        return false;
+      }
+      SkipSpace();
+      if (!Consume(':') || !ParseClaimValue(&claim)) {
+        return false;
+      }
+      claims_->claims_.push_back(std::move(claim));
+      SkipSpace();
+      if (Consume('}')) {
+        return AtEnd();
+      }
+      if (!Consume(',')) {
+        return false;
+      }
+    }
+  }
+
+ private:
+  bool ParseClaimValue(JwtClaim* claim) {
+    SkipSpace();
+    const char* start = pos_;
+    claim->is_string_list = false;
+    claim->is_integer = false;
+    claim->integer_value = 0;
+    bool ok;
+    if (pos_ < end_ && *pos_ == '"') {
+      claim->type = JwtClaim::Type::STRING;
+      ok = ParseString(&claim->string_value);
+    } else if (pos_ < end_ && *pos_ == '[') {
+      claim->type = JwtClaim::Type::ARRAY;
+      ok = ParseStringList(claim);
+    } else {
+      ok = ParseValue(0, claim);
+    }
+    claim->raw = absl::string_view(start, pos_ - start);
+    return ok;
+  }
+
+  // Parses an array claim, its string elements are kept until an element of
+  // another type is found.
+  bool ParseStringList(JwtClaim* claim) {
+    ++pos_;
+    claim->is_string_list = true;
+    SkipSpace();
+    if (Consume(']')) {
+      return true;
+    }
+    while (true) {
+      SkipSpace();
+      if (claim->is_string_list && pos_ < end_ && *pos_ == '"') {
+        absl::string_view element;
+        if (!ParseString(&element)) {
+          return false;
+        }
+        claim->string_list.push_back(element);
+      } else {
+        claim->is_string_list = false;
+        claim->string_list.clear();
+        if (!ParseValue(1, nullptr)) {
+          return false;
+        }
+      }
+      SkipSpace();
+      if (Consume(']')) {
+        return true;
+      }
+      if (!Consume(',')) {
+        return false;
+      }
+    }
+  }
+
+  // Parses any value; "claim" is only set for a top-level scalar.
+  bool ParseValue(int depth, JwtClaim* claim) {
+    if (depth > kMaxDepth) {
+      return false;
+    }
+    SkipSpace();
+    if (pos_ >= end_) {
+      return false;
+    }
+    switch (*pos_) {
+      case '{':
+        SetType(claim, JwtClaim::Type::OBJECT);
+        return SkipContainer(depth, '}', true);
+      case '[':
+        SetType(claim, JwtClaim::Type::ARRAY);
+        return SkipContainer(depth, ']', false);
+      case '"':
+        SetType(claim, JwtClaim::Type::STRING);
+        return ParseString(nullptr);
+      case 't':
+        SetType(claim, JwtClaim::Type::BOOL);
+        return ConsumeLiteral("true");
+      case 'f':
+        SetType(claim, JwtClaim::Type::BOOL);
+        return ConsumeLiteral("false");
+      case 'n':
+        SetType(claim, JwtClaim::Type::NULL_VALUE);
+        return ConsumeLiteral("null");
+      default:
+        SetType(claim, JwtClaim::Type::NUMBER);
+        return ParseNumber(claim);
+    }
+  }
+
+  bool SkipContainer(int depth, char close, bool is_object) {
+    ++pos_;
+    SkipSpace();
+    if (Consume(close)) {
+      return true;
+    }
+    while (true) {
+      if (is_object) {
+        SkipSpace();
+        if (!ParseString(nullptr)) {
+          return false;
+        }
+        SkipSpace();
+        if (!Consume(':')) {
+          return false;
+        }
+      }
+      if (!ParseValue(depth + 1, nullptr)) {
+        return false;
+      }
+      SkipSpace();
+      if (Consume(close)) {
+        return true;
+      }
+      if (!Consume(',')) {
+        return false;
+      }
+    }
+  }
+
+  // Parses a string, "out" is a view into the JSON text unless the string
+  // has escape sequences.  "out" may be nullptr to only validate.
+  bool ParseString(absl::string_view* out) {
+    if (!Consume('"')) {
+      return false;
+    }
+    const char* start = pos_;
+    while (pos_ < end_ && *pos_ != '"' && *pos_ != '\\') {
+      const unsigned char c = *pos_;
+      if (c < 0x20) {
+        return false;
+      }
+      if (c >= 0x80) {
+        if (!SkipUtf8()) {
+          return false;
+        }
+        continue;
+      }
+      ++pos_;
+    }
+    if (pos_ >= end_) {
+      return false;
+    }
+    if (*pos_ == '"') {
+      if (out) {
+        *out = absl::string_view(start, pos_ - start);
+      }
+      ++pos_;
+      return true;
+    }
+
+    std::string unescaped(start, pos_ - start);
+    while (pos_ < end_ && *pos_ != '"') {
+      if (static_cast<unsigned char>(*pos_) >= 0x80) {
+        const char* sequence = pos_;
+        if (!SkipUtf8()) {
+          return false;
+        }
+        unescaped.append(sequence, pos_ - sequence);
+        continue;
+      }
+      char c = *pos_++;
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return false;
+      }
+      if (c != '\\') {
+        unescaped.push_back(c);
+        continue;
+      }
+      if (pos_ >= end_) {
+        return false;
+      }
+      switch (*pos_++) {
+        case '"':
+          unescaped.push_back('"');
+          break;
+        case '\\':
+          unescaped.push_back('\\');
+          break;
+        case '/':
+          unescaped.push_back('/');
+          break;
+        case 'b':
+          unescaped.push_back('\b');
+          break;
+        case 'f':
+          unescaped.push_back('\f');
+          break;
+        case 'n':
+          unescaped.push_back('\n');
+          break;
+        case 'r':
+          unescaped.push_back('\r');
+          break;
+        case 't':
+          unescaped.push_back('\t');
+          break;
+        case 'u': {
+          uint32_t code_point;
+          if (!ParseCodePoint(&code_point)) {
+            return false;
+          }
+          AppendUtf8(code_point, &unescaped);
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+    if (!Consume('"')) {
+      return false;
+    }
+    if (out) {
+      claims_->unescaped_.push_back(std::move(unescaped));
+      *out = claims_->unescaped_.back();
+    }
+    return true;
+  }
+
+  // Skips a well-formed UTF-8 sequence of two to four bytes: no overlong
+  // encoding, surrogate or code point above U+10FFFF.
+  bool SkipUtf8() {
+    const unsigned char lead = *pos_;
+    int length;
+    uint32_t code_point;
+    uint32_t min_code_point;
+    if ((lead & 0xE0) == 0xC0) {
+      length = 2;
+      code_point = lead & 0x1F;
+      min_code_point = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+      length = 3;
+      code_point = lead & 0x0F;
+      min_code_point = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+      length = 4;
+      code_point = lead & 0x07;
+      min_code_point = 0x10000;
+    } else {
+      return false;
+    }
+    if (end_ - pos_ < length) {
+      return false;
+    }
+    for (int i = 1; i < length; ++i) {
+      const unsigned char c = pos_[i];
+      if ((c & 0xC0) != 0x80) {
+        return false;
+      }
+      code_point = (code_point << 6) | (c & 0x3F);
+    }
+    if (code_point < min_code_point || code_point > 0x10FFFF ||
+        (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+      return false;
+    }
+    pos_ += length;
+    return true;
+  }
+
+  // Parses the hex digits of a \u escape, joining a surrogate pair.
+  bool ParseCodePoint(uint32_t* code_point) {
+    if (!ParseHex4(code_point)) {
+      return false;
+    }
+    if (*code_point >= 0xDC00 && *code_point <= 0xDFFF) {
+      return false;
+    }
+    if (*code_point < 0xD800 || *code_point > 0xDBFF) {
+      return true;
+    }
+    uint32_t low;
+    if (!Consume('\\') || !Consume('u') || !ParseHex4(&low) || low < 0xDC00 ||
+        low > 0xDFFF) {
+      return false;
+    }
+    *code_point = 0x10000 + ((*code_point - 0xD800) << 10) + (low - 0xDC00);
+    return true;
+  }
+
+  bool ParseHex4(uint32_t* value) {
+    if (end_ - pos_ < 4) {
+      return false;
+    }
+    *value = 0;
+    for (int i = 0; i < 4; ++i) {
+      int digit = HexValue(*pos_++);
+      if (digit < 0) {
+        return false;
+      }
+      *value = (*value << 4) | digit;
+    }
+    return true;
+  }
+
+  // Parses a number, an integer in the int64 range is set in "claim".
+  bool ParseNumber(JwtClaim* claim) {
+    bool negative = Consume('-');
+    if (pos_ >= end_ || !IsDigit(*pos_)) {
+      return false;
+    }
+    // The magnitude of the integer part, up to 2^63.
+    const uint64_t limit =
+        static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1;
+    uint64_t magnitude = 0;
+    bool in_range = true;
+    if (*pos_ == '0') {
+      ++pos_;
+    } else {
+      while (pos_ < end_ && IsDigit(*pos_)) {
+        uint64_t digit = *pos_++ - '0';
+        if (magnitude > (limit - digit) / 10) {
+          in_range = false;
+        } else {
+          magnitude = magnitude * 10 + digit;
+        }
+      }
+    }
+    bool is_integer = true;
+    if (Consume('.')) {
+      is_integer = false;
+      if (!ConsumeDigits()) {
+        return false;
+      }
+    }
+    if (pos_ < end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+      ++pos_;
+      is_integer = false;
+      if (!Consume('+')) {
+        Consume('-');
+      }
+      if (!ConsumeDigits()) {
+        return false;
+      }
+    }
+    if (claim && is_integer && in_range && (negative || magnitude < limit)) {
+      claim->is_integer = true;
+      claim->integer_value =
+          negative ? static_cast<int64_t>(0 - magnitude)
+                   : static_cast<int64_t>(magnitude);
+    }
+    return true;
+  }
+
+  bool ConsumeDigits() {
+    if (pos_ >= end_ || !IsDigit(*pos_)) {
+      return false;
+    }
+    while (pos_ < end_ && IsDigit(*pos_)) {
+      ++pos_;
+    }
+    return true;
+  }
+
+  bool ConsumeLiteral(absl::string_view literal) {
+    if (static_cast<size_t>(end_ - pos_) < literal.size() ||
+        absl::string_view(pos_, literal.size()) != literal) {
+      return false;
+    }
+    pos_ += literal.size();
+    return true;
+  }
+
+  bool Consume(char c) {
+    if (pos_ < end_ && *pos_ == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  void SkipSpace() {
+    while (pos_ < end_ && IsSpace(*pos_)) {
+      ++pos_;
+    }
+  }
+
+  bool AtEnd() {
+    SkipSpace();
+    return pos_ == end_;
+  }
+
+  static void SetType(JwtClaim* claim, JwtClaim::Type type) {
+    if (claim) {
+      claim->type = type;
+    }
+  }
+
+  const char* pos_;
+  const char* end_;
+  JwtClaims* claims_;
+};
+
+bool JwtClaims::Parse(absl::string_view json) {
+  claims_.clear();
+  unescaped_.clear();
+  if (Parser(json, this).ParseObject()) {
+    return true;
+  }
+  claims_.clear();
+  unescaped_.clear();
+  return false;
+}
+
+const JwtClaim* JwtClaims::Find(absl::string_view name) const {
+  for (auto it = claims_.rbegin(); it != claims_.rend(); ++it) {
+    if (it->name == name) {
+      return &*it;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace JwtAuth
+}  // namespace Http
+}  // namespace Envoy
@@ -0,0 +1,79 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace JwtAuth {
+
+// A top-level member of the JSON object of a JWT header or payload.
+struct JwtClaim {
+  enum class Type { STRING, NUMBER, BOOL, NULL_VALUE, ARRAY, OBJECT };
+
+  absl::string_view name;
+  Type type;
+  // The JSON text of the value, e.g. a whole nested object.
+  absl::string_view raw;
+  // The unescaped value of a STRING claim.
+  absl::string_view string_value;
+  // True for an ARRAY claim whose elements are all strings.
+  bool is_string_list;
+  // The unescaped elements of a string list claim.
+  std::vector<absl::string_view> string_list;
+  // True for a NUMBER claim which is an integer in the int64 range.
+  bool is_integer;
+  int64_t integer_value;
+};
+
+// Decodes the claims of a JWT header or payload in a single pass, without
+// building a JSON tree and without exceptions.  Names and strings are views
+// into the JSON text, only the strings with escape sequences are copied.
+// Nested values are validated and kept as their raw JSON text.
+//
+// The JSON text passed to Parse() must outlive the claims.
+class JwtClaims {
+ public:
+  JwtClaims() {}
+  JwtClaims(const JwtClaims&) = delete;
+  JwtClaims& operator=(const JwtClaims&) = delete;
+
+  // Returns false if "json" is not a valid JSON object.
+  bool Parse(absl::string_view json);
+
+  // Returns the claim with the name, the last one if it is duplicated, or
+  // nullptr if it does not exist.
+  const JwtClaim* Find(absl::string_view name) const;
+
+  const std::vector<JwtClaim>& claims() const { return claims_; }
+
+ private:
+  class Parser;
+
+  std::vector<JwtClaim> claims_;
+  // The unescaped strings, a deque keeps the views into them valid.
+  std::deque<std::string> unescaped_;
+};
+
+}  // namespace JwtAuth
+}  // namespace Http
+}  // namespace Envoy
@@ -0,0 +1,179 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/http/jwt_auth/jwt_claims.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace JwtAuth {
+namespace {
+
+TEST(JwtClaimsTest, RegisteredClaims) {
+  const std::string json = R"({
+    "iss": "https://example.com",
+    "sub": "test@example.com",
+    "aud": ["aud1", "aud2"],
+    "exp": 1501281058,
+    "scope": "read write"
+  })";
+  JwtClaims claims;
+  ASSERT_TRUE(claims.Parse(json));
+  EXPECT_EQ(claims.claims().size(), 5);
+
+  const JwtClaim* iss = claims.Find("iss");
+  ASSERT_NE(iss, nullptr);
+  EXPECT_EQ(iss->type, JwtClaim::Type::STRING);
+  EXPECT_EQ(iss->string_value, "https://example.com");
+  // Unescaped strings are views into the JSON text.
+  EXPECT_GE(iss->string_value.data(), json.data());
+  EXPECT_LT(iss->string_value.data(), json.data() + json.size());
+
+  const JwtClaim* aud = claims.Find("aud");
+  ASSERT_NE(aud, nullptr);
+  EXPECT_EQ(aud->type, JwtClaim::Type::ARRAY);
+  EXPECT_TRUE(aud->is_string_list);
+  ASSERT_EQ(aud->string_list.size(), 2);
+  EXPECT_EQ(aud->string_list[0], "aud1");
+  EXPECT_EQ(aud->string_list[1], "aud2");
+  EXPECT_EQ(aud->raw, R"(["aud1", "aud2"])");
+
+  const JwtClaim* exp = claims.Find("exp");
+  ASSERT_NE(exp, nullptr);
+  EXPECT_EQ(exp->type, JwtClaim::Type::NUMBER);
+  EXPECT_TRUE(exp->is_integer);
+  EXPECT_EQ(exp->integer_value, 1501281058);
+
+  EXPECT_EQ(claims.Find("azp"), nullptr);
+}
+
+TEST(JwtClaimsTest, NestedAndScalarClaims) {
+  const std::string json =
+      R"({"original_claims": {"iss": "a", "nested": [1, {"b": null}]},)"
+      R"( "mixed": ["a", 1], "admin": true, "nbf": 1.5e9, "acr": null,)"
+      R"( "big": 99999999999999999999, "neg": -9223372036854775808})";
+  JwtClaims claims;
+  ASSERT_TRUE(claims.Parse(json));
+
+  const JwtClaim* original = claims.Find("original_claims");
+  ASSERT_NE(original, nullptr);
+  EXPECT_EQ(original->type, JwtClaim::Type::OBJECT);
+  EXPECT_EQ(original->raw, R"({"iss": "a", "nested": [1, {"b": null}]})");
+
+  const JwtClaim* mixed = claims.Find("mixed");
+  ASSERT_NE(mixed, nullptr);
+  EXPECT_EQ(mixed->type, JwtClaim::Type::ARRAY);
+  EXPECT_FALSE(mixed->is_string_list);
+  EXPECT_TRUE(mixed->string_list.empty());
+
+  EXPECT_EQ(claims.Find("admin")->type, JwtClaim::Type::BOOL);
+  EXPECT_EQ(claims.Find("acr")->type, JwtClaim::Type::NULL_VALUE);
+  EXPECT_EQ(claims.Find("nbf")->type, JwtClaim::Type::NUMBER);
+  EXPECT_FALSE(claims.Find("nbf")->is_integer);
+  EXPECT_FALSE(claims.Find("big")->is_integer);
+  EXPECT_TRUE(claims.Find("neg")->is_integer);
+  EXPECT_EQ(claims.Find("neg")->integer_value, INT64_MIN);
+}
+
+TEST(JwtClaimsTest, EscapedStrings) {
+  JwtClaims claims;
+  ASSERT_TRUE(claims.Parse(
+      R"({"s\u0075b": "a\"b\\c\/d\n", "email": "\u00e9\ud83d\ude00"})"));
+  ASSERT_NE(claims.Find("sub"), nullptr);
+  EXPECT_EQ(claims.Find("sub")->string_value, "a\"b\\c/d\n");
+  EXPECT_EQ(claims.Find("email")->string_value, "\xC3\xA9\xF0\x9F\x98\x80");
+}
+
+TEST(JwtClaimsTest, Utf8Strings) {
+  JwtClaims claims;
+  ASSERT_TRUE(claims.Parse(
+      "{\"name\": \"\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\", "
+      "\"sub\": \"\xC3\xA9\\n\xF4\x8F\xBF\xBF\"}"));
+  EXPECT_EQ(claims.Find("name")->string_value,
+            "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+  EXPECT_EQ(claims.Find("sub")->string_value, "\xC3\xA9\n\xF4\x8F\xBF\xBF");
+
+  const char* invalid[] = {
+      // A continuation byte without lead byte.
+      "{\"iss\": \"\x80\"}",
+      // Truncated sequences.
+      "{\"iss\": \"\xC3\"}",
+      "{\"iss\": \"\xE2\x82\"}",
+      "{\"iss\": \"\xC3",
+      // Overlong encodings.
+      "{\"iss\": \"\xC0\xAF\"}",
+      "{\"iss\": \"\xE0\x80\xAF\"}",
+      // A surrogate, and a code point above U+10FFFF.
+      "{\"iss\": \"\xED\xA0\x80\"}",
+      "{\"iss\": \"\xF4\x90\x80\x80\"}",
+      // Not a lead byte, also after an escape.
+      "{\"iss\": \"\xFF\"}",
+      "{\"iss\": \"\\n\xFF\"}",
+      "{\"\xFF\": \"a\"}",
+  };
+  for (const char* json : invalid) {
+    JwtClaims invalid_claims;
+    EXPECT_FALSE(invalid_claims.Parse(json)) << json;
+  }
+}
+
+TEST(JwtClaimsTest, DuplicateClaim) {
+  JwtClaims claims;
+  ASSERT_TRUE(claims.Parse(R"({"iss": "first", "iss": "second"})"));
+  EXPECT_EQ(claims.Find("iss")->string_value, "second");
+}
+
+TEST(JwtClaimsTest, InvalidJson) {
+  const char* invalid[] = {
+      "",
+      "[]",
+      "\"iss\"",
+      "{",
+      "{\"iss\"}",
+      "{\"iss\": }",
+      "{\"iss\": \"a\",}",
+      "{\"iss\": \"a\"} x",
+      "{\"iss\": \"a\nb\"}",
+      "{\"iss\": \"\\x\"}",
+      "{\"iss\": \"\\ud800\"}",
+      "{\"iss\": tru}",
+      "{\"exp\": 01}",
+      "{\"exp\": 1.}",
+      "{\"exp\": -}",
+      "{\"aud\": [\"a\" \"b\"]}",
+      "{\"a\": {\"b\": [}}",
+  };
+  for (const char* json : invalid) {
+    JwtClaims claims;
+    EXPECT_FALSE(claims.Parse(json)) << json;
+    EXPECT_TRUE(claims.claims().empty());
+  }
+
+  std::string deep(100, '[');
+  JwtClaims claims;
+  EXPECT_FALSE(claims.Parse("{\"a\": " + deep + std::string(100, ']') + "}"));
+}
+
+TEST(JwtClaimsTest, EmptyObject) {
+  JwtClaims claims;
+  EXPECT_TRUE(claims.Parse(" { } "));
+  EXPECT_TRUE(claims.claims().empty());
+}
+
+}  // namespace
+}  // namespace JwtAuth
+}  // namespace Http
+}  // namespace Envoy
@@ -608,6 +608,17 @@ TEST_F(JwtTestPem, Base64urlBadInputPayload) {
          Status::JWT_PAYLOAD_PARSE_ERROR, nullptr);
 }
 
+TEST_F(JwtTestPem, NonStringIssuer) {
+  // Payload: {"iss":1,"exp":1501281058}
+  auto invalid_payload = "eyJpc3MiOjEsImV4cCI6MTUwMTI4MTA1OH0";
+  auto invalid_jwt = absl::StrJoin(
+      std::vector<std::string>{ds.kJwtHeaderEncoded, invalid_payload,
+                               ds.kJwtSignatureEncoded},
+      ".");
+  DoTest(invalid_jwt, ds.kPublicKey, "pem", false,
+         Status::JWT_PAYLOAD_PARSE_ERROR, nullptr);
+}
+
 TEST_F(JwtTestPem, Base64urlBadinputSignature) {
   auto invalid_signature = "a";
   auto invalid_jwt = absl::StrJoin(
@@ -708,6 +719,23 @@ TEST_F(JwtTestJwks, OkNoKidLogExp) {
          payload);
 }
 
+TEST_F(JwtTestJwks, MaxKidlessAttempts) {
+  auto key = Pubkeys::CreateFrom(ds.kPublicKeyRSA, Pubkeys::Type::JWKS);
+
+  // A JWT without kid may be verified by any of the keys.
+  Jwt jwt_no_kid(ds.kJwtNoKid);
+  Verifier no_attempts(0);
+  EXPECT_FALSE(no_attempts.Verify(jwt_no_kid, *key));
+  EXPECT_EQ(no_attempts.GetStatus(), Status::JWT_INVALID_SIGNATURE);
+  Verifier two_attempts(2);
+  EXPECT_TRUE(two_attempts.Verify(jwt_no_kid, *key));
+
+  // The key selected by kid is always tried.
+  Jwt jwt_with_kid(ds.kJwtWithCorrectKid);
+  Verifier kid_selected(0);
+  EXPECT_TRUE(kid_selected.Verify(jwt_with_kid, *key));
+}
+
 TEST_F(JwtTestJwks, OkCorrectKid) {
   auto payload = Json::Factory::loadFromString(ds.kJwtPayload);
   DoTest(ds.kJwtWithCorrectKid, ds.kPublicKeyRSA, "jwks", true, Status::OK,
@@ -30,6 +30,9 @@ namespace {
 // Default cache expiration time in 5 minutes.
 const int kPubkeyCacheExpirationSec = 600;
 
+// A failed remote public key fetch is cached for 5 seconds.
+const int kPubkeyFetchFailureExpirationSec = 5;
+
 // HTTP Protocol scheme prefix in JWT aud claim.
 const std::string kHTTPSchemePrefix("http://");
 
@@ -121,6 +124,23 @@ class PubkeyCacheItem : public Logger::Loggable<Logger::Id::filter> {
     return SetKey(pubkey_str, GetRemoteJwksExpirationTime());
   }
 
+  // Cache the failure of a remote public key fetch for a short interval.
+  void SetFetchFailed(Status status) {
+    fetch_failure_status_ = status;
+    fetch_failure_expiration_time_ =
+        std::chrono::steady_clock::now() +
+        std::chrono::seconds(kPubkeyFetchFailureExpirationSec);
+  }
+
+  // Return the cached failure of the last fetch, or Status::OK if there is
+  // none or it is expired.
+  Status FetchFailure() const {
+    if (std::chrono::steady_clock::now() >= fetch_failure_expiration_time_) {
+      return Status::OK;
+    }
+    return fetch_failure_status_;
+  }
+
  private:
   // Get the expiration time for remote JWKS
   std::chrono::steady_clock::time_point GetRemoteJwksExpirationTime() const {
@@ -183,6 +203,10 @@ class PubkeyCacheItem : public Logger::Loggable<Logger::Id::filter> {
   std::unique_ptr<Pubkeys> pubkey_;
   // The pubkey expiration time.
   std::chrono::steady_clock::time_point expiration_time_;
+  // The status of the last failed fetch.
+  Status fetch_failure_status_{Status::OK};
+  // The expiration time of the last failed fetch.
+  std::chrono::steady_clock::time_point fetch_failure_expiration_time_;
 };
 
 // Pubkey cache
@@ -0,0 +1,146 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/http/jwt_auth/pubkey_fetcher.h"
+
+#include "common/http/message_impl.h"
+#include "common/http/utility.h"
+
+namespace Envoy {
+namespace Http {
+namespace JwtAuth {
+namespace {
+
+// Extract host and path from a URI
+void ExtractUriHostPath(const std::string &uri, std::string *host,
+                        std::string *path) {
+  // Example:
+  // uri  = "https://example.com/certs"
+  // pos  :          ^
+  // pos1 :                     ^
+  // host = "example.com"
+  // path = "/certs"
+  auto pos = uri.find("://");
+  pos = pos == std::string::npos ? 0 : pos + 3;  // Start position of host
+  auto pos1 = uri.find("/", pos);
+  if (pos1 == std::string::npos) {
+    // If uri doesn't have "/", the whole string is treated as host.
+    *host = uri.substr(pos);
+    *path = "/";
+  } else {
+    *host = uri.substr(pos, pos1 - pos);
+    *path = "/" + uri.substr(pos1 + 1);
+  }
+}
+
+}  // namespace
+
+PubkeyFetcher::PubkeyFetcher(PubkeyCacheItem &issuer) : issuer_(issuer) {}
+
+PubkeyFetcher::~PubkeyFetcher() {
+  if (request_) {
+    request_->cancel();
+  }
+}
+
+void PubkeyFetcher::Fetch(Upstream::ClusterManager &cm,
+                          Callbacks *callbacks) {
+  waiters_.push_back(callbacks);
+  if (fetching_) {
+    ENVOY_LOG(debug, "fetch pubkey [uri = {}]: wait for the pending fetch",
+              uri_);
+    return;
+  }
+
+  uri_ = issuer_.jwt_config().remote_jwks().http_uri().uri();
+  std::string host, path;
+  ExtractUriHostPath(uri_, &host, &path);
+
+  RequestMessagePtr message(new RequestMessageImpl());
+  message->headers().setReferenceMethod(Http::Headers::get().MethodValues.Get);
+  message->headers().setPath(path);
+  message->headers().setHost(host);
+
+  const auto &cluster = issuer_.jwt_config().remote_jwks().http_uri().cluster();
+  if (cm.get(cluster) == nullptr) {
+    Done(Status::FAILED_FETCH_PUBKEY);
+    return;
+  }
+
+  ENVOY_LOG(debug, "fetch pubkey from [uri = {}]: start", uri_);
+  fetching_ = true;
+  AsyncClient::Request *request = cm.httpAsyncClientForCluster(cluster).send(
+      std::move(message), *this, Http::AsyncClient::RequestOptions());
+  // The fetch may be done before send() returns.
+  if (fetching_) {
+    request_ = request;
+  }
+}
+
+void PubkeyFetcher::Cancel(Callbacks *callbacks) {
+  waiters_.remove(callbacks);
+  if (waiters_.empty() && request_) {
+    request_->cancel();
+    request_ = nullptr;
+    fetching_ = false;
+    ENVOY_LOG(debug, "fetch pubkey [uri = {}]: canceled", uri_);
+  }
+}
+
+void PubkeyFetcher::onSuccess(ResponseMessagePtr &&response) {
+  request_ = nullptr;
+  uint64_t status_code = Http::Utility::getResponseStatus(response->headers());
+  if (status_code == 200) {
+    ENVOY_LOG(debug, "fetch pubkey [uri = {}]: success", uri_);
+    std::string body;
+    if (response->body()) {
+      auto len = response->body()->length();
+      body = std::string(static_cast<char *>(response->body()->linearize(len)),
+                         len);
+    } else {
+      ENVOY_LOG(debug, "fetch pubkey [uri = {}]: body is empty", uri_);
+    }
+    Done(issuer_.SetRemoteJwks(body));
+  } else {
+    ENVOY_LOG(debug, "fetch pubkey [uri = {}]: response status code {}", uri_,
+              status_code);
+    Done(Status::FAILED_FETCH_PUBKEY);
+  }
+}
+
+void PubkeyFetcher::onFailure(AsyncClient::FailureReason) {
+  request_ = nullptr;
+  ENVOY_LOG(debug, "fetch pubkey [uri = {}]: failed", uri_);
+  Done(Status::FAILED_FETCH_PUBKEY);
+}
+
+void PubkeyFetcher::Done(Status status) {
+  fetching_ = false;
+  request_ = nullptr;
+  if (status != Status::OK) {
+    issuer_.SetFetchFailed(status);
+  }
+  // A waiter may cancel another one while it is resumed, so they are
+  // removed one at a time.
+  while (!waiters_.empty()) {
+    Callbacks *callbacks = waiters_.front();
+    waiters_.pop_front();
+    callbacks->OnFetchPubkeyDone(status);
+  }
+}
+
+}  // namespace JwtAuth
+}  // namespace Http
+}  // namespace Envoy
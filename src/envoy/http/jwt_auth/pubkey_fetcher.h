@@ -0,0 +1,78 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <list>
+#include <string>
+
+#include "common/common/logger.h"
+#include "envoy/http/async_client.h"
+#include "envoy/upstream/cluster_manager.h"
+#include "src/envoy/http/jwt_auth/pubkey_cache.h"
+
+namespace Envoy {
+namespace Http {
+namespace JwtAuth {
+
+// Fetches the remote public keys of an issuer for a worker thread.
+// Concurrent requests needing the keys wait on one pending fetch, and are all
+// resumed when it completes or fails. The keys are parsed once into the
+// issuer cache item, and a failure is cached for a short interval.
+class PubkeyFetcher : public Logger::Loggable<Logger::Id::filter>,
+                      public AsyncClient::Callbacks {
+ public:
+  PubkeyFetcher(PubkeyCacheItem& issuer);
+  ~PubkeyFetcher();
+
+  // The callback interface to notify the fetch done event.
+  class Callbacks {
+   public:
+    virtual ~Callbacks() {}
+    // Called with Status::OK if the issuer has new public keys.
+    virtual void OnFetchPubkeyDone(Status status) PURE;
+  };
+
+  // Waits for the public keys, starts a fetch unless one is pending.
+  // The callback may be called before this returns.
+  void Fetch(Upstream::ClusterManager& cm, Callbacks* callbacks);
+
+  // Stops waiting for the public keys. The pending fetch is canceled when
+  // nobody waits for it anymore.
+  void Cancel(Callbacks* callbacks);
+
+ private:
+  // Following two functions are for AyncClient::Callbacks
+  void onSuccess(ResponseMessagePtr&& response) override;
+  void onFailure(AsyncClient::FailureReason) override;
+
+  // Caches the fetch result and resumes all the waiting requests.
+  void Done(Status status);
+
+  // The issuer cache item to store the public keys.
+  PubkeyCacheItem& issuer_;
+  // The requests waiting for the pending fetch.
+  std::list<Callbacks*> waiters_;
+  // True while a fetch is pending.
+  bool fetching_{};
+  // The pending uri_, only used for logging.
+  std::string uri_;
+  // The pending remote request so it can be canceled.
+  AsyncClient::Request* request_{};
+};
+
+}  // namespace JwtAuth
+}  // namespace Http
+}  // namespace Envoy
@@ -15,9 +15,10 @@
 
 #include "src/envoy/http/jwt_auth/token_extractor.h"
 
+#include <map>
+
 #include "absl/strings/match.h"
 #include "common/common/utility.h"
-#include "common/http/utility.h"
 
 using ::istio::envoy::config::filter::http::jwt_auth::v2alpha1::
     JwtAuthentication;
@@ -36,19 +37,31 @@ const std::string kParamAccessToken = "access_token";
 }  // namespace
 
 JwtTokenExtractor::JwtTokenExtractor(const JwtAuthentication &config) {
+  struct LowerCaseStringCmp {
+    bool operator()(const LowerCaseString &lhs,
+                    const LowerCaseString &rhs) const {
+      return lhs.get() < rhs.get();
+    }
+  };
+  // The map of header to set of issuers
+  std::map<LowerCaseString, std::set<std::string>, LowerCaseStringCmp>
+      header_maps;
+  // The map of parameters to set of issuers.
+  std::map<std::string, std::set<std::string>> param_maps;
+
   for (const auto &jwt : config.rules()) {
     bool use_default = true;
     if (jwt.from_headers_size() > 0) {
       use_default = false;
       for (const auto &header : jwt.from_headers()) {
-        auto &issuers = header_maps_[LowerCaseString(header.name())];
+        auto &issuers = header_maps[LowerCaseString(header.name())];
         issuers.insert(jwt.issuer());
       }
     }
     if (jwt.from_params_size() > 0) {
       use_default = false;
       for (const std::string &param : jwt.from_params()) {
-        auto &issuers = param_maps_[param];
+        auto &issuers = param_maps[param];
         issuers.insert(jwt.issuer());
       }
     }
@@ -57,10 +70,18 @@ JwtTokenExtractor::JwtTokenExtractor(const JwtAuthentication &config) {
     if (use_default) {
       authorization_issuers_.insert(jwt.issuer());
 
-      auto &param_issuers = param_maps_[kParamAccessToken];
+      auto &param_issuers = param_maps[kParamAccessToken];
       param_issuers.insert(jwt.issuer());
     }
   }
+
+  for (auto &header_it : header_maps) {
+    header_locations_.push_back(
+        {header_it.first, std::move(header_it.second)});
+  }
+  for (auto &param_it : param_maps) {
+    param_locations_.push_back({param_it.first, std::move(param_it.second)});
+  }
 }
 
 void JwtTokenExtractor::Extract(
@@ -73,8 +94,8 @@ void JwtTokenExtractor::Extract(
       auto value = entry->value().getStringView();
       if (absl::StartsWith(value, kBearerPrefix)) {
         value.remove_prefix(kBearerPrefix.length());
-        tokens->emplace_back(new Token(std::string(value),
-                                       authorization_issuers_, true, nullptr));
+        tokens->emplace_back(
+            new Token(value, authorization_issuers_, true, nullptr));
         // Only take the first one.
         return;
       }
@@ -82,41 +103,101 @@ void JwtTokenExtractor::Extract(
   }
 
   // Check header first
-  for (const auto &header_it : header_maps_) {
-    const HeaderEntry *entry = headers.get(header_it.first);
-    if (entry) {
-      std::string token;
-      absl::string_view val = entry->value().getStringView();
-      size_t pos = val.find(' ');
-      if (pos != absl::string_view::npos) {
-        // If the header value has prefix, trim the prefix.
-        token = std::string(val.substr(pos + 1));
-      } else {
-        token = std::string(val);
-      }
+  if (ExtractFromHeaders(headers, tokens)) {
+    return;
+  }
+  ExtractFromParams(headers, tokens);
+}
 
-      tokens->emplace_back(
-          new Token(token, header_it.second, false, &header_it.first));
-      // Only take the first one.
-      return;
-    }
+bool JwtTokenExtractor::ExtractFromHeaders(
+    const RequestHeaderMap &headers,
+    std::vector<std::unique_ptr<JwtTokenExtractor::Token>> *tokens) const {
+  if (header_locations_.empty()) {
+    return false;
   }
 
-  if (param_maps_.empty() || headers.Path() == nullptr) {
+  // Scan the headers once for the first location which has a token.
+  struct Context {
+    const std::vector<HeaderLocation> &locations;
+    const HeaderEntry *entry;
+    size_t index;
+  };
+  Context ctx{header_locations_, nullptr, header_locations_.size()};
+  headers.iterate(
+      [](const HeaderEntry &header, void *context) -> HeaderMap::Iterate {
+        Context *ctx = static_cast<Context *>(context);
+        const absl::string_view key = header.key().getStringView();
+        // Only the locations before the current match are checked.
+        for (size_t i = 0; i < ctx->index; ++i) {
+          if (ctx->locations[i].header.get() == key) {
+            ctx->entry = &header;
+            ctx->index = i;
+            break;
+          }
+        }
+        return ctx->index == 0 ? HeaderMap::Iterate::Break
+                               : HeaderMap::Iterate::Continue;
+      },
+      &ctx);
+  if (ctx.entry == nullptr) {
+    return false;
+  }
+
+  absl::string_view val = ctx.entry->value().getStringView();
+  size_t pos = val.find(' ');
+  if (pos != absl::string_view::npos) {
+    // If the header value has prefix, trim the prefix.
+    val.remove_prefix(pos + 1);
+  }
+  const HeaderLocation &location = header_locations_[ctx.index];
+  tokens->emplace_back(
+      new Token(val, location.issuers, false, &location.header));
+  // Only take the first one.
+  return true;
+}
+
+void JwtTokenExtractor::ExtractFromParams(
+    const RequestHeaderMap &headers,
+    std::vector<std::unique_ptr<JwtTokenExtractor::Token>> *tokens) const {
+  if (param_locations_.empty() || headers.Path() == nullptr) {
     return;
   }
 
-  const auto &params = Utility::parseQueryString(
-      std::string(headers.Path()->value().getStringView()));
-  for (const auto &param_it : param_maps_) {
-    const auto &it = params.find(param_it.first);
-    if (it != params.end()) {
-      tokens->emplace_back(
-          new Token(it->second, param_it.second, false, nullptr));
-      // Only take the first one.
-      return;
+  // Scan the query string once for the first location which has a token,
+  // splitting it as Utility::parseQueryString() does.
+  const absl::string_view path = headers.Path()->value().getStringView();
+  size_t start = path.find('?');
+  if (start == absl::string_view::npos) {
+    return;
+  }
+  ++start;
+  size_t index = param_locations_.size();
+  absl::string_view token;
+  while (start < path.size() && index > 0) {
+    size_t end = path.find('&', start);
+    if (end == absl::string_view::npos) {
+      end = path.size();
+    }
+    const absl::string_view param = path.substr(start, end - start);
+    const size_t equal = param.find('=');
+    const absl::string_view name = param.substr(0, equal);
+    // Only the locations before the current match are checked.
+    for (size_t i = 0; i < index; ++i) {
+      if (param_locations_[i].param == name) {
+        index = i;
+        token = equal == absl::string_view::npos ? absl::string_view()
+                                                 : param.substr(equal + 1);
+        break;
+      }
     }
+    start = end + 1;
   }
+  if (index == param_locations_.size()) {
+    return;
+  }
+
+  tokens->emplace_back(
+      new Token(token, param_locations_[index].issuers, false, nullptr));
 }
 
 }  // namespace JwtAuth
@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include "absl/strings/string_view.h"
 #include "common/common/logger.h"
 #include "envoy/config/filter/http/jwt_auth/v2alpha1/config.pb.h"
 #include "envoy/http/header_map.h"
@@ -34,6 +35,10 @@ namespace JwtAuth {
 //     query parameter: ?access_token=<token>
 // * A token must be extracted from the location specified by its issuer.
 //
+// The locations are compiled into priority ordered lists, so a request's
+// headers and query string are each scanned once, and only the extracted
+// token is copied.
+//
 class JwtTokenExtractor : public Logger::Loggable<Logger::Id::filter> {
  public:
   JwtTokenExtractor(const ::istio::envoy::config::filter::http::jwt_auth::
@@ -44,7 +49,7 @@ class JwtTokenExtractor : public Logger::Loggable<Logger::Id::filter> {
   // has the allowed issuers that have specified the location.
   class Token {
    public:
-    Token(const std::string& token, const std::set<std::string>& issuers,
+    Token(absl::string_view token, const std::set<std::string>& issuers,
           bool from_authorization, const LowerCaseString* header_name)
         : token_(token),
           allowed_issuers_(issuers),
@@ -83,17 +88,30 @@ class JwtTokenExtractor : public Logger::Loggable<Logger::Id::filter> {
                std::vector<std::unique_ptr<Token>>* tokens) const;
 
  private:
-  struct LowerCaseStringCmp {
-    bool operator()(const LowerCaseString& lhs,
-                    const LowerCaseString& rhs) const {
-      return lhs.get() < rhs.get();
-    }
+  // A custom header token location, and the issuers which specified it.
+  struct HeaderLocation {
+    LowerCaseString header;
+    std::set<std::string> issuers;
+  };
+  // A query parameter token location, and the issuers which specified it.
+  struct ParamLocation {
+    std::string param;
+    std::set<std::string> issuers;
   };
-  // The map of header to set of issuers
-  std::map<LowerCaseString, std::set<std::string>, LowerCaseStringCmp>
-      header_maps_;
-  // The map of parameters to set of issuers.
-  std::map<std::string, std::set<std::string>> param_maps_;
+
+  // Finds the token in the custom headers. Returns false if there is none.
+  bool ExtractFromHeaders(const RequestHeaderMap& headers,
+                          std::vector<std::unique_ptr<Token>>* tokens) const;
+  // Finds the token in the query parameters.
+  void ExtractFromParams(const RequestHeaderMap& headers,
+                         std::vector<std::unique_ptr<Token>>* tokens) const;
+
+  // The custom header locations, sorted by header name. If several headers
+  // have a token, the first of them is used.
+  std::vector<HeaderLocation> header_locations_;
+  // The query parameter locations, sorted by parameter name. If several
+  // parameters have a token, the first of them is used.
+  std::vector<ParamLocation> param_locations_;
   // Special handling of Authorization header.
   std::set<std::string> authorization_issuers_;
 };
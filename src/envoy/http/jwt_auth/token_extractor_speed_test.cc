@@ -0,0 +1,122 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "google/protobuf/util/json_util.h"
+#include "src/envoy/http/jwt_auth/token_extractor.h"
+#include "test/test_common/utility.h"
+
+using ::istio::envoy::config::filter::http::jwt_auth::v2alpha1::
+    JwtAuthentication;
+
+namespace Envoy {
+namespace Http {
+namespace JwtAuth {
+namespace {
+
+const char kConfig[] = R"(
+{
+   "rules": [
+      {
+         "issuer": "issuer1"
+      },
+      {
+         "issuer": "issuer2",
+         "from_headers": [
+             {
+                "name": "x-token-a"
+             },
+             {
+                "name": "x-token-b"
+             }
+         ],
+         "from_params": [
+             "token_a",
+             "token_b"
+         ]
+      }
+   ]
+}
+)";
+
+JwtAuthentication LoadConfig() {
+  JwtAuthentication config;
+  ::google::protobuf::util::JsonStringToMessage(kConfig, &config);
+  return config;
+}
+
+// A path with "num_params" query parameters, the token is the last one.
+std::string LongPath(int num_params) {
+  std::string path = "/api/v1/resource?";
+  for (int i = 0; i < num_params; ++i) {
+    path += "param" + std::to_string(i) + "=value" + std::to_string(i) + "&";
+  }
+  return path + "token_b=jwt_token";
+}
+
+}  // namespace
+
+static void BM_ExtractFromLongUrl(benchmark::State& state) {
+  JwtTokenExtractor extractor(LoadConfig());
+  TestRequestHeaderMapImpl headers{
+      {":method", "GET"},
+      {":path", LongPath(state.range(0))},
+      {":authority", "example.com"},
+  };
+
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+    extractor.Extract(headers, &tokens);
+    benchmark::DoNotOptimize(tokens);
+  }
+}
+BENCHMARK(BM_ExtractFromLongUrl)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_ExtractFromManyHeaders(benchmark::State& state) {
+  JwtTokenExtractor extractor(LoadConfig());
+  TestRequestHeaderMapImpl headers{
+      {":method", "GET"},
+      {":path", "/api/v1/resource"},
+      {":authority", "example.com"},
+  };
+  for (int i = 0; i < state.range(0); ++i) {
+    headers.addCopy(LowerCaseString("x-header-" + std::to_string(i)),
+                    "value" + std::to_string(i));
+  }
+  headers.addCopy(LowerCaseString("x-token-b"), "Bearer jwt_token");
+
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+    extractor.Extract(headers, &tokens);
+    benchmark::DoNotOptimize(tokens);
+  }
+}
+BENCHMARK(BM_ExtractFromManyHeaders)->Arg(10)->Arg(100);
+
+}  // namespace JwtAuth
+}  // namespace Http
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -190,6 +190,29 @@ TEST_F(JwtTokenExtractorTest, TestMultipleTokens) {
   EXPECT_EQ(tokens[0]->token(), "header_token");
 }
 
+TEST_F(JwtTokenExtractorTest, TestParamTokenAmongManyParams) {
+  // The first location in name order wins, whatever the parameter order.
+  auto headers = TestRequestHeaderMapImpl{
+      {":path",
+       "/path?a=1&token_param=param_token&b&access_token=first&"
+       "access_token=second&c=3"}};
+  std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+  extractor_->Extract(headers, &tokens);
+  ASSERT_EQ(tokens.size(), 1);
+  EXPECT_EQ(tokens[0]->token(), "first");
+  EXPECT_TRUE(tokens[0]->IsIssuerAllowed("issuer1"));
+  EXPECT_FALSE(tokens[0]->IsIssuerAllowed("issuer3"));
+}
+
+TEST_F(JwtTokenExtractorTest, TestParamTokenWithoutValue) {
+  auto headers =
+      TestRequestHeaderMapImpl{{":path", "/path?token_param&x=token_param"}};
+  std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+  extractor_->Extract(headers, &tokens);
+  ASSERT_EQ(tokens.size(), 1);
+  EXPECT_EQ(tokens[0]->token(), "");
+}
+
 }  // namespace JwtAuth
 }  // namespace Http
 }  // namespace Envoy
@@ -20,6 +20,7 @@
 #include "src/envoy/http/jwt_auth/jwt.h"
 #include "src/envoy/http/jwt_auth/jwt_authenticator.h"
 #include "src/envoy/utils/authn.h"
+#include "src/envoy/utils/connection_identity.h"
 #include "src/envoy/utils/header_update.h"
 #include "src/envoy/utils/utils.h"
 
@@ -42,11 +43,18 @@ const std::set<std::string> RequestHeaderExclusives = {
 CheckData::CheckData(const RequestHeaderMap& headers,
                      const envoy::config::core::v3::Metadata& metadata,
                      const Network::Connection* connection)
-    : headers_(headers), metadata_(metadata), connection_(connection) {
-  if (headers_.Path()) {
-    query_params_ =
-        Utility::parseQueryString(headers_.Path()->value().getStringView());
+    : headers_(headers), metadata_(metadata), connection_(connection) {}
+
+const Utility::QueryParams& CheckData::ParsedQueryParams() const {
+  if (!query_params_) {
+    if (headers_.Path()) {
+      query_params_ =
+          Utility::parseQueryString(headers_.Path()->value().getStringView());
+    } else {
+      query_params_.emplace();
+    }
   }
+  return *query_params_;
 }
 
 bool CheckData::ExtractIstioAttributes(std::string* data) const {
@@ -62,13 +70,19 @@ bool CheckData::ExtractIstioAttributes(std::string* data) const {
 
 bool CheckData::GetSourceIpPort(std::string* ip, int* port) const {
   if (connection_) {
-    return Utils::GetIpPort(connection_->remoteAddress()->ip(), ip, port);
+    // HTTP requests are decoded after the TLS handshake completed.
+    return Utils::ConnectionIdentity::get(*connection_, true)
+        ->remoteIpPort(ip, port);
   }
   return false;
 }
 
 bool CheckData::GetPrincipal(bool peer, std::string* user) const {
-  return Utils::GetPrincipal(connection_, peer, user);
+  if (connection_) {
+    return Utils::ConnectionIdentity::get(*connection_, true)
+        ->principal(peer, user);
+  }
+  return false;
 }
 
 std::map<std::string, std::string> CheckData::GetRequestHeaders() const {
@@ -77,58 +91,49 @@ std::map<std::string, std::string> CheckData::GetRequestHeaders() const {
   return header_map;
 }
 
-bool CheckData::IsMutualTLS() const { return Utils::IsMutualTLS(connection_); }
+void CheckData::CopyRequestHeaders(
+    const ::istio::control::http::HeaderNameSet* names,
+    ::google::protobuf::Map<std::string, std::string>* headers) const {
+  Utils::CopyHeaders(headers_, RequestHeaderExclusives, names, headers);
+}
+
+bool CheckData::IsMutualTLS() const {
+  return connection_ &&
+         Utils::ConnectionIdentity::get(*connection_, true)->mutualTls();
+}
 
 bool CheckData::GetRequestedServerName(std::string* name) const {
   return Utils::GetRequestedServerName(connection_, name);
 }
 
-bool CheckData::FindHeaderByType(HttpCheckData::HeaderType header_type,
-                                 std::string* value) const {
+const HeaderEntry* CheckData::FindHeaderEntry(
+    HttpCheckData::HeaderType header_type) const {
   switch (header_type) {
     case HttpCheckData::HEADER_PATH:
-      if (headers_.Path()) {
-        *value = std::string(headers_.Path()->value().getStringView());
-        return true;
-      }
-      break;
+      return headers_.Path();
     case HttpCheckData::HEADER_HOST:
-      if (headers_.Host()) {
-        *value = std::string(headers_.Host()->value().getStringView());
-        return true;
-      }
-      break;
+      return headers_.Host();
     case HttpCheckData::HEADER_SCHEME:
-      if (headers_.Scheme()) {
-        *value = std::string(headers_.Scheme()->value().getStringView());
-        return true;
-      }
-      break;
+      return headers_.Scheme();
     case HttpCheckData::HEADER_USER_AGENT:
-      if (headers_.UserAgent()) {
-        *value = std::string(headers_.UserAgent()->value().getStringView());
-        return true;
-      }
-      break;
+      return headers_.UserAgent();
     case HttpCheckData::HEADER_METHOD:
-      if (headers_.Method()) {
-        *value = std::string(headers_.Method()->value().getStringView());
-        return true;
-      }
-      break;
+      return headers_.Method();
     case HttpCheckData::HEADER_CONTENT_TYPE:
-      if (headers_.ContentType()) {
-        *value = std::string(headers_.ContentType()->value().getStringView());
-        return true;
-      }
-      break;
-    case HttpCheckData::HEADER_REFERER: {
-      const HeaderEntry* referer = headers_.get(kRefererHeaderKey);
-      if (referer) {
-        *value = std::string(referer->value().getStringView());
-        return true;
-      }
-    } break;
+      return headers_.ContentType();
+    case HttpCheckData::HEADER_REFERER:
+      return headers_.get(kRefererHeaderKey);
+  }
+  return nullptr;
+}
+
+bool CheckData::FindHeaderByType(HttpCheckData::HeaderType header_type,
+                                 std::string* value) const {
+  const HeaderEntry* entry = FindHeaderEntry(header_type);
+  if (entry) {
+    const absl::string_view view = entry->value().getStringView();
+    value->assign(view.data(), view.size());
+    return true;
   }
   return false;
 }
@@ -137,7 +142,8 @@ bool CheckData::FindHeaderByName(const std::string& name,
                                  std::string* value) const {
   const HeaderEntry* entry = headers_.get(LowerCaseString(name));
   if (entry) {
-    *value = std::string(entry->value().getStringView());
+    const absl::string_view view = entry->value().getStringView();
+    value->assign(view.data(), view.size());
     return true;
   }
   return false;
@@ -145,8 +151,9 @@ bool CheckData::FindHeaderByName(const std::string& name,
 
 bool CheckData::FindQueryParameter(const std::string& name,
                                    std::string* value) const {
-  const auto& it = query_params_.find(name);
-  if (it != query_params_.end()) {
+  const auto& params = ParsedQueryParams();
+  const auto& it = params.find(name);
+  if (it != params.end()) {
     *value = it->second;
     return true;
   }
@@ -173,13 +180,7 @@ bool CheckData::GetUrlPath(std::string* url_path) const {
   const HeaderString& path = headers_.Path()->value();
   const absl::string_view path_view = path.getStringView();
   absl::string_view query_start = Utility::findQueryStringStart(path);
-  if (query_start.length() > 0) {
-    const size_t path_string_length = path.size() - query_start.length();
-    *url_path =
-        std::string(path_view.begin(), path_view.begin() + path_string_length);
-  } else {
-    *url_path = std::string(path_view);
-  }
+  url_path->assign(path_view.data(), path.size() - query_start.length());
   return true;
 }
 
@@ -188,8 +189,7 @@ bool CheckData::GetRequestQueryParams(
   if (!headers_.Path()) {
     return false;
   }
-  *query_params =
-      Utility::parseQueryString(headers_.Path()->value().getStringView());
+  *query_params = ParsedQueryParams();
   return true;
 }
 
@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include "absl/types/optional.h"
 #include "common/common/logger.h"
 #include "common/http/utility.h"
 #include "envoy/config/core/v3/base.pb.h"
@@ -44,6 +45,11 @@ class CheckData : public ::istio::control::http::CheckData,
 
   std::map<std::string, std::string> GetRequestHeaders() const override;
 
+  void CopyRequestHeaders(
+      const ::istio::control::http::HeaderNameSet* names,
+      ::google::protobuf::Map<std::string, std::string>* headers)
+      const override;
+
   bool IsMutualTLS() const override;
 
   bool GetRequestedServerName(std::string* name) const override;
@@ -68,10 +74,19 @@ class CheckData : public ::istio::control::http::CheckData,
       std::map<std::string, std::string>* query_params) const override;
 
  private:
+  // Find the header entry of a header type, nullptr if not present.
+  const HeaderEntry* FindHeaderEntry(
+      ::istio::control::http::CheckData::HeaderType header_type) const;
+
+  // The query parameters, parsed on first use.
+  const Utility::QueryParams& ParsedQueryParams() const;
+
   const RequestHeaderMap& headers_;
   const envoy::config::core::v3::Metadata& metadata_;
   const Network::Connection* connection_;
-  Utility::QueryParams query_params_;
+
+  // Parsed on first use, most requests never need them.
+  mutable absl::optional<Utility::QueryParams> query_params_;
 };
 
 }  // namespace Mixer
@@ -55,10 +55,14 @@ Control::Control(ControlDataSharedPtr control_data,
 
   ::istio::control::http::Controller::Options options(
       control_data_->config().config_pb(), local_node);
+  options.project_report_headers = Utils::ExtractReportHeaders(
+      local_info.node(), &options.report_header_allowlist);
 
   Utils::CreateEnvironment(dispatcher, random, *check_client_factory_,
                            *report_client_factory_,
                            serialized_forward_attributes_, &options.env);
+  options.env.report_aggregator = control_data_->report_aggregator();
+  options.env.quota_pool = control_data_->quota_pool();
 
   controller_ = ::istio::control::http::Controller::Create(options);
 }
@@ -34,15 +34,31 @@ namespace Mixer {
 
 class ControlData {
  public:
-  ControlData(std::unique_ptr<Config> config, Utils::MixerFilterStats stats)
-      : config_(std::move(config)), stats_(stats) {}
+  ControlData(std::unique_ptr<Config> config, Utils::MixerFilterStats stats,
+              Runtime::Loader& runtime)
+      : config_(std::move(config)),
+        stats_(stats),
+        report_aggregator_(Utils::GetReportAggregator(
+            config_->config_pb().transport(), runtime)),
+        quota_pool_(::istio::mixerclient::CreateQuotaPool()) {}
 
   const Config& config() { return *config_; }
   Utils::MixerFilterStats& stats() { return stats_; }
+  const std::shared_ptr<::istio::mixerclient::ReportAggregator>&
+  report_aggregator() {
+    return report_aggregator_;
+  }
+  const std::shared_ptr<::istio::mixerclient::QuotaPool>& quota_pool() {
+    return quota_pool_;
+  }
 
  private:
   std::unique_ptr<Config> config_;
   Utils::MixerFilterStats stats_;
+  // Report aggregator shared by the per-thread controls.
+  std::shared_ptr<::istio::mixerclient::ReportAggregator> report_aggregator_;
+  // Quota pool shared by the per-thread controls.
+  std::shared_ptr<::istio::mixerclient::QuotaPool> quota_pool_;
 };
 
 typedef std::shared_ptr<ControlData> ControlDataSharedPtr;
@@ -38,8 +38,8 @@ class ControlFactory : public Logger::Loggable<Logger::Id::config> {
   ControlFactory(std::unique_ptr<Config> config,
                  Server::Configuration::FactoryContext& context)
       : control_data_(std::make_shared<ControlData>(
-            std::move(config),
-            generateStats(kHttpStatsPrefix, context.scope()))),
+            std::move(config), generateStats(kHttpStatsPrefix, context.scope()),
+            context.runtime())),
         tls_(context.threadLocal().allocateSlot()) {
     Upstream::ClusterManager& cm = context.clusterManager();
     Runtime::RandomGenerator& random = context.random();
@@ -50,10 +50,9 @@ Filter::Filter(Control& control)
 void Filter::ReadPerRouteConfig(
     const PerRouteServiceConfig& route_cfg,
     ::istio::control::http::Controller::PerRouteConfig* config) {
-  if (!control_.controller()->LookupServiceConfig(route_cfg.hash)) {
-    control_.controller()->AddServiceConfig(route_cfg.hash, route_cfg.config);
-  }
-  config->service_config_id = route_cfg.hash;
+  // The controller finds the service context by the precomputed key.
+  config->route_key = route_cfg.key;
+  config->service_config = &route_cfg.config;
 }
 
 FilterHeadersStatus Filter::decodeHeaders(RequestHeaderMap& headers, bool) {
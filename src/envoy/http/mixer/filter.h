@@ -31,6 +31,9 @@ struct PerRouteServiceConfig : public Router::RouteSpecificFilterConfig {
 
   // Its config hash
   std::string hash;
+
+  // The same hash as an integer key, never 0.
+  uint64_t key;
 };
 
 class Filter : public StreamFilter,
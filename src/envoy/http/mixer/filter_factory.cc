@@ -54,7 +54,12 @@ class MixerConfigFactory : public NamedHttpFilterConfigFactory {
     // TODO: use downcastAndValidate once client_config.proto adds validate
     // rules.
     obj->config = dynamic_cast<const ServiceConfig&>(config);
-    obj->hash = std::to_string(MessageUtil::hash(obj->config));
+    obj->key = MessageUtil::hash(obj->config);
+    if (obj->key == 0) {
+      // 0 means no key.
+      obj->key = 1;
+    }
+    obj->hash = std::to_string(obj->key);
     return obj;
   }
 
@@ -57,7 +57,6 @@ class ReportData : public ::istio::control::http::ReportData,
   const ResponseHeaderMap *response_headers_;
   const ResponseTrailerMap *trailers_;
   const StreamInfo::StreamInfo &info_;
-  uint64_t response_total_size_;
   uint64_t request_total_size_;
 
  public:
@@ -69,15 +68,7 @@ class ReportData : public ::istio::control::http::ReportData,
         response_headers_(response_headers),
         trailers_(response_trailers),
         info_(info),
-        response_total_size_(info.bytesSent()),
-        request_total_size_(request_total_size) {
-    if (response_headers != nullptr) {
-      response_total_size_ += response_headers->byteSize();
-    }
-    if (response_trailers != nullptr) {
-      response_total_size_ += response_trailers->byteSize();
-    }
-  }
+        request_total_size_(request_total_size) {}
 
   std::map<std::string, std::string> GetResponseHeaders() const override {
     std::map<std::string, std::string> header_map;
@@ -91,6 +82,19 @@ class ReportData : public ::istio::control::http::ReportData,
     return header_map;
   }
 
+  void CopyResponseHeaders(
+      const ::istio::control::http::HeaderNameSet *names,
+      ::google::protobuf::Map<std::string, std::string> *headers)
+      const override {
+    if (response_headers_) {
+      Utils::CopyHeaders(*response_headers_, ResponseHeaderExclusives, names,
+                         headers);
+    }
+    if (trailers_) {
+      Utils::CopyHeaders(*trailers_, ResponseHeaderExclusives, names, headers);
+    }
+  }
+
   void GetTracingHeaders(
       std::map<std::string, std::string> &tracing_headers) const override {
     Utils::FindHeaders(*request_headers_, Utils::TracingHeaderSet,
@@ -101,7 +105,13 @@ class ReportData : public ::istio::control::http::ReportData,
       ::istio::control::http::ReportData::ReportInfo *data) const override {
     data->request_body_size = info_.bytesReceived();
     data->response_body_size = info_.bytesSent();
-    data->response_total_size = response_total_size_;
+    data->response_total_size = info_.bytesSent();
+    if (response_headers_ != nullptr) {
+      data->response_total_size += response_headers_->byteSize();
+    }
+    if (trailers_ != nullptr) {
+      data->response_total_size += trailers_->byteSize();
+    }
     data->request_total_size = request_total_size_;
     data->duration =
         info_.requestComplete().value_or(std::chrono::nanoseconds{0});
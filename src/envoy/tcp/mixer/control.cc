@@ -28,10 +28,11 @@ namespace Mixer {
 
 Control::Control(ControlDataSharedPtr control_data,
                  Upstream::ClusterManager& cm, Event::Dispatcher& dispatcher,
-                 Runtime::RandomGenerator& random, Stats::Scope& scope,
-                 const LocalInfo::LocalInfo& local_info)
+                 Runtime::RandomGenerator& random, Runtime::Loader& runtime,
+                 Stats::Scope& scope, const LocalInfo::LocalInfo& local_info)
     : control_data_(control_data),
       dispatcher_(dispatcher),
+      runtime_(runtime),
       check_client_factory_(Utils::GrpcClientFactoryForCluster(
           control_data_->config().check_cluster(), cm, scope,
           dispatcher.timeSource())),
@@ -43,7 +44,9 @@ Control::Control(ControlDataSharedPtr control_data,
                      .config_pb()
                      .transport()
                      .stats_update_interval(),
-                 [this](Statistics* stat) -> bool { return GetStats(stat); }) {
+                 [this](Statistics* stat) -> bool { return GetStats(stat); }),
+      report_timer_wheel_(dispatcher,
+                          control_data_->config().report_interval_ms()) {
   auto& logger = Logger::Registry::getLog(Logger::Id::config);
   LocalNode local_node;
   if (!Utils::ExtractNodeInfo(local_info.node(), &local_node)) {
@@ -60,10 +63,28 @@ Control::Control(ControlDataSharedPtr control_data,
   Utils::CreateEnvironment(dispatcher, random, *check_client_factory_,
                            *report_client_factory_,
                            serialized_forward_attributes_, &options.env);
+  options.env.report_aggregator = control_data_->report_aggregator();
+  options.env.quota_pool = control_data_->quota_pool();
 
   controller_ = ::istio::control::tcp::Controller::Create(options);
 }
 
+Control::Control(ControlDataSharedPtr control_data,
+                 std::unique_ptr<::istio::control::tcp::Controller> controller,
+                 Event::Dispatcher& dispatcher, Runtime::Loader& runtime)
+    : control_data_(control_data),
+      dispatcher_(dispatcher),
+      runtime_(runtime),
+      stats_obj_(dispatcher, control_data_->stats(),
+                 control_data_->config()
+                     .config_pb()
+                     .transport()
+                     .stats_update_interval(),
+                 [this](Statistics* stat) -> bool { return GetStats(stat); }),
+      controller_(std::move(controller)),
+      report_timer_wheel_(dispatcher,
+                          control_data_->config().report_interval_ms()) {}
+
 // Call controller to get statistics.
 bool Control::GetStats(Statistics* stat) {
   if (!controller_) {
@@ -24,6 +24,8 @@
 #include "include/istio/control/tcp/controller.h"
 #include "include/istio/utils/local_attributes.h"
 #include "src/envoy/tcp/mixer/config.h"
+#include "src/envoy/tcp/mixer/report_timer_wheel.h"
+#include "src/envoy/utils/mixer_control.h"
 #include "src/envoy/utils/stats.h"
 
 namespace Envoy {
@@ -33,18 +35,34 @@ namespace Mixer {
 class ControlData {
  public:
   ControlData(std::unique_ptr<Config> config, Utils::MixerFilterStats stats,
-              const std::string& uuid)
-      : config_(std::move(config)), stats_(stats), uuid_(uuid) {}
+              const std::string& uuid, Runtime::Loader& runtime)
+      : config_(std::move(config)),
+        stats_(stats),
+        uuid_(uuid),
+        report_aggregator_(Utils::GetReportAggregator(
+            config_->config_pb().transport(), runtime)),
+        quota_pool_(::istio::mixerclient::CreateQuotaPool()) {}
 
   const Config& config() { return *config_; }
   Utils::MixerFilterStats& stats() { return stats_; }
   const std::string& uuid() { return uuid_; }
+  const std::shared_ptr<::istio::mixerclient::ReportAggregator>&
+  report_aggregator() {
+    return report_aggregator_;
+  }
+  const std::shared_ptr<::istio::mixerclient::QuotaPool>& quota_pool() {
+    return quota_pool_;
+  }
 
  private:
   std::unique_ptr<Config> config_;
   Utils::MixerFilterStats stats_;
   // UUID of the Envoy TCP mixer filter.
   const std::string uuid_;
+  // Report aggregator shared by the per-thread controls.
+  std::shared_ptr<::istio::mixerclient::ReportAggregator> report_aggregator_;
+  // Quota pool shared by the per-thread controls.
+  std::shared_ptr<::istio::mixerclient::QuotaPool> quota_pool_;
 };
 
 typedef std::shared_ptr<ControlData> ControlDataSharedPtr;
@@ -54,16 +72,26 @@ class Control final : public ThreadLocal::ThreadLocalObject {
   // The constructor.
   Control(ControlDataSharedPtr control_data, Upstream::ClusterManager& cm,
           Event::Dispatcher& dispatcher, Runtime::RandomGenerator& random,
-          Stats::Scope& scope, const LocalInfo::LocalInfo& local_info);
+          Runtime::Loader& runtime, Stats::Scope& scope,
+          const LocalInfo::LocalInfo& local_info);
+
+  // For tests, uses "controller" instead of creating one with Mixer clients.
+  Control(ControlDataSharedPtr control_data,
+          std::unique_ptr<::istio::control::tcp::Controller> controller,
+          Event::Dispatcher& dispatcher, Runtime::Loader& runtime);
 
   ::istio::control::tcp::Controller* controller() { return controller_.get(); }
 
   Event::Dispatcher& dispatcher() { return dispatcher_; }
 
+  Runtime::Loader& runtime() { return runtime_; }
+
   const std::string& uuid() const { return control_data_->uuid(); }
 
   const Config& config() const { return control_data_->config(); }
 
+  ReportTimerWheel& report_timer_wheel() { return report_timer_wheel_; }
+
  private:
   // Call controller to get statistics.
   bool GetStats(::istio::mixerclient::Statistics* stat);
@@ -74,6 +102,9 @@ class Control final : public ThreadLocal::ThreadLocalObject {
   // dispatcher.
   Event::Dispatcher& dispatcher_;
 
+  // runtime.
+  Runtime::Loader& runtime_;
+
   // Pre-serialized attributes_for_mixer_proxy.
   std::string serialized_forward_attributes_;
 
@@ -86,6 +117,9 @@ class Control final : public ThreadLocal::ThreadLocalObject {
 
   // The mixer control
   std::unique_ptr<::istio::control::tcp::Controller> controller_;
+
+  // Timer wheel driving the periodical reports of the connections.
+  ReportTimerWheel report_timer_wheel_;
 };
 
 }  // namespace Mixer
@@ -34,18 +34,19 @@ class ControlFactory : public Logger::Loggable<Logger::Id::filter> {
                  Server::Configuration::FactoryContext& context)
       : control_data_(std::make_shared<ControlData>(
             std::move(config), generateStats(kTcpStatsPrefix, context.scope()),
-            context.random().uuid())),
+            context.random().uuid(), context.runtime())),
         tls_(context.threadLocal().allocateSlot()) {
     Runtime::RandomGenerator& random = context.random();
+    Runtime::Loader& runtime = context.runtime();
     Stats::Scope& scope = context.scope();
     const LocalInfo::LocalInfo& local_info = context.localInfo();
 
     tls_->set([control_data = this->control_data_,
-               &cm = context.clusterManager(), &random, &scope,
+               &cm = context.clusterManager(), &random, &runtime, &scope,
                &local_info](Event::Dispatcher& dispatcher)
                   -> ThreadLocal::ThreadLocalObjectSharedPtr {
-      return ThreadLocal::ThreadLocalObjectSharedPtr(
-          new Control(control_data, cm, dispatcher, random, scope, local_info));
+      return ThreadLocal::ThreadLocalObjectSharedPtr(new Control(
+          control_data, cm, dispatcher, random, runtime, scope, local_info));
     });
   }
 
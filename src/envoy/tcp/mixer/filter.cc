@@ -17,6 +17,7 @@
 
 #include "common/common/enum_to_int.h"
 #include "extensions/filters/network/well_known_names.h"
+#include "src/envoy/utils/connection_identity.h"
 #include "src/envoy/utils/utils.h"
 
 using ::google::protobuf::util::Status;
@@ -25,12 +26,21 @@ using ::istio::mixerclient::CheckResponseInfo;
 namespace Envoy {
 namespace Tcp {
 namespace Mixer {
+namespace {
+
+// Runtime key of the number of client bytes buffered while a Check is
+// pending.  If it is 0, the connection is not read until the Check is done.
+const std::string kOptimisticCheckBufferBytes(
+    "tcp_mixer_filter.optimistic_check_buffer_bytes");
+
+}  // namespace
 
 Filter::Filter(Control &control) : control_(control) {
   ENVOY_LOG(debug, "Called tcp filter: {}", __func__);
 }
 
 Filter::~Filter() {
+  control_.report_timer_wheel().Remove(*this);
   cancelCheck();
   ENVOY_LOG(debug, "Called tcp filter : {}", __func__);
 }
@@ -56,7 +66,9 @@ void Filter::cancelCheck() {
 // Makes a Check() call to Mixer.
 void Filter::callCheck() {
   state_ = State::Calling;
-  filter_callbacks_->connection().readDisable(true);
+  if (check_buffer_limit_ == 0) {
+    setReadDisabled(true);
+  }
   calling_check_ = true;
   handler_->Check(
       this, [this](const CheckResponseInfo &info) { completeCheck(info); });
@@ -88,8 +100,17 @@ void Filter::cacheFilterMetadata(
 
 void Filter::clearCachedFilterMetadata() { cached_filter_metadata_.clear(); }
 
+void Filter::setReadDisabled(bool disabled) {
+  if (read_disabled_ != disabled) {
+    read_disabled_ = disabled;
+    filter_callbacks_->connection().readDisable(disabled);
+  }
+}
+
 // Network::ReadFilter
 Network::FilterStatus Filter::onData(Buffer::Instance &data, bool) {
+  // The TLS transport only passes data on once the handshake completed.
+  handshake_complete_ = true;
   if (state_ == State::NotStarted) {
     // By waiting to invoke the callCheck() at onData(), the call to Mixer
     // will have sufficient SSL information to fill the check Request.
@@ -98,7 +119,20 @@ Network::FilterStatus Filter::onData(Buffer::Instance &data, bool) {
 
   ENVOY_CONN_LOG(debug, "Called tcp filter onRead bytes: {}",
                  filter_callbacks_->connection(), data.length());
-  received_bytes_ += data.length();
+  if (state_ == State::Calling) {
+    // While the Check is pending, the data is left in the read buffer and
+    // passed again with the bytes read since.  Only count the new bytes.
+    if (data.length() > pending_bytes_) {
+      received_bytes_ += data.length() - pending_bytes_;
+    }
+    pending_bytes_ = data.length();
+    // Stop reading once the buffered client data reaches the limit.
+    if (pending_bytes_ >= check_buffer_limit_) {
+      setReadDisabled(true);
+    }
+  } else {
+    received_bytes_ += data.length();
+  }
 
   // Envoy filters like the mongo_proxy filter clear previously set dynamic
   // metadata on each onData call. Since the Mixer filter sends metadata based
@@ -132,6 +166,8 @@ Network::FilterStatus Filter::onNewConnection() {
                  filter_callbacks_->connection().remoteAddress()->asString(),
                  filter_callbacks_->connection().localAddress()->asString());
 
+  check_buffer_limit_ = control_.runtime().snapshot().getInteger(
+      kOptimisticCheckBufferBytes, 0);
   handler_ = control_.controller()->CreateRequestHandler();
   handler_->BuildCheckAttributes(this);
   // Wait until onData() is invoked.
@@ -146,12 +182,16 @@ void Filter::completeCheck(const CheckResponseInfo &info) {
     return;
   }
   state_ = State::Completed;
+  // The buffered client data is passed on by continueReading() below, or
+  // dropped on deny; it is not seen again by onData().
+  pending_bytes_ = 0;
 
   Utils::CheckResponseInfoToStreamInfo(
       info, filter_callbacks_->connection().streamInfo());
 
-  filter_callbacks_->connection().readDisable(false);
+  setReadDisabled(false);
 
+  // On deny, the buffered client data is dropped with the connection.
   if (!status.ok()) {
     filter_callbacks_->connection().close(
         Network::ConnectionCloseType::NoFlush);
@@ -160,9 +200,7 @@ void Filter::completeCheck(const CheckResponseInfo &info) {
       filter_callbacks_->continueReading();
     }
     handler_->Report(this, ConnectionEvent::OPEN);
-    report_timer_ =
-        control_.dispatcher().createTimer([this]() { OnReportTimer(); });
-    report_timer_->enableTimer(control_.config().report_interval_ms());
+    control_.report_timer_wheel().Add(*this);
   }
 }
 
@@ -177,12 +215,15 @@ void Filter::onEvent(Network::ConnectionEvent event) {
                    filter_callbacks_->connection(), enumToInt(event));
   }
 
+  // Raised by the TLS transport when the handshake completes.
+  if (event == Network::ConnectionEvent::Connected) {
+    handshake_complete_ = true;
+  }
+
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
     if (state_ != State::Closed && handler_) {
-      if (report_timer_) {
-        report_timer_->disableTimer();
-      }
+      control_.report_timer_wheel().Remove(*this);
       handler_->Report(this, ConnectionEvent::CLOSE);
     }
     cancelCheck();
@@ -190,16 +231,21 @@ void Filter::onEvent(Network::ConnectionEvent event) {
 }
 
 bool Filter::GetSourceIpPort(std::string *str_ip, int *port) const {
-  return Utils::GetIpPort(filter_callbacks_->connection().remoteAddress()->ip(),
-                          str_ip, port);
+  return Utils::ConnectionIdentity::get(filter_callbacks_->connection(),
+                                       handshake_complete_)
+      ->remoteIpPort(str_ip, port);
 }
 
 bool Filter::GetPrincipal(bool peer, std::string *user) const {
-  return Utils::GetPrincipal(&filter_callbacks_->connection(), peer, user);
+  return Utils::ConnectionIdentity::get(filter_callbacks_->connection(),
+                                       handshake_complete_)
+      ->principal(peer, user);
 }
 
 bool Filter::IsMutualTLS() const {
-  return Utils::IsMutualTLS(&filter_callbacks_->connection());
+  return Utils::ConnectionIdentity::get(filter_callbacks_->connection(),
+                                       handshake_complete_)
+      ->mutualTls();
 }
 
 bool Filter::GetRequestedServerName(std::string *name) const {
@@ -251,7 +297,6 @@ std::string Filter::GetConnectionId() const {
 void Filter::OnReportTimer() {
   handler_->Report(this, ConnectionEvent::CONTINUE);
   clearCachedFilterMetadata();
-  report_timer_->enableTimer(control_.config().report_interval_ms());
 }
 
 }  // namespace Mixer
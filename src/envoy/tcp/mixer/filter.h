@@ -30,6 +30,7 @@ class Filter : public Network::Filter,
                public Network::ConnectionCallbacks,
                public ::istio::control::tcp::CheckData,
                public ::istio::control::tcp::ReportData,
+               public ReportTimerWheel::Entry,
                public Logger::Loggable<Logger::Id::filter> {
  public:
   Filter(Control &control);
@@ -71,11 +72,11 @@ class Filter : public Network::Filter,
           &filter_metadata);
   void clearCachedFilterMetadata();
 
+  // ReportTimerWheel::Entry, sends a periodical delta report.
+  void OnReportTimer() override;
+
  private:
   enum class State { NotStarted, Calling, Completed, Closed };
-  // This function is invoked when timer event fires.
-  // It sends periodical delta reports.
-  void OnReportTimer();
 
   // Makes a Check() call to Mixer.
   void callCheck();
@@ -86,6 +87,9 @@ class Filter : public Network::Filter,
   // Cancel the pending Check call.
   void cancelCheck();
 
+  // Disables or enables reading from the connection.
+  void setReadDisabled(bool disabled);
+
   // the control object.
   Control &control_;
   // pre-request handler
@@ -96,6 +100,14 @@ class Filter : public Network::Filter,
   State state_{State::NotStarted};
   // calling_check
   bool calling_check_{};
+  // whether reading is disabled by this filter
+  bool read_disabled_{};
+  // whether the TLS handshake, if any, is known to be complete
+  bool handshake_complete_{};
+  // max client bytes buffered while the Check is pending, 0 for none
+  uint64_t check_buffer_limit_{};
+  // client bytes buffered while the Check is pending
+  uint64_t pending_bytes_{};
   // received bytes
   uint64_t received_bytes_{};
   // send bytes
@@ -103,9 +115,6 @@ class Filter : public Network::Filter,
   // cached filter metadata
   ::google::protobuf::Map<std::string, ::google::protobuf::Struct>
       cached_filter_metadata_{};
-
-  // Timer that periodically sends reports.
-  Event::TimerPtr report_timer_;
   // start_time
   std::chrono::time_point<std::chrono::system_clock> start_time_;
 };
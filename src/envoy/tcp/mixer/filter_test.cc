@@ -0,0 +1,220 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/tcp/mixer/filter.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/network/utility.h"
+#include "common/stats/isolated_store_impl.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+
+using ::google::protobuf::util::Status;
+using ::google::protobuf::util::error::Code;
+using ::istio::control::tcp::CheckData;
+using ::istio::control::tcp::Controller;
+using ::istio::control::tcp::ReportData;
+using ::istio::control::tcp::RequestHandler;
+using ::istio::mixer::v1::RouteDirective;
+using ::istio::mixer::v1::config::client::TcpClientConfig;
+using ::istio::mixerclient::CheckDoneFunc;
+using ::istio::mixerclient::CheckResponseInfo;
+using ::istio::mixerclient::Statistics;
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SaveArg;
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+namespace {
+
+class MockRequestHandler : public RequestHandler {
+ public:
+  MOCK_METHOD1(BuildCheckAttributes, void(CheckData* check_data));
+  MOCK_METHOD2(Check,
+               void(CheckData* check_data, const CheckDoneFunc& on_done));
+  MOCK_METHOD0(ResetCancel, void());
+  MOCK_METHOD0(CancelCheck, void());
+  MOCK_METHOD2(Report, void(ReportData* report_data,
+                            ReportData::ConnectionEvent event));
+};
+
+// Hands out a single request handler.
+class TestController : public Controller {
+ public:
+  TestController(RequestHandler* handler) : handler_(handler) {}
+
+  std::unique_ptr<RequestHandler> CreateRequestHandler() override {
+    return std::move(handler_);
+  }
+
+  void GetStatistics(Statistics*) const override {}
+
+ private:
+  std::unique_ptr<RequestHandler> handler_;
+};
+
+class CheckResult : public CheckResponseInfo {
+ public:
+  CheckResult(const Status& status) : status_(status) {}
+
+  const Status& status() const override { return status_; }
+
+  const RouteDirective& routeDirective() const override {
+    return route_directive_;
+  }
+
+ private:
+  const Status status_;
+  const RouteDirective route_directive_;
+};
+
+class FilterTest : public ::testing::Test {
+ public:
+  // Creates a filter for a new connection, "check_buffer_limit" is the
+  // runtime value of the client bytes read while the Check is pending.
+  void Initialize(uint64_t check_buffer_limit) {
+    ON_CALL(runtime_.snapshot_,
+            getInteger("tcp_mixer_filter.optimistic_check_buffer_bytes", _))
+        .WillByDefault(Return(check_buffer_limit));
+
+    // The timers of the stats object and of the report timer wheel.
+    new NiceMock<Event::MockTimer>(&dispatcher_);
+    new NiceMock<Event::MockTimer>(&dispatcher_);
+    auto control_data = std::make_shared<ControlData>(
+        std::make_unique<Config>(TcpClientConfig()),
+        Utils::MixerFilterStats{ALL_MIXER_FILTER_STATS(
+            POOL_COUNTER_PREFIX(stats_, "tcp_mixer_filter."))},
+        "uuid", runtime_);
+    handler_ = new NiceMock<MockRequestHandler>();
+    ON_CALL(*handler_, Check(_, _)).WillByDefault(SaveArg<1>(&on_check_done_));
+    control_ = std::make_unique<Control>(
+        control_data, std::make_unique<TestController>(handler_), dispatcher_,
+        runtime_);
+
+    callbacks_.connection_.remote_address_ =
+        Network::Utility::resolveUrl("tcp://10.0.0.3:50000");
+    callbacks_.connection_.local_address_ =
+        Network::Utility::resolveUrl("tcp://10.0.0.1:443");
+    filter_ = std::make_unique<Filter>(*control_);
+    filter_->initializeReadFilterCallbacks(callbacks_);
+    EXPECT_EQ(filter_->onNewConnection(), Network::FilterStatus::Continue);
+  }
+
+  uint64_t ReceivedBytes() const {
+    ReportData::ReportInfo info;
+    filter_->GetReportInfo(&info);
+    return info.received_bytes;
+  }
+
+  Stats::IsolatedStoreImpl stats_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Network::MockReadFilterCallbacks> callbacks_;
+  std::unique_ptr<Control> control_;
+  // Owned by the filter.
+  NiceMock<MockRequestHandler>* handler_{};
+  CheckDoneFunc on_check_done_;
+  std::unique_ptr<Filter> filter_;
+};
+
+TEST_F(FilterTest, TestDefaultReadDisabled) {
+  Initialize(0);
+
+  // The connection is not read until the Check is done.
+  EXPECT_CALL(callbacks_.connection_, readDisable(true));
+  EXPECT_CALL(*handler_, Check(_, _));
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(filter_->onData(data, false), Network::FilterStatus::StopIteration);
+  EXPECT_EQ(ReceivedBytes(), 5);
+
+  EXPECT_CALL(callbacks_.connection_, readDisable(false));
+  EXPECT_CALL(callbacks_, continueReading());
+  EXPECT_CALL(*handler_, Report(_, ReportData::OPEN));
+  on_check_done_(CheckResult(Status::OK));
+
+  // The buffered data is passed on by continueReading().
+  data.drain(data.length());
+  data.add("world!");
+  EXPECT_EQ(filter_->onData(data, false), Network::FilterStatus::Continue);
+  EXPECT_EQ(ReceivedBytes(), 11);
+}
+
+TEST_F(FilterTest, TestBufferLimit) {
+  Initialize(8);
+
+  // The connection is read until the buffered data reaches the limit.
+  EXPECT_CALL(callbacks_.connection_, readDisable(true)).Times(0);
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(filter_->onData(data, false), Network::FilterStatus::StopIteration);
+  EXPECT_EQ(ReceivedBytes(), 5);
+
+  EXPECT_CALL(callbacks_.connection_, readDisable(true));
+  data.add("world");
+  EXPECT_EQ(filter_->onData(data, false), Network::FilterStatus::StopIteration);
+  // The bytes seen again are only counted once.
+  EXPECT_EQ(ReceivedBytes(), 10);
+
+  EXPECT_CALL(callbacks_.connection_, readDisable(false));
+  EXPECT_CALL(callbacks_, continueReading());
+  on_check_done_(CheckResult(Status::OK));
+}
+
+TEST_F(FilterTest, TestReleaseOnAllow) {
+  Initialize(100);
+
+  EXPECT_CALL(callbacks_.connection_, readDisable(_)).Times(0);
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(filter_->onData(data, false), Network::FilterStatus::StopIteration);
+  data.add(" world");
+  EXPECT_EQ(filter_->onData(data, false), Network::FilterStatus::StopIteration);
+  EXPECT_EQ(ReceivedBytes(), 11);
+
+  // All the buffered data is released to upstream at once.
+  EXPECT_CALL(callbacks_, continueReading());
+  EXPECT_CALL(*handler_, Report(_, ReportData::OPEN));
+  on_check_done_(CheckResult(Status::OK));
+
+  // The next data is counted in full, after upstream drained the buffer.
+  data.drain(data.length());
+  data.add("!");
+  EXPECT_EQ(filter_->onData(data, false), Network::FilterStatus::Continue);
+  EXPECT_EQ(ReceivedBytes(), 12);
+}
+
+TEST_F(FilterTest, TestCloseOnDeny) {
+  Initialize(100);
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(filter_->onData(data, false), Network::FilterStatus::StopIteration);
+
+  // The buffered data is dropped with the connection.
+  EXPECT_CALL(callbacks_.connection_,
+              close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(callbacks_, continueReading()).Times(0);
+  EXPECT_CALL(*handler_, Report(_, ReportData::OPEN)).Times(0);
+  on_check_done_(CheckResult(Status(Code::PERMISSION_DENIED, "denied")));
+  EXPECT_EQ(ReceivedBytes(), 5);
+}
+
+}  // namespace
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
@@ -0,0 +1,80 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/tcp/mixer/report_timer_wheel.h"
+
+#include <algorithm>
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+namespace {
+
+// The number of slots a report interval is split into.
+const int kNumSlots = 16;
+
+}  // namespace
+
+ReportTimerWheel::ReportTimerWheel(Event::Dispatcher& dispatcher,
+                                   std::chrono::milliseconds interval)
+    : timer_(dispatcher.createTimer([this]() { OnTick(); })),
+      tick_(std::max(interval / kNumSlots, std::chrono::milliseconds(1))),
+      slots_(kNumSlots) {}
+
+void ReportTimerWheel::Add(Entry& entry) {
+  auto& slot = slots_[cursor_];
+  entry.it_ = slot.insert(slot.end(), &entry);
+  entry.list_ = &slot;
+  if (size_++ == 0) {
+    timer_->enableTimer(tick_);
+  }
+}
+
+void ReportTimerWheel::Remove(Entry& entry) {
+  if (entry.list_ == nullptr) {
+    return;
+  }
+  entry.list_->erase(entry.it_);
+  entry.list_ = nullptr;
+  if (--size_ == 0) {
+    timer_->disableTimer();
+  }
+}
+
+void ReportTimerWheel::OnTick() {
+  cursor_ = (cursor_ + 1) % slots_.size();
+  auto& slot = slots_[cursor_];
+  for (Entry* entry : slot) {
+    entry->list_ = &due_;
+  }
+  due_.splice(due_.end(), slot);
+
+  // Each entry is moved back before its callback, so the callback may
+  // remove any entry, itself included.
+  while (!due_.empty()) {
+    Entry* entry = due_.front();
+    slot.splice(slot.end(), due_, due_.begin());
+    entry->list_ = &slot;
+    entry->OnReportTimer();
+  }
+
+  if (size_ > 0) {
+    timer_->enableTimer(tick_);
+  }
+}
+
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
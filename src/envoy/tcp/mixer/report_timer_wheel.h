@@ -0,0 +1,82 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+
+// Drives the periodical reports of all the connections of a worker with a
+// single dispatcher timer.  The report interval is split into a fixed number
+// of slots; a connection is placed in the slot of the current tick and is
+// reported every time the wheel comes back to that slot.  All connections
+// due in the same slot are reported in one pass.  The first report of a
+// connection may be up to one slot earlier than the report interval.
+class ReportTimerWheel {
+ public:
+  // A connection registered with the wheel.
+  class Entry {
+   public:
+    virtual ~Entry() {}
+
+    // Called when the report interval of the entry elapses.
+    virtual void OnReportTimer() = 0;
+
+   private:
+    friend class ReportTimerWheel;
+    std::list<Entry*>* list_{};
+    std::list<Entry*>::iterator it_;
+  };
+
+  ReportTimerWheel(Event::Dispatcher& dispatcher,
+                   std::chrono::milliseconds interval);
+
+  // Registers an entry which is not registered yet.
+  void Add(Entry& entry);
+
+  // Unregisters an entry, a no-op if it is not registered.
+  void Remove(Entry& entry);
+
+  // The number of registered entries.
+  size_t size() const { return size_; }
+
+ private:
+  // Reports the entries of the next slot.
+  void OnTick();
+
+  // The timer, only enabled while some entries are registered.
+  Event::TimerPtr timer_;
+  // The time between two ticks.
+  const std::chrono::milliseconds tick_;
+  // The slots, one per tick of the report interval.
+  std::vector<std::list<Entry*>> slots_;
+  // The entries of the slot being reported.
+  std::list<Entry*> due_;
+  // The slot of the last tick.
+  size_t cursor_{};
+  size_t size_{};
+};
+
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
@@ -0,0 +1,126 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/tcp/mixer/report_timer_wheel.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "test/mocks/event/mocks.h"
+
+using ::testing::_;
+using ::testing::NiceMock;
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+namespace {
+
+const std::chrono::milliseconds kInterval(1600);
+const std::chrono::milliseconds kTick(100);
+
+class CountingEntry : public ReportTimerWheel::Entry {
+ public:
+  void OnReportTimer() override {
+    ++reports_;
+    if (on_report_) {
+      on_report_();
+    }
+  }
+
+  int reports_{};
+  std::function<void()> on_report_;
+};
+
+class ReportTimerWheelTest : public ::testing::Test {
+ public:
+  ReportTimerWheelTest()
+      : timer_(new NiceMock<Event::MockTimer>(&dispatcher_)),
+        wheel_(dispatcher_, kInterval) {}
+
+  // Fires the given number of ticks.
+  void Tick(int ticks) {
+    for (int i = 0; i < ticks; ++i) {
+      timer_->callback_();
+    }
+  }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Event::MockTimer>* timer_;
+  ReportTimerWheel wheel_;
+};
+
+TEST_F(ReportTimerWheelTest, TestTimerOnlyEnabledWithEntries) {
+  CountingEntry entry1;
+  CountingEntry entry2;
+  EXPECT_CALL(*timer_, enableTimer(kTick, _)).Times(1);
+  wheel_.Add(entry1);
+  wheel_.Add(entry2);
+  EXPECT_EQ(wheel_.size(), 2);
+
+  EXPECT_CALL(*timer_, disableTimer()).Times(1);
+  wheel_.Remove(entry1);
+  wheel_.Remove(entry2);
+  wheel_.Remove(entry2);
+  EXPECT_EQ(wheel_.size(), 0);
+}
+
+TEST_F(ReportTimerWheelTest, TestReportEveryInterval) {
+  CountingEntry entry1;
+  CountingEntry entry2;
+  wheel_.Add(entry1);
+  Tick(5);
+  wheel_.Add(entry2);
+
+  Tick(10);
+  EXPECT_EQ(entry1.reports_, 0);
+  Tick(1);
+  EXPECT_EQ(entry1.reports_, 1);
+  EXPECT_EQ(entry2.reports_, 0);
+  Tick(5);
+  EXPECT_EQ(entry2.reports_, 1);
+
+  Tick(32);
+  EXPECT_EQ(entry1.reports_, 3);
+  EXPECT_EQ(entry2.reports_, 3);
+}
+
+TEST_F(ReportTimerWheelTest, TestRemoveWhileReporting) {
+  CountingEntry entry1;
+  CountingEntry entry2;
+  CountingEntry entry3;
+  wheel_.Add(entry1);
+  wheel_.Add(entry2);
+  wheel_.Add(entry3);
+  // The first entry removes itself and the not yet reported third entry.
+  entry1.on_report_ = [&]() {
+    wheel_.Remove(entry1);
+    wheel_.Remove(entry3);
+  };
+
+  Tick(16);
+  EXPECT_EQ(entry1.reports_, 1);
+  EXPECT_EQ(entry2.reports_, 1);
+  EXPECT_EQ(entry3.reports_, 0);
+  EXPECT_EQ(wheel_.size(), 1);
+
+  Tick(16);
+  EXPECT_EQ(entry1.reports_, 1);
+  EXPECT_EQ(entry2.reports_, 2);
+}
+
+}  // namespace
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
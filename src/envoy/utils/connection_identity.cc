@@ -0,0 +1,102 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/utils/connection_identity.h"
+
+#include "common/common/macros.h"
+#include "src/envoy/utils/utils.h"
+
+namespace Envoy {
+namespace Utils {
+namespace {
+
+// The filter state object holding the identity of a connection.
+struct StoredIdentity : public StreamInfo::FilterState::Object {
+  explicit StoredIdentity(std::shared_ptr<const ConnectionIdentity> identity)
+      : identity(std::move(identity)) {}
+
+  const std::shared_ptr<const ConnectionIdentity> identity;
+};
+
+}  // namespace
+
+
+ConnectionIdentity::ConnectionIdentity(const Network::Connection& connection)
+    : mutual_tls_(IsMutualTLS(&connection)), remote_port_(0) {
+  for (bool peer : {false, true}) {
+    Identity& identity = identities_[peer];
+    identity.has_principal =
+        GetPrincipal(&connection, peer, &identity.principal);
+    identity.has_trust_domain =
+        GetTrustDomain(&connection, peer, &identity.trust_domain);
+  }
+  has_remote_ip_ = connection.remoteAddress() != nullptr &&
+                   GetIpPort(connection.remoteAddress()->ip(), &remote_ip_,
+                             &remote_port_);
+}
+
+const std::string& ConnectionIdentity::key() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "istio.connection_identity");
+}
+
+std::shared_ptr<const ConnectionIdentity> ConnectionIdentity::get(
+    const Network::Connection& connection, bool handshake_complete) {
+  if (connection.ssl() != nullptr && !handshake_complete) {
+    return std::make_shared<const ConnectionIdentity>(connection);
+  }
+
+  // The identity is derived state of the connection, cache it like a
+  // mutable member.
+  auto& filter_state = const_cast<Network::Connection&>(connection)
+                           .streamInfo()
+                           .filterState();
+  if (!filter_state->hasData<StoredIdentity>(key())) {
+    filter_state->setData(
+        key(),
+        std::make_unique<StoredIdentity>(
+            std::make_shared<const ConnectionIdentity>(connection)),
+        StreamInfo::FilterState::StateType::ReadOnly,
+        StreamInfo::FilterState::LifeSpan::DownstreamConnection);
+  }
+  return filter_state->getDataReadOnly<StoredIdentity>(key()).identity;
+}
+
+bool ConnectionIdentity::principal(bool peer, std::string* principal) const {
+  const Identity& identity = identities_[peer];
+  if (identity.has_principal) {
+    *principal = identity.principal;
+  }
+  return identity.has_principal;
+}
+
+bool ConnectionIdentity::trustDomain(bool peer,
+                                     std::string* trust_domain) const {
+  const Identity& identity = identities_[peer];
+  if (identity.has_trust_domain) {
+    *trust_domain = identity.trust_domain;
+  }
+  return identity.has_trust_domain;
+}
+
+bool ConnectionIdentity::remoteIpPort(std::string* ip, int* port) const {
+  if (has_remote_ip_) {
+    *ip = remote_ip_;
+    *port = remote_port_;
+  }
+  return has_remote_ip_;
+}
+
+}  // namespace Utils
+}  // namespace Envoy
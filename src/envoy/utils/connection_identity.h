@@ -0,0 +1,76 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/network/connection.h"
+#include "envoy/stream_info/filter_state.h"
+
+namespace Envoy {
+namespace Utils {
+
+// The identity of a downstream connection: the local and peer principals
+// and trust domains from the TLS certificates, and the remote address.  It
+// is derived once per connection and stored in the connection's filter
+// state, so the requests of a long lived connection don't walk the
+// certificate SANs again.
+class ConnectionIdentity {
+ public:
+  explicit ConnectionIdentity(const Network::Connection& connection);
+
+  // The filter state key.
+  static const std::string& key();
+
+  // Return the identity of "connection".  The certificates are not known
+  // before the TLS handshake completes, so the identity is only stored once
+  // the connection has no TLS or "handshake_complete" is set, e.g. by
+  // callers running on decrypted data.  Until then it is derived on every
+  // call.
+  static std::shared_ptr<const ConnectionIdentity> get(
+      const Network::Connection& connection, bool handshake_complete);
+
+  // Get peer or local principal URI, without the "spiffe://" prefix.
+  bool principal(bool peer, std::string* principal) const;
+
+  // Get peer or local trust domain.
+  bool trustDomain(bool peer, std::string* trust_domain) const;
+
+  // Returns true if connection is mutual TLS enabled.
+  bool mutualTls() const { return mutual_tls_; }
+
+  // Get the remote ip and port, in the format of Utils::GetIpPort.
+  bool remoteIpPort(std::string* ip, int* port) const;
+
+ private:
+  struct Identity {
+    bool has_principal{};
+    std::string principal;
+    bool has_trust_domain{};
+    std::string trust_domain;
+  };
+
+  // The local and the peer identity, indexed by "peer".
+  Identity identities_[2];
+  bool mutual_tls_;
+  bool has_remote_ip_;
+  std::string remote_ip_;
+  int remote_port_;
+};
+
+}  // namespace Utils
+}  // namespace Envoy
@@ -0,0 +1,121 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/utils/connection_identity.h"
+
+#include "gmock/gmock.h"
+#include "src/envoy/utils/utils.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/test_common/utility.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Utils {
+namespace {
+
+class ConnectionIdentityTest : public testing::Test {
+ protected:
+  void setMockSans(const std::vector<std::string>& peer_sans,
+                   const std::vector<std::string>& local_sans) {
+    ssl_ = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+    ON_CALL(*ssl_, peerCertificatePresented()).WillByDefault(Return(true));
+    ON_CALL(*ssl_, uriSanPeerCertificate()).WillByDefault(Return(peer_sans));
+    ON_CALL(*ssl_, uriSanLocalCertificate())
+        .WillByDefault(Return(local_sans));
+    EXPECT_CALL(Const(connection_), ssl()).WillRepeatedly(Return(ssl_));
+  }
+
+  NiceMock<Network::MockConnection> connection_;
+  std::shared_ptr<NiceMock<Ssl::MockConnectionInfo>> ssl_;
+};
+
+TEST_F(ConnectionIdentityTest, PlaintextConnection) {
+  const auto identity = ConnectionIdentity::get(connection_, false);
+  std::string value;
+  EXPECT_FALSE(identity->mutualTls());
+  EXPECT_FALSE(identity->principal(true, &value));
+  EXPECT_FALSE(identity->principal(false, &value));
+  EXPECT_FALSE(identity->trustDomain(true, &value));
+  EXPECT_EQ(value, "");
+}
+
+TEST_F(ConnectionIdentityTest, SpiffeCerts) {
+  setMockSans({"spiffe://td-1/foo"}, {"spiffe://td-2/bar"});
+  const auto identity = ConnectionIdentity::get(connection_, true);
+  std::string value;
+  EXPECT_TRUE(identity->mutualTls());
+  EXPECT_TRUE(identity->principal(true, &value));
+  EXPECT_EQ(value, "td-1/foo");
+  EXPECT_TRUE(identity->principal(false, &value));
+  EXPECT_EQ(value, "td-2/bar");
+  EXPECT_TRUE(identity->trustDomain(true, &value));
+  EXPECT_EQ(value, "td-1");
+  EXPECT_TRUE(identity->trustDomain(false, &value));
+  EXPECT_EQ(value, "td-2");
+}
+
+TEST_F(ConnectionIdentityTest, DerivedOnce) {
+  setMockSans({"spiffe://td/foo"}, {});
+  EXPECT_CALL(*ssl_, uriSanPeerCertificate())
+      .Times(2)
+      .WillRepeatedly(Return(std::vector<std::string>{"spiffe://td/foo"}));
+  const auto identity = ConnectionIdentity::get(connection_, true);
+  // Later lookups are served from the connection filter state.
+  EXPECT_EQ(ConnectionIdentity::get(connection_, true), identity);
+  EXPECT_EQ(ConnectionIdentity::get(connection_, false), identity);
+  std::string principal;
+  EXPECT_TRUE(
+      ConnectionIdentity::get(connection_, true)->principal(true, &principal));
+  EXPECT_EQ(principal, "td/foo");
+}
+
+TEST_F(ConnectionIdentityTest, NotStoredBeforeHandshake) {
+  // No peer certificate is known while the handshake is in progress.
+  setMockSans({}, {});
+  ON_CALL(*ssl_, peerCertificatePresented()).WillByDefault(Return(false));
+  auto identity = ConnectionIdentity::get(connection_, false);
+  std::string principal;
+  EXPECT_FALSE(identity->mutualTls());
+  EXPECT_FALSE(identity->principal(true, &principal));
+
+  // The handshake completed, the identity derived before is not used.
+  ON_CALL(*ssl_, peerCertificatePresented()).WillByDefault(Return(true));
+  ON_CALL(*ssl_, uriSanPeerCertificate())
+      .WillByDefault(Return(std::vector<std::string>{"spiffe://td/foo"}));
+  identity = ConnectionIdentity::get(connection_, true);
+  EXPECT_TRUE(identity->mutualTls());
+  EXPECT_TRUE(identity->principal(true, &principal));
+  EXPECT_EQ(principal, "td/foo");
+  EXPECT_EQ(ConnectionIdentity::get(connection_, false), identity);
+}
+
+TEST_F(ConnectionIdentityTest, RemoteAddress) {
+  const auto identity = ConnectionIdentity::get(connection_, false);
+  std::string ip;
+  int port = 0;
+  std::string want_ip;
+  int want_port = 0;
+  EXPECT_EQ(identity->remoteIpPort(&ip, &port),
+            GetIpPort(connection_.remoteAddress()->ip(), &want_ip, &want_port));
+  EXPECT_EQ(ip, want_ip);
+  EXPECT_EQ(port, want_port);
+}
+
+}  // namespace
+}  // namespace Utils
+}  // namespace Envoy
@@ -46,6 +46,11 @@ class HeaderUpdate : public ::istio::control::http::HeaderUpdate,
     headers_->setReferenceKey(kIstioAttributeHeader, base64);
   }
 
+  void AddEncodedIstioAttributes(const std::string& encoded) override {
+    ENVOY_LOG(debug, "Mixer forward attributes set: {}", encoded);
+    headers_->setReferenceKey(kIstioAttributeHeader, encoded);
+  }
+
   static const Http::LowerCaseString& IstioAttributeHeader() {
     return kIstioAttributeHeader;
   }
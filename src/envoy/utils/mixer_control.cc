@@ -15,7 +15,13 @@
 
 #include "src/envoy/utils/mixer_control.h"
 
+#include <mutex>
+#include <unordered_map>
+
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "src/envoy/utils/grpc_transport.h"
+#include "src/istio/control/client_context_base.h"
 
 using ::istio::mixerclient::Statistics;
 using ::istio::utils::AttributeName;
@@ -30,6 +36,19 @@ const char kNodeNamespace[] = "NODE_NAMESPACE";
 
 namespace {
 
+// Runtime key to delta encode the aggregated report batches, the Mixer
+// server has to support it.
+const std::string kReportDeltaEncoding("mixer_filter.report_delta_encoding");
+
+// Runtime key of the serialized size targeted by adaptive report batching,
+// 0 keeps the fixed batch size and time of the transport config.
+const std::string kReportBatchMaxBytes("mixer_filter.report_batch_max_bytes");
+
+// Node metadata key of the comma separated request and response headers
+// always reported by the HTTP filter.  If set, the other reported request
+// headers are limited to the ones referenced by Mixer policies.
+const char kReportHeaders[] = "MIXER_REPORT_HEADERS";
+
 // A class to wrap envoy timer for mixer client timer.
 class EnvoyTimer : public ::istio::mixerclient::Timer {
  public:
@@ -100,6 +119,59 @@ void CreateEnvironment(Event::Dispatcher &dispatcher,
   env->uuid_generate_func = [&random]() -> std::string {
     return random.uuid();
   };
+
+  env->post_func = [&dispatcher](std::function<void()> fn) {
+    dispatcher.post(fn);
+  };
+}
+
+std::shared_ptr<::istio::mixerclient::ReportAggregator> GetReportAggregator(
+    const ::istio::mixer::v1::config::client::TransportConfig &transport,
+    Runtime::Loader &runtime) {
+  if (transport.disable_report_batch()) {
+    return nullptr;
+  }
+
+  const auto report_options = ::istio::control::GetReportOptions(transport);
+  ::istio::mixerclient::ReportAggregatorOptions options(
+      report_options.max_batch_entries, report_options.max_batch_time_ms);
+  options.delta_encoding =
+      runtime.snapshot().getInteger(kReportDeltaEncoding, 0) != 0;
+  options.max_batch_bytes = static_cast<int>(
+      runtime.snapshot().getInteger(kReportBatchMaxBytes, 0));
+
+  // The transport config has maps, only a deterministic serialization is
+  // usable as a key.
+  std::string key;
+  {
+    google::protobuf::io::StringOutputStream stream(&key);
+    google::protobuf::io::CodedOutputStream coded(&stream);
+    coded.SetSerializationDeterministic(true);
+    transport.SerializeToCodedStream(&coded);
+  }
+  key += "|" + std::to_string(options.delta_encoding) + "|" +
+         std::to_string(options.max_batch_bytes);
+
+  // Only weak references are held, an aggregator and its thread live as long
+  // as a filter config uses it.
+  static std::mutex mutex;
+  static std::unordered_map<
+      std::string, std::weak_ptr<::istio::mixerclient::ReportAggregator>>
+      aggregators;
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto it = aggregators.begin(); it != aggregators.end();) {
+    if (it->second.expired()) {
+      it = aggregators.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  auto aggregator = aggregators[key].lock();
+  if (!aggregator) {
+    aggregator = ::istio::mixerclient::CreateReportAggregator(options);
+    aggregators[key] = aggregator;
+  }
+  return aggregator;
 }
 
 void SerializeForwardedAttributes(
@@ -200,5 +272,20 @@ bool ExtractNodeInfo(const envoy::config::core::v3::Node &node,
   return false;
 }
 
+bool ExtractReportHeaders(const envoy::config::core::v3::Node &node,
+                          std::vector<std::string> *headers) {
+  std::string value;
+  if (!ReadProtoMap(node.metadata().fields(), kReportHeaders, &value)) {
+    return false;
+  }
+  for (const auto &name : StringUtil::splitToken(value, ",")) {
+    const auto trimmed = StringUtil::trim(name);
+    if (!trimmed.empty()) {
+      headers->emplace_back(trimmed.begin(), trimmed.end());
+    }
+  }
+  return true;
+}
+
 }  // namespace Utils
 }  // namespace Envoy
@@ -35,6 +35,14 @@ void CreateEnvironment(Event::Dispatcher &dispatcher,
                        const std::string &serialized_forward_attributes,
                        ::istio::mixerclient::Environment *env);
 
+// Get the process wide report aggregator for the transport config, or nullptr
+// if report batching is disabled. The HTTP and TCP filter configs with the
+// same transport share one aggregator and its thread. The runtime is only read
+// here, changes apply to the aggregators of the next config update.
+std::shared_ptr<::istio::mixerclient::ReportAggregator> GetReportAggregator(
+    const ::istio::mixer::v1::config::client::TransportConfig &transport,
+    Runtime::Loader &runtime);
+
 void SerializeForwardedAttributes(
     const ::istio::mixer::v1::config::client::TransportConfig &transport,
     std::string *serialized_forward_attributes);
@@ -46,5 +54,10 @@ Grpc::AsyncClientFactoryPtr GrpcClientFactoryForCluster(
 bool ExtractNodeInfo(const envoy::config::core::v3::Node &node,
                      ::istio::utils::LocalNode *args);
 
+// Read the headers always reported by the HTTP filter from the node
+// metadata.  Return false if report header projection is not configured.
+bool ExtractReportHeaders(const envoy::config::core::v3::Node &node,
+                          std::vector<std::string> *headers);
+
 }  // namespace Utils
 }  // namespace Envoy
@@ -18,14 +18,19 @@
 #include "fmt/printf.h"
 #include "mixer/v1/config/client/client_config.pb.h"
 #include "src/envoy/utils/utils.h"
+#include "test/mocks/runtime/mocks.h"
 #include "test/test_common/utility.h"
 
 using Envoy::Utils::ExtractNodeInfo;
+using Envoy::Utils::ExtractReportHeaders;
+using Envoy::Utils::GetReportAggregator;
 using Envoy::Utils::ParseJsonMessage;
 using ::istio::utils::AttributeName;
 using ::istio::utils::CreateLocalAttributes;
 using ::istio::utils::LocalAttributes;
+using ::istio::mixer::v1::config::client::TransportConfig;
 using ::istio::utils::LocalNode;
+using ::testing::NiceMock;
 
 namespace {
 
@@ -127,4 +132,43 @@ TEST(MixerControlTest, NoMetadata) {
   ASSERT_LOCAL_NODE(lexp, largs);
 }
 
+TEST(MixerControlTest, ReportHeaders) {
+  envoy::config::core::v3::Node node;
+  auto status = ParseJsonMessage(genNodeConfig(kNodeID, "", ""), &node);
+  EXPECT_OK(status) << status;
+
+  std::vector<std::string> headers;
+  EXPECT_FALSE(ExtractReportHeaders(node, &headers));
+  EXPECT_TRUE(headers.empty());
+
+  envoy::config::core::v3::Node report_node;
+  status = ParseJsonMessage(R"({
+    "metadata": {
+      "MIXER_REPORT_HEADERS": "x-request-id, user-agent,,"
+    }
+  })",
+                            &report_node);
+  EXPECT_OK(status) << status;
+
+  EXPECT_TRUE(ExtractReportHeaders(report_node, &headers));
+  EXPECT_EQ(headers, std::vector<std::string>({"x-request-id", "user-agent"}));
+}
+
+TEST(MixerControlTest, SharedReportAggregator) {
+  NiceMock<Envoy::Runtime::MockLoader> runtime;
+  TransportConfig transport;
+  transport.set_report_cluster("mixer_report_server");
+
+  auto aggregator = GetReportAggregator(transport, runtime);
+  ASSERT_NE(aggregator, nullptr);
+  EXPECT_EQ(GetReportAggregator(transport, runtime), aggregator);
+
+  TransportConfig other_transport = transport;
+  other_transport.set_report_cluster("other_report_server");
+  EXPECT_NE(GetReportAggregator(other_transport, runtime), aggregator);
+
+  transport.set_disable_report_batch(true);
+  EXPECT_EQ(GetReportAggregator(transport, runtime), nullptr);
+}
+
 }  // namespace
@@ -68,6 +68,8 @@ void MixerStatsObject::CheckAndUpdateStats(
   CHECK_AND_UPDATE_STATS(total_remote_check_calls_);
   CHECK_AND_UPDATE_STATS(total_remote_check_accepts_);
   CHECK_AND_UPDATE_STATS(total_remote_check_denies_);
+  CHECK_AND_UPDATE_STATS(total_coalesced_check_calls_);
+  CHECK_AND_UPDATE_STATS(total_check_cache_refreshes_);
   CHECK_AND_UPDATE_STATS(total_quota_calls_);
   CHECK_AND_UPDATE_STATS(total_quota_cache_hits_);
   CHECK_AND_UPDATE_STATS(total_quota_cache_misses_);
@@ -91,6 +93,7 @@ void MixerStatsObject::CheckAndUpdateStats(
   CHECK_AND_UPDATE_STATS(total_remote_report_timeouts_);
   CHECK_AND_UPDATE_STATS(total_remote_report_send_errors_);
   CHECK_AND_UPDATE_STATS(total_remote_report_other_errors_);
+  CHECK_AND_UPDATE_STATS(total_report_drops_);
 
   // Copy new_stats to old_stats_ for next stats update.
   old_stats_ = new_stats;
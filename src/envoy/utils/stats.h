@@ -36,6 +36,8 @@ namespace Utils {
   COUNTER(total_remote_check_calls)           \
   COUNTER(total_remote_check_accepts)         \
   COUNTER(total_remote_check_denies)          \
+  COUNTER(total_coalesced_check_calls)        \
+  COUNTER(total_check_cache_refreshes)        \
   COUNTER(total_quota_calls)                  \
   COUNTER(total_quota_cache_hits)             \
   COUNTER(total_quota_cache_misses)           \
@@ -57,7 +59,8 @@ namespace Utils {
   COUNTER(total_remote_report_successes)      \
   COUNTER(total_remote_report_timeouts)       \
   COUNTER(total_remote_report_send_errors)    \
-  COUNTER(total_remote_report_other_errors)
+  COUNTER(total_remote_report_other_errors)    \
+  COUNTER(total_report_drops)
 // clang-format on
 
 /**
@@ -118,6 +118,34 @@ void FindHeaders(const Http::HeaderMap& header_map,
       &ctx);
 }
 
+void CopyHeaders(const Http::HeaderMap& header_map,
+                 const std::set<std::string>& exclusives,
+                 const std::set<std::string, std::less<>>* inclusives,
+                 ::google::protobuf::Map<std::string, std::string>* headers) {
+  struct Context {
+    const std::set<std::string>& exclusives;
+    const std::set<std::string, std::less<>>* inclusives;
+    ::google::protobuf::Map<std::string, std::string>* headers;
+  };
+  Context ctx{exclusives, inclusives, headers};
+  header_map.iterate(
+      [](const Http::HeaderEntry& header,
+         void* context) -> Http::HeaderMap::Iterate {
+        Context* ctx = static_cast<Context*>(context);
+        absl::string_view key = header.key().getStringView();
+        // Only the selected headers are copied.
+        if (ctx->inclusives != nullptr && ctx->inclusives->count(key) == 0) {
+          return Http::HeaderMap::Iterate::Continue;
+        }
+        std::string name(key);
+        if (ctx->exclusives.count(name) == 0) {
+          (*ctx->headers)[name] = std::string(header.value().getStringView());
+        }
+        return Http::HeaderMap::Iterate::Continue;
+      },
+      &ctx);
+}
+
 bool GetIpPort(const Network::Address::Ip* ip, std::string* str_ip, int* port) {
   if (ip) {
     *port = ip->port();
@@ -16,10 +16,12 @@
 #pragma once
 
 #include <map>
+#include <set>
 #include <string>
 
 #include "envoy/http/header_map.h"
 #include "envoy/network/connection.h"
+#include "google/protobuf/map.h"
 #include "google/protobuf/util/json_util.h"
 #include "include/istio/mixerclient/check_response.h"
 
@@ -37,6 +39,13 @@ void FindHeaders(const Http::HeaderMap& header_map,
                  const std::set<std::string>& inclusives,
                  std::map<std::string, std::string>& headers);
 
+// Copy HTTP headers, except the exclusives, into a protobuf string map.  If
+// "inclusives" is not null, only the headers in it are copied.
+void CopyHeaders(const Http::HeaderMap& header_map,
+                 const std::set<std::string>& exclusives,
+                 const std::set<std::string, std::less<>>* inclusives,
+                 ::google::protobuf::Map<std::string, std::string>* headers);
+
 // Get ip and port from Envoy ip.
 bool GetIpPort(const Network::Address::Ip* ip, std::string* str_ip, int* port);
 
@@ -88,6 +88,8 @@ QuotaOptions GetQuotaOptions(const TransportConfig& config) {
   return QuotaOptions();
 }
 
+}  // namespace
+
 ReportOptions GetReportOptions(const TransportConfig& config) {
   if (config.disable_report_batch()) {
     return ReportOptions(0, 1000);
@@ -110,8 +112,6 @@ ReportOptions GetReportOptions(const TransportConfig& config) {
   return ReportOptions(max_entries, max_time_ms);
 }
 
-}  // namespace
-
 ClientContextBase::ClientContextBase(const TransportConfig& config,
                                      const Environment& env, bool outbound,
                                      const LocalNode& local_node)
@@ -123,6 +123,7 @@ ClientContextBase::ClientContextBase(const TransportConfig& config,
   CreateLocalAttributes(local_node, &local_attributes_);
   network_fail_open_ = options.check_options.network_fail_open;
   retries_ = options.check_options.retries;
+  queue_reports_ = env.report_aggregator != nullptr;
 }
 
 void ClientContextBase::SendCheck(
@@ -140,6 +141,18 @@ void ClientContextBase::SendReport(
   mixer_client_->Report(attributes);
 }
 
+void ClientContextBase::SendReportSnapshot(
+    const istio::mixerclient::SharedAttributesSharedPtr& attributes) {
+  if (!queue_reports_) {
+    SendReport(attributes);
+    return;
+  }
+  istio::mixerclient::SharedAttributesSharedPtr snapshot{
+      new istio::mixerclient::SharedAttributes()};
+  snapshot->attributes()->CopyFrom(*attributes->attributes());
+  SendReport(snapshot);
+}
+
 void ClientContextBase::GetStatistics(Statistics* stat) const {
   mixer_client_->GetStatistics(stat);
 }
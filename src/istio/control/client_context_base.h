@@ -27,6 +27,10 @@
 namespace istio {
 namespace control {
 
+// Gets the report batch options from the transport config.
+::istio::mixerclient::ReportOptions GetReportOptions(
+    const ::istio::mixer::v1::config::client::TransportConfig& config);
+
 // The global context object to hold the mixer client object
 // to call Check/Report with cache.
 class ClientContextBase {
@@ -44,7 +48,8 @@ class ClientContextBase {
         outbound_(outbound),
         local_attributes_(local_attributes),
         network_fail_open_(false),
-        retries_(0) {}
+        retries_(0),
+        queue_reports_(false) {}
   // virtual destrutor
   virtual ~ClientContextBase() {}
 
@@ -57,6 +62,11 @@ class ClientContextBase {
   void SendReport(
       const istio::mixerclient::SharedAttributesSharedPtr& attributes);
 
+  // Make a Report call with attributes the caller keeps updating. They are
+  // copied only if the report is queued for the aggregator thread.
+  void SendReportSnapshot(
+      const istio::mixerclient::SharedAttributesSharedPtr& attributes);
+
   // Get statistics.
   void GetStatistics(::istio::mixerclient::Statistics* stat) const;
 
@@ -81,6 +91,8 @@ class ClientContextBase {
 
   bool network_fail_open_;
   uint32_t retries_;
+  // If reports are queued for the report aggregator thread.
+  bool queue_reports_;
 };
 
 }  // namespace control
@@ -33,12 +33,58 @@ namespace {
 const std::set<std::string> kGrpcContentTypes{
     "application/grpc", "application/grpc+proto", "application/grpc+json"};
 
+// The HTTP header to forward Istio attributes.
+const char kIstioAttributeHeader[] = "x-istio-attributes";
+
+typedef ::google::protobuf::Map<std::string, std::string> StringMapEntries;
+
+// Let "copy" fill the string map attribute "name" in place, without an
+// intermediate map.  The attribute is removed if it has no entries.
+template <class CopyFunc>
+void CopyStringMap(Attributes *attributes, const std::string &name,
+                   CopyFunc copy) {
+  auto *attributes_map = attributes->mutable_attributes();
+  auto *entries =
+      (*attributes_map)[name].mutable_string_map_value()->mutable_entries();
+  entries->clear();
+  copy(entries);
+  if (entries->empty()) {
+    attributes_map->erase(name);
+  }
+}
+
+// Remove the entries of the string map attribute "name" not in "names".
+// The attribute is removed if it has no entries left.
+void ProjectStringMap(Attributes *attributes, const std::string &name,
+                      const HeaderNameSet &names) {
+  auto *attributes_map = attributes->mutable_attributes();
+  auto it = attributes_map->find(name);
+  if (it == attributes_map->end()) {
+    return;
+  }
+  auto *entries = it->second.mutable_string_map_value()->mutable_entries();
+  for (auto entry = entries->begin(); entry != entries->end();) {
+    if (names.count(entry->first) == 0) {
+      entry = entries->erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+  if (entries->empty()) {
+    attributes_map->erase(it);
+  }
+}
+
 }  // namespace
 
 void AttributesBuilder::ExtractRequestHeaderAttributes(CheckData *check_data) {
+  // Check attributes carry all request headers, whatever is reported.
+  CopyStringMap(attributes_, utils::AttributeName::kRequestHeaders,
+                [check_data](StringMapEntries *entries) {
+                  check_data->CopyRequestHeaders(nullptr, entries);
+                });
+
   utils::AttributesBuilder builder(attributes_);
-  std::map<std::string, std::string> headers = check_data->GetRequestHeaders();
-  builder.AddStringMap(utils::AttributeName::kRequestHeaders, headers);
 
   struct TopLevelAttr {
     CheckData::HeaderType header_type;
@@ -126,36 +172,29 @@ void AttributesBuilder::ExtractAuthAttributes(CheckData *check_data) {
   }
 }
 
-void AttributesBuilder::ExtractForwardedAttributes(CheckData *check_data) {
-  std::string forwarded_data;
-  if (!check_data->ExtractIstioAttributes(&forwarded_data)) {
+void AttributesBuilder::ExtractForwardedAttributes(
+    CheckData *check_data, ForwardedAttributesCache *cache) {
+  if (cache) {
+    std::string encoded;
+    if (!check_data->FindHeaderByName(kIstioAttributeHeader, &encoded)) {
+      return;
+    }
+    const Attributes *forwarded = cache->Get(encoded);
+    if (forwarded) {
+      attributes_->MergeFrom(*forwarded);
+    }
     return;
   }
 
-  Attributes v2_format;
-  if (!v2_format.ParseFromString(forwarded_data)) {
+  std::string forwarded_data;
+  if (!check_data->ExtractIstioAttributes(&forwarded_data)) {
     return;
   }
 
-  static const std::set<std::string> kForwardWhitelist = {
-      utils::AttributeName::kSourceUID,
-      utils::AttributeName::kSourceNamespace,
-      utils::AttributeName::kDestinationServiceName,
-      utils::AttributeName::kDestinationServiceUID,
-      utils::AttributeName::kDestinationServiceHost,
-      utils::AttributeName::kDestinationServiceNamespace,
-  };
-
-  auto fwd = v2_format.attributes();
-  utils::AttributesBuilder builder(attributes_);
-  for (const auto &attribute : kForwardWhitelist) {
-    const auto &iter = fwd.find(attribute);
-    if (iter != fwd.end() && !iter->second.string_value().empty()) {
-      builder.AddString(attribute, iter->second.string_value());
-    }
+  Attributes forwarded;
+  if (ForwardedAttributesCache::Decode(forwarded_data, &forwarded)) {
+    attributes_->MergeFrom(forwarded);
   }
-
-  return;
 }
 
 void AttributesBuilder::ExtractCheckAttributes(CheckData *check_data) {
@@ -222,9 +261,19 @@ void AttributesBuilder::ExtractReportAttributes(
     builder.AddString(utils::AttributeName::kDestinationUID, uid);
   }
 
-  std::map<std::string, std::string> headers =
-      report_data->GetResponseHeaders();
-  builder.AddStringMap(utils::AttributeName::kResponseHeaders, headers);
+  const HeaderNameSet *request_names =
+      projection_ ? projection_->request_headers() : nullptr;
+  if (request_names != nullptr) {
+    ProjectStringMap(attributes_, utils::AttributeName::kRequestHeaders,
+                     *request_names);
+  }
+
+  const HeaderNameSet *names =
+      projection_ ? projection_->response_headers() : nullptr;
+  CopyStringMap(attributes_, utils::AttributeName::kResponseHeaders,
+                [report_data, names](StringMapEntries *entries) {
+                  report_data->CopyResponseHeaders(names, entries);
+                });
 
   std::map<std::string, std::string> tracing_headers;
   report_data->GetTracingHeaders(tracing_headers);
@@ -19,6 +19,8 @@
 #include "include/istio/control/http/check_data.h"
 #include "include/istio/control/http/report_data.h"
 #include "mixer/v1/attributes.pb.h"
+#include "src/istio/control/http/forwarded_attributes_cache.h"
+#include "src/istio/control/http/header_projection.h"
 
 namespace istio {
 namespace control {
@@ -27,11 +29,15 @@ namespace http {
 // The context for each HTTP request.
 class AttributesBuilder {
  public:
-  AttributesBuilder(istio::mixer::v1::Attributes* attributes)
-      : attributes_(attributes) {}
+  // If "projection" is not null, it selects the reported headers.
+  AttributesBuilder(istio::mixer::v1::Attributes* attributes,
+                    const HeaderProjection* projection = nullptr)
+      : attributes_(attributes), projection_(projection) {}
 
-  // Extract forwarded attributes from HTTP header.
-  void ExtractForwardedAttributes(CheckData* check_data);
+  // Extract forwarded attributes from HTTP header. The header is decoded
+  // through "cache" if it is not null.
+  void ExtractForwardedAttributes(CheckData* check_data,
+                                  ForwardedAttributesCache* cache = nullptr);
   // Forward attributes to upstream proxy.
   static void ForwardAttributes(
       const ::istio::mixer::v1::Attributes& attributes,
@@ -55,6 +61,7 @@ class AttributesBuilder {
   void ExtractAuthAttributes(CheckData* check_data);
 
   istio::mixer::v1::Attributes* attributes_;
+  const HeaderProjection* projection_;
 };
 
 }  // namespace http
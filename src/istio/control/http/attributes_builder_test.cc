@@ -32,6 +32,7 @@ using ::istio::mixer::v1::Attributes_StringMap;
 
 using ::testing::_;
 using ::testing::Invoke;
+using ::testing::Return;
 using ::testing::ReturnRef;
 
 namespace istio {
@@ -904,6 +905,62 @@ TEST(AttributesBuilderTest, TestReportAttributesWithDestIP) {
   EXPECT_THAT(attributes, EqualsAttribute(expected_attributes));
 }
 
+TEST(AttributesBuilderTest, TestHeaderProjection) {
+  ::testing::NiceMock<MockCheckData> check_data;
+  ::testing::NiceMock<MockReportData> report_data;
+  std::map<std::string, std::string> headers = {
+      {"cookie", "c"}, {"x-trace", "t"}, {"x-user", "u"}};
+  ON_CALL(check_data, GetRequestHeaders()).WillByDefault(Return(headers));
+  ON_CALL(report_data, GetResponseHeaders()).WillByDefault(Return(headers));
+  ::google::protobuf::Map<std::string, ::google::protobuf::Struct>
+      filter_metadata;
+  ON_CALL(report_data, GetDynamicFilterState())
+      .WillByDefault(ReturnRef(filter_metadata));
+
+  HeaderProjection projection(true, {"x-trace"});
+  ::istio::mixer::v1::CheckResponse response;
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+precondition {
+  referenced_attributes {
+    words: "request.headers"
+    words: "x-user"
+    attribute_matches { name: -1 map_key: -2 condition: EXACT }
+  }
+})",
+                                          &response));
+  projection.Learn(response);
+
+  Attributes attributes;
+  AttributesBuilder builder(&attributes, &projection);
+  builder.ExtractCheckAttributes(&check_data);
+  // Check attributes are not projected.
+  EXPECT_EQ(attributes.attributes()
+                .at(utils::AttributeName::kRequestHeaders)
+                .string_map_value()
+                .entries_size(),
+            3);
+
+  builder.ExtractReportAttributes(::google::protobuf::util::Status::OK,
+                                  &report_data);
+
+  const auto &request_headers =
+      attributes.attributes()
+          .at(utils::AttributeName::kRequestHeaders)
+          .string_map_value()
+          .entries();
+  EXPECT_EQ(request_headers.size(), 2);
+  EXPECT_EQ(request_headers.at("x-trace"), "t");
+  EXPECT_EQ(request_headers.at("x-user"), "u");
+
+  const auto &response_headers =
+      attributes.attributes()
+          .at(utils::AttributeName::kResponseHeaders)
+          .string_map_value()
+          .entries();
+  EXPECT_EQ(response_headers.size(), 1);
+  EXPECT_EQ(response_headers.at("x-trace"), "t");
+}
+
 }  // namespace
 }  // namespace http
 }  // namespace control
@@ -24,6 +24,13 @@ using ::istio::utils::AttributeName;
 namespace istio {
 namespace control {
 namespace http {
+namespace {
+
+// The number of distinct forwarded attributes headers cached per worker,
+// typically one per source workload.
+const int kForwardedAttributesCacheSize = 64;
+
+}  // namespace
 
 ClientContext::ClientContext(const Controller::Options& data)
     : ClientContextBase(
@@ -31,7 +38,10 @@ ClientContext::ClientContext(const Controller::Options& data)
           ::istio::utils::IsOutbound(data.config.mixer_attributes()),
           data.local_node),
       config_(data.config),
-      service_config_cache_size_(data.service_config_cache_size) {}
+      service_config_cache_size_(data.service_config_cache_size),
+      header_projection_(data.project_report_headers,
+                         data.report_header_allowlist),
+      forwarded_attributes_cache_(kForwardedAttributesCacheSize) {}
 
 ClientContext::ClientContext(
     std::unique_ptr<::istio::mixerclient::MixerClient> mixer_client,
@@ -40,7 +50,9 @@ ClientContext::ClientContext(
     ::istio::utils::LocalAttributes& local_attributes, bool outbound)
     : ClientContextBase(std::move(mixer_client), outbound, local_attributes),
       config_(config),
-      service_config_cache_size_(service_config_cache_size) {}
+      service_config_cache_size_(service_config_cache_size),
+      header_projection_(false, {}),
+      forwarded_attributes_cache_(kForwardedAttributesCacheSize) {}
 
 const std::string& ClientContext::GetServiceName(
     const std::string& service_name) const {
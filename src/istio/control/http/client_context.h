@@ -20,6 +20,8 @@
 #include "include/istio/utils/local_attributes.h"
 #include "mixer/v1/attributes.pb.h"
 #include "src/istio/control/client_context_base.h"
+#include "src/istio/control/http/forwarded_attributes_cache.h"
+#include "src/istio/control/http/header_projection.h"
 
 namespace istio {
 namespace control {
@@ -55,12 +57,26 @@ class ClientContext : public ClientContextBase {
   // Get the service config cache size
   int service_config_cache_size() const { return service_config_cache_size_; }
 
+  // The headers to extract into attributes.
+  HeaderProjection& header_projection() { return header_projection_; }
+
+  // The decoded forwarded attributes headers.
+  ForwardedAttributesCache& forwarded_attributes_cache() {
+    return forwarded_attributes_cache_;
+  }
+
  private:
   // The http client config.
   const ::istio::mixer::v1::config::client::HttpClientConfig& config_;
 
   // The service config cache size
   int service_config_cache_size_;
+
+  // The headers to extract into attributes.
+  HeaderProjection header_projection_;
+
+  // The decoded forwarded attributes headers.
+  ForwardedAttributesCache forwarded_attributes_cache_;
 };
 
 }  // namespace http
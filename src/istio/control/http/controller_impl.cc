@@ -27,32 +27,32 @@ namespace http {
 namespace {
 // The service context cache size.
 const int kServiceContextCacheSize = 1000;
+
+int GetCacheSize(const ClientContext& client_context) {
+  int cache_size = client_context.service_config_cache_size();
+  return cache_size > 0 ? cache_size : kServiceContextCacheSize;
+}
 }  // namespace
 
 ControllerImpl::ControllerImpl(std::shared_ptr<ClientContext> client_context)
-    : client_context_(client_context) {
-  int cache_size = client_context_->service_config_cache_size();
-  if (cache_size <= 0) {
-    cache_size = kServiceContextCacheSize;
-  }
-  service_context_cache_.reset(new LRUCache(cache_size));
-}
+    : client_context_(client_context),
+      route_contexts_(GetCacheSize(*client_context)),
+      service_name_contexts_(GetCacheSize(*client_context)) {}
 
-ControllerImpl::~ControllerImpl() { service_context_cache_->RemoveAll(); }
+ControllerImpl::~ControllerImpl() {}
 
 bool ControllerImpl::LookupServiceConfig(const std::string& service_config_id) {
-  LRUCache::ScopedLookup lookup(service_context_cache_.get(),
-                                service_config_id);
-  return lookup.Found();
+  return route_contexts_.Lookup(
+             ServiceContextTable::HashName(service_config_id),
+             service_config_id) != nullptr;
 }
 
 void ControllerImpl::AddServiceConfig(
     const std::string& service_config_id,
     const ::istio::mixer::v1::config::client::ServiceConfig& config) {
-  CacheElem* cache_elem = new CacheElem;
-  cache_elem->service_context =
-      std::make_shared<ServiceContext>(client_context_, &config);
-  service_context_cache_->Insert(service_config_id, cache_elem, 1);
+  route_contexts_.Insert(
+      ServiceContextTable::HashName(service_config_id), service_config_id,
+      std::make_shared<ServiceContext>(client_context_, &config));
 }
 
 std::unique_ptr<RequestHandler> ControllerImpl::CreateRequestHandler(
@@ -67,29 +67,42 @@ void ControllerImpl::GetStatistics(Statistics* stat) const {
 
 std::shared_ptr<ServiceContext> ControllerImpl::GetServiceContext(
     const PerRouteConfig& config) {
+  if (config.route_key != 0 && config.service_config != nullptr) {
+    auto service_context = route_contexts_.Lookup(config.route_key);
+    if (!service_context) {
+      service_context = std::make_shared<ServiceContext>(
+          client_context_, config.service_config);
+      route_contexts_.Insert(config.route_key, "", service_context);
+    }
+    return service_context;
+  }
+
   if (!config.service_config_id.empty()) {
-    LRUCache::ScopedLookup lookup(service_context_cache_.get(),
-                                  config.service_config_id);
-    if (lookup.Found()) {
-      return lookup.value()->service_context;
+    auto service_context = route_contexts_.Lookup(
+        ServiceContextTable::HashName(config.service_config_id),
+        config.service_config_id);
+    if (service_context) {
+      return service_context;
     }
   }
 
   const std::string& origin_name = config.destination_service;
-  auto service_context = service_context_map_[origin_name];
+  const uint64_t origin_key = ServiceContextTable::HashName(origin_name);
+  auto service_context = service_name_contexts_.Lookup(origin_key, origin_name);
   if (!service_context) {
     // Get the valid service name from service_configs map.
     auto valid_name = client_context_->GetServiceName(origin_name);
+    const uint64_t valid_key = ServiceContextTable::HashName(valid_name);
     if (valid_name != origin_name) {
-      service_context = service_context_map_[valid_name];
+      service_context = service_name_contexts_.Lookup(valid_key, valid_name);
     }
     if (!service_context) {
       service_context = std::make_shared<ServiceContext>(
           client_context_, client_context_->GetServiceConfig(valid_name));
-      service_context_map_[valid_name] = service_context;
+      service_name_contexts_.Insert(valid_key, valid_name, service_context);
     }
     if (valid_name != origin_name) {
-      service_context_map_[origin_name] = service_context;
+      service_name_contexts_.Insert(origin_key, origin_name, service_context);
     }
   }
   return service_context;
@@ -17,14 +17,12 @@
 #define ISTIO_CONTROL_HTTP_CONTROLLER_IMPL_H
 
 #include <memory>
-#include <unordered_map>
 
 #include "include/istio/control/http/controller.h"
 #include "include/istio/utils/attribute_names.h"
-#include "include/istio/utils/simple_lru_cache.h"
-#include "include/istio/utils/simple_lru_cache_inl.h"
 #include "src/istio/control/http/client_context.h"
 #include "src/istio/control/http/service_context.h"
+#include "src/istio/control/http/service_context_table.h"
 
 namespace istio {
 namespace control {
@@ -59,20 +57,16 @@ class ControllerImpl : public Controller {
   // The client context object to hold client config and client cache.
   std::shared_ptr<ClientContext> client_context_;
 
-  // The map to cache service context. key is destination.service
-  std::unordered_map<std::string, std::shared_ptr<ServiceContext>>
-      service_context_map_;
-
-  // per-route service config may be changed overtime.  A LRU cacahe is used to
-  // store used service contexts. ServiceContext initialization is expensive.
-  // This cache helps reducing number of ServiceContext creation.
-  // The cache has fixed size to control the memory usage. The oldest ones
+  // per-route service config may be changed overtime.  A LRU table is used
+  // to store used service contexts, keyed by the per-route key or by the
+  // config id. ServiceContext initialization is expensive.  This table helps
+  // reducing number of ServiceContext creation.
+  // The table has fixed size to control the memory usage. The oldest ones
   // will be purged if the size limit is reached.
-  struct CacheElem {
-    std::shared_ptr<ServiceContext> service_context;
-  };
-  using LRUCache = ::istio::utils::SimpleLRUCache<std::string, CacheElem>;
-  std::unique_ptr<LRUCache> service_context_cache_;
+  ServiceContextTable route_contexts_;
+
+  // The service contexts by destination.service, with the same size limit.
+  ServiceContextTable service_name_contexts_;
 };
 
 }  // namespace http
@@ -0,0 +1,84 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/control/http/forwarded_attributes_cache.h"
+
+#include <functional>
+#include <set>
+
+#include "absl/strings/escaping.h"
+#include "include/istio/utils/attribute_names.h"
+#include "include/istio/utils/attributes_builder.h"
+
+using ::istio::mixer::v1::Attributes;
+
+namespace istio {
+namespace control {
+namespace http {
+
+ForwardedAttributesCache::ForwardedAttributesCache(int capacity)
+    : capacity_(capacity > 0 ? capacity : 1) {}
+
+const Attributes* ForwardedAttributesCache::Get(const std::string& encoded) {
+  size_t digest = std::hash<std::string>()(encoded);
+  auto it = entries_.find(digest);
+  if (it == entries_.end() || it->second.encoded != encoded) {
+    if (it == entries_.end()) {
+      if (entries_.size() >= capacity_) {
+        entries_.erase(entries_.begin());
+      }
+      it = entries_.emplace(digest, Entry()).first;
+    }
+    // A new header value, or a digest collision which replaces the entry.
+    Entry& entry = it->second;
+    entry.encoded = encoded;
+    entry.attributes.Clear();
+    std::string data;
+    entry.valid = absl::Base64Unescape(encoded, &data) &&
+                  Decode(data, &entry.attributes);
+  }
+  return it->second.valid ? &it->second.attributes : nullptr;
+}
+
+bool ForwardedAttributesCache::Decode(const std::string& data,
+                                      Attributes* forwarded) {
+  Attributes v2_format;
+  if (!v2_format.ParseFromString(data)) {
+    return false;
+  }
+
+  static const std::set<std::string> kForwardWhitelist = {
+      utils::AttributeName::kSourceUID,
+      utils::AttributeName::kSourceNamespace,
+      utils::AttributeName::kDestinationServiceName,
+      utils::AttributeName::kDestinationServiceUID,
+      utils::AttributeName::kDestinationServiceHost,
+      utils::AttributeName::kDestinationServiceNamespace,
+  };
+
+  const auto& fwd = v2_format.attributes();
+  utils::AttributesBuilder builder(forwarded);
+  for (const auto& attribute : kForwardWhitelist) {
+    const auto& iter = fwd.find(attribute);
+    if (iter != fwd.end() && !iter->second.string_value().empty()) {
+      builder.AddString(attribute, iter->second.string_value());
+    }
+  }
+  return true;
+}
+
+}  // namespace http
+}  // namespace control
+}  // namespace istio
@@ -0,0 +1,66 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ISTIO_CONTROL_HTTP_FORWARDED_ATTRIBUTES_CACHE_H
+#define ISTIO_CONTROL_HTTP_FORWARDED_ATTRIBUTES_CACHE_H
+
+#include <string>
+#include <unordered_map>
+
+#include "google/protobuf/stubs/common.h"
+#include "mixer/v1/attributes.pb.h"
+
+namespace istio {
+namespace control {
+namespace http {
+
+// A cache of the attributes forwarded by the "x-istio-attributes" header,
+// keyed by the digest of the base64 encoded header value.  The header is
+// usually identical for all the traffic from a source workload, so a hit
+// saves decoding and parsing it for every request.  Not thread safe, each
+// worker thread owns one.
+class ForwardedAttributesCache {
+ public:
+  explicit ForwardedAttributesCache(int capacity);
+
+  // Return the attributes forwarded by the base64 encoded header value,
+  // filtered to the ones accepted from a downstream proxy.  Return nullptr
+  // if the header is malformed.  The pointer is valid until the next call.
+  const ::istio::mixer::v1::Attributes* Get(const std::string& encoded);
+
+  // Parse serialized forwarded attributes, keep the accepted ones.
+  static bool Decode(const std::string& data,
+                     ::istio::mixer::v1::Attributes* forwarded);
+
+  int size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    std::string encoded;
+    bool valid;
+    ::istio::mixer::v1::Attributes attributes;
+  };
+
+  const size_t capacity_;
+  std::unordered_map<size_t, Entry> entries_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ForwardedAttributesCache);
+};
+
+}  // namespace http
+}  // namespace control
+}  // namespace istio
+
+#endif  // ISTIO_CONTROL_HTTP_FORWARDED_ATTRIBUTES_CACHE_H
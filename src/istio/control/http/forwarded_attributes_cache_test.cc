@@ -0,0 +1,92 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/control/http/forwarded_attributes_cache.h"
+
+#include "absl/strings/escaping.h"
+#include "gtest/gtest.h"
+#include "include/istio/utils/attribute_names.h"
+
+using ::istio::mixer::v1::Attributes;
+
+namespace istio {
+namespace control {
+namespace http {
+namespace {
+
+std::string Encode(const std::string& source_uid) {
+  Attributes attributes;
+  auto* map = attributes.mutable_attributes();
+  (*map)[utils::AttributeName::kSourceUID].set_string_value(source_uid);
+  (*map)[utils::AttributeName::kSourceNamespace].set_string_value("");
+  (*map)["destination.uid"].set_string_value("ignored");
+  std::string data;
+  attributes.SerializeToString(&data);
+  std::string encoded;
+  absl::Base64Escape(data, &encoded);
+  return encoded;
+}
+
+TEST(ForwardedAttributesCacheTest, TestDecode) {
+  ForwardedAttributesCache cache(10);
+  const std::string header = Encode("pod1");
+  const Attributes* forwarded = cache.Get(header);
+  ASSERT_NE(forwarded, nullptr);
+  // Only the non empty attributes of the whitelist are accepted.
+  EXPECT_EQ(forwarded->attributes().size(), 1);
+  EXPECT_EQ(forwarded->attributes()
+                .at(utils::AttributeName::kSourceUID)
+                .string_value(),
+            "pod1");
+
+  EXPECT_EQ(cache.Get(header), forwarded);
+  EXPECT_EQ(cache.size(), 1);
+
+  forwarded = cache.Get(Encode("pod2"));
+  ASSERT_NE(forwarded, nullptr);
+  EXPECT_EQ(forwarded->attributes()
+                .at(utils::AttributeName::kSourceUID)
+                .string_value(),
+            "pod2");
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(ForwardedAttributesCacheTest, TestMalformedHeader) {
+  ForwardedAttributesCache cache(10);
+  EXPECT_EQ(cache.Get("not base64!"), nullptr);
+  // Base64 encoded, but not a protobuf.
+  EXPECT_EQ(cache.Get("/w=="), nullptr);
+  EXPECT_EQ(cache.Get("not base64!"), nullptr);
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(ForwardedAttributesCacheTest, TestCapacity) {
+  ForwardedAttributesCache cache(3);
+  for (int i = 0; i < 10; ++i) {
+    std::string uid = "pod" + std::to_string(i);
+    const Attributes* forwarded = cache.Get(Encode(uid));
+    ASSERT_NE(forwarded, nullptr);
+    EXPECT_EQ(forwarded->attributes()
+                  .at(utils::AttributeName::kSourceUID)
+                  .string_value(),
+              uid);
+    EXPECT_LE(cache.size(), 3);
+  }
+}
+
+}  // namespace
+}  // namespace http
+}  // namespace control
+}  // namespace istio
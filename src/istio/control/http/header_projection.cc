@@ -0,0 +1,69 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/control/http/header_projection.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "include/istio/utils/attribute_names.h"
+#include "src/istio/mixerclient/referenced.h"
+
+using ::istio::mixer::v1::CheckResponse;
+using ::istio::mixerclient::Referenced;
+
+namespace istio {
+namespace control {
+namespace http {
+namespace {
+
+// Envoy header names are lower case, Mixer may reference any case.
+std::string ToLower(std::string name) {
+  std::transform(name.begin(), name.end(), name.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return name;
+}
+
+}  // namespace
+
+HeaderProjection::HeaderProjection(bool enabled,
+                                   const std::vector<std::string>& allowlist)
+    : enabled_(enabled), learned_(false) {
+  for (const auto& name : allowlist) {
+    request_headers_.insert(ToLower(name));
+    response_headers_.insert(ToLower(name));
+  }
+}
+
+void HeaderProjection::Learn(const CheckResponse& response) {
+  if (!enabled_ || !response.has_precondition()) {
+    return;
+  }
+  std::vector<std::string> map_keys;
+  if (!Referenced::GetMapKeys(response.precondition().referenced_attributes(),
+                              utils::AttributeName::kRequestHeaders,
+                              &map_keys)) {
+    // Keep reporting all headers, if nothing was learned yet.
+    return;
+  }
+  for (const auto& key : map_keys) {
+    request_headers_.insert(ToLower(key));
+  }
+  learned_ = true;
+}
+
+}  // namespace http
+}  // namespace control
+}  // namespace istio
@@ -0,0 +1,69 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ISTIO_CONTROL_HTTP_HEADER_PROJECTION_H
+#define ISTIO_CONTROL_HTTP_HEADER_PROJECTION_H
+
+#include <string>
+#include <vector>
+
+#include "include/istio/control/http/check_data.h"
+#include "mixer/v1/mixer.pb.h"
+
+namespace istio {
+namespace control {
+namespace http {
+
+// Selects the HTTP headers reported in the request.headers and
+// response.headers attributes.  Check attributes always carry all headers.
+//
+// If enabled, reported request headers are projected onto the allowlist
+// plus the headers Mixer policies have referenced, as learned from the
+// referenced attributes of Check responses.  Until the first Check response
+// is learned, all request headers are reported.  Reported response headers
+// are projected onto the allowlist.  If not enabled, all headers are
+// reported.
+class HeaderProjection {
+ public:
+  HeaderProjection(bool enabled, const std::vector<std::string>& allowlist);
+
+  // The request headers to report, nullptr for all headers.
+  const HeaderNameSet* request_headers() const {
+    return enabled_ && learned_ ? &request_headers_ : nullptr;
+  }
+
+  // The response headers to report, nullptr for all headers.
+  const HeaderNameSet* response_headers() const {
+    return enabled_ ? &response_headers_ : nullptr;
+  }
+
+  // Return true if reported headers are projected.
+  bool enabled() const { return enabled_; }
+
+  // Learn the request headers referenced by a Check response.
+  void Learn(const ::istio::mixer::v1::CheckResponse& response);
+
+ private:
+  const bool enabled_;
+  bool learned_;
+  HeaderNameSet request_headers_;
+  HeaderNameSet response_headers_;
+};
+
+}  // namespace http
+}  // namespace control
+}  // namespace istio
+
+#endif  // ISTIO_CONTROL_HTTP_HEADER_PROJECTION_H
@@ -0,0 +1,89 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/control/http/header_projection.h"
+
+#include "google/protobuf/text_format.h"
+#include "gtest/gtest.h"
+
+using ::google::protobuf::TextFormat;
+using ::istio::mixer::v1::CheckResponse;
+
+namespace istio {
+namespace control {
+namespace http {
+namespace {
+
+// request.headers is referenced with map keys "x-user" and "Cookie".
+const char kCheckResponse[] = R"(
+precondition {
+  referenced_attributes {
+    words: "request.headers"
+    words: "x-user"
+    words: "Cookie"
+    words: "source.uid"
+    attribute_matches {
+      name: -1
+      map_key: -2
+      condition: EXACT
+    }
+    attribute_matches {
+      name: -1
+      map_key: -3
+      condition: ABSENCE
+    }
+    attribute_matches {
+      name: -4
+      condition: EXACT
+    }
+  }
+}
+)";
+
+TEST(HeaderProjectionTest, TestDisabled) {
+  HeaderProjection projection(false, {"x-trace"});
+  EXPECT_FALSE(projection.enabled());
+  CheckResponse response;
+  ASSERT_TRUE(TextFormat::ParseFromString(kCheckResponse, &response));
+  projection.Learn(response);
+  EXPECT_EQ(projection.request_headers(), nullptr);
+  EXPECT_EQ(projection.response_headers(), nullptr);
+}
+
+TEST(HeaderProjectionTest, TestLearnReferencedHeaders) {
+  HeaderProjection projection(true, {"X-Trace"});
+  EXPECT_TRUE(projection.enabled());
+  // All request headers until a check response is learned.
+  EXPECT_EQ(projection.request_headers(), nullptr);
+  ASSERT_NE(projection.response_headers(), nullptr);
+  EXPECT_EQ(*projection.response_headers(), HeaderNameSet({"x-trace"}));
+
+  // A failed check has no referenced attributes.
+  projection.Learn(CheckResponse());
+  EXPECT_EQ(projection.request_headers(), nullptr);
+
+  CheckResponse response;
+  ASSERT_TRUE(TextFormat::ParseFromString(kCheckResponse, &response));
+  projection.Learn(response);
+  ASSERT_NE(projection.request_headers(), nullptr);
+  EXPECT_EQ(*projection.request_headers(),
+            HeaderNameSet({"cookie", "x-trace", "x-user"}));
+  EXPECT_EQ(*projection.response_headers(), HeaderNameSet({"x-trace"}));
+}
+
+}  // namespace
+}  // namespace http
+}  // namespace control
+}  // namespace istio
@@ -56,6 +56,7 @@ class MockHeaderUpdate : public HeaderUpdate {
  public:
   MOCK_METHOD0(RemoveIstioAttributes, void());
   MOCK_METHOD1(AddIstioAttributes, void(const std::string &data));
+  MOCK_METHOD1(AddEncodedIstioAttributes, void(const std::string &encoded));
 };
 
 }  // namespace http
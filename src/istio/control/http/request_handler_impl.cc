@@ -45,7 +45,9 @@ void RequestHandlerImpl::AddForwardAttributes(CheckData* check_data) {
 
   if (!service_context_->ignore_forwarded_attributes()) {
     AttributesBuilder builder(attributes_->attributes());
-    builder.ExtractForwardedAttributes(check_data);
+    builder.ExtractForwardedAttributes(
+        check_data,
+        &service_context_->client_context()->forwarded_attributes_cache());
   }
 }
 
@@ -84,8 +86,23 @@ void RequestHandlerImpl::Check(CheckData* check_data,
   service_context_->AddQuotas(attributes_->attributes(),
                               check_context_->quotaRequirements());
 
-  service_context_->client_context()->SendCheck(transport, on_done,
-                                                check_context_);
+  auto client_context = service_context_->client_context();
+  if (!client_context->header_projection().enabled()) {
+    client_context->SendCheck(transport, on_done, check_context_);
+    return;
+  }
+  // Learn the headers referenced by Mixer policies from the response.
+  auto check_context = check_context_;
+  client_context->SendCheck(
+      transport,
+      [client_context, check_context, on_done](const CheckResponseInfo& info) {
+        if (check_context->remoteResponse() != nullptr) {
+          client_context->header_projection().Learn(
+              *check_context->remoteResponse());
+        }
+        on_done(info);
+      },
+      check_context_);
 }
 
 void RequestHandlerImpl::ResetCancel() {
@@ -110,7 +127,9 @@ void RequestHandlerImpl::Report(CheckData* check_data,
   AddForwardAttributes(check_data);
   AddCheckAttributes(check_data);
 
-  AttributesBuilder builder(attributes_->attributes());
+  AttributesBuilder builder(
+      attributes_->attributes(),
+      &service_context_->client_context()->header_projection());
   builder.ExtractReportAttributes(check_context_->status(), report_data);
 
   service_context_->client_context()->SendReport(attributes_);
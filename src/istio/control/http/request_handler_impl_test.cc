@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include "absl/strings/escaping.h"
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
 #include "include/istio/utils/attribute_names.h"
@@ -247,6 +248,29 @@ TEST_F(RequestHandlerImplTest, TestServiceConfigManage) {
   EXPECT_TRUE(controller_->LookupServiceConfig("4444"));
 }
 
+TEST_F(RequestHandlerImplTest, TestPerRouteKey) {
+  ::testing::NiceMock<MockCheckData> mock_data;
+  ::testing::NiceMock<MockHeaderUpdate> mock_header;
+
+  // Check should NOT be called.
+  EXPECT_CALL(*mock_client_, Check(_, _, _)).Times(0);
+
+  ServiceConfig config;
+  config.set_disable_check_calls(true);
+  Controller::PerRouteConfig per_route;
+  per_route.route_key = 1111;
+  per_route.service_config = &config;
+  controller_->CreateRequestHandler(per_route);
+
+  // The service context of the key is reused, the config is not read.
+  ServiceConfig other_config;
+  per_route.service_config = &other_config;
+  auto handler = controller_->CreateRequestHandler(per_route);
+  handler->Check(
+      &mock_data, &mock_header, nullptr,
+      [](const CheckResponseInfo &info) { EXPECT_TRUE(info.status().ok()); });
+}
+
 TEST_F(RequestHandlerImplTest, TestHandlerDisabledCheckReport) {
   ::testing::NiceMock<MockCheckData> mock_data;
   ::testing::NiceMock<MockHeaderUpdate> mock_header;
@@ -333,8 +357,10 @@ TEST_F(RequestHandlerImplTest, TestDefaultRouteAttributes) {
       }));
 
   // Attribute is forwarded: route override
-  EXPECT_CALL(mock_header, AddIstioAttributes(_))
-      .WillOnce(Invoke([](const std::string &data) {
+  EXPECT_CALL(mock_header, AddEncodedIstioAttributes(_))
+      .WillOnce(Invoke([](const std::string &encoded) {
+        std::string data;
+        EXPECT_TRUE(absl::Base64Unescape(encoded, &data));
         Attributes forwarded_attr;
         EXPECT_TRUE(forwarded_attr.ParseFromString(data));
         auto map = forwarded_attr.attributes();
@@ -370,8 +396,10 @@ TEST_F(RequestHandlerImplTest, TestRouteAttributes) {
       }));
 
   // Attribute is forwarded: global
-  EXPECT_CALL(mock_header, AddIstioAttributes(_))
-      .WillOnce(Invoke([](const std::string &data) {
+  EXPECT_CALL(mock_header, AddEncodedIstioAttributes(_))
+      .WillOnce(Invoke([](const std::string &encoded) {
+        std::string data;
+        EXPECT_TRUE(absl::Base64Unescape(encoded, &data));
         Attributes forwarded_attr;
         EXPECT_TRUE(forwarded_attr.ParseFromString(data));
         auto map = forwarded_attr.attributes();
@@ -481,8 +509,10 @@ TEST_F(RequestHandlerImplTest, TestEmptyConfig) {
   EXPECT_CALL(mock_check, GetPrincipal(_, _)).Times(0);
 
   // Attributes is forwarded.
-  EXPECT_CALL(mock_header, AddIstioAttributes(_))
-      .WillOnce(Invoke([](const std::string &data) {
+  EXPECT_CALL(mock_header, AddEncodedIstioAttributes(_))
+      .WillOnce(Invoke([](const std::string &encoded) {
+        std::string data;
+        EXPECT_TRUE(absl::Base64Unescape(encoded, &data));
         Attributes forwarded_attr;
         EXPECT_TRUE(forwarded_attr.ParseFromString(data));
         auto map = forwarded_attr.attributes();
@@ -532,14 +562,16 @@ TEST_F(OutboundRequestHandlerImplTest, TestLocalAttributesOverride) {
   ::testing::NiceMock<MockCheckData> mock_data;
   ::testing::NiceMock<MockHeaderUpdate> mock_header;
 
-  EXPECT_CALL(mock_data, ExtractIstioAttributes(_))
-      .WillOnce(Invoke([](std::string *data) -> bool {
+  EXPECT_CALL(mock_data, FindHeaderByName("x-istio-attributes", _))
+      .WillOnce(Invoke([](const std::string &, std::string *value) -> bool {
         Attributes fwd_attr;
         (*fwd_attr.mutable_attributes())["source.uid"].set_string_value(
             "fwded");
         (*fwd_attr.mutable_attributes())["destination.uid"].set_string_value(
             "ignored");
-        fwd_attr.SerializeToString(data);
+        std::string data;
+        fwd_attr.SerializeToString(&data);
+        absl::Base64Escape(data, value);
         return true;
       }));
 
@@ -566,7 +598,7 @@ TEST_F(OutboundRequestHandlerImplTest, TestIgnoreForwardedAttributes) {
   ::testing::NiceMock<MockCheckData> mock_data;
   ::testing::NiceMock<MockHeaderUpdate> mock_header;
 
-  EXPECT_CALL(mock_data, ExtractIstioAttributes(_)).Times(0);
+  EXPECT_CALL(mock_data, FindHeaderByName(_, _)).Times(0);
 
   // Check should be called.
   EXPECT_CALL(*mock_client_, Check(_, _, _))
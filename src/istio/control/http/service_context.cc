@@ -15,8 +15,8 @@
 
 #include "service_context.h"
 
+#include "absl/strings/escaping.h"
 #include "include/istio/utils/attribute_names.h"
-#include "src/istio/control/http/attributes_builder.h"
 
 using ::istio::mixer::v1::Attributes;
 using ::istio::mixer::v1::config::client::ServiceConfig;
@@ -58,9 +58,8 @@ void ServiceContext::AddStaticAttributes(
   }
 }
 
-// Inject a header that contains the static forwarded attributes.
-void ServiceContext::InjectForwardedAttributes(
-    HeaderUpdate *header_update) const {
+void ServiceContext::EncodeForwardedAttributes() const {
+  forwarded_attributes_encoded_ = true;
   Attributes attributes;
 
   client_context_->AddLocalNodeForwardAttribues(&attributes);
@@ -73,7 +72,20 @@ void ServiceContext::InjectForwardedAttributes(
   }
 
   if (!attributes.attributes().empty()) {
-    AttributesBuilder::ForwardAttributes(attributes, header_update);
+    std::string data;
+    attributes.SerializeToString(&data);
+    absl::Base64Escape(data, &encoded_forwarded_attributes_);
+  }
+}
+
+// Inject a header that contains the static forwarded attributes.
+void ServiceContext::InjectForwardedAttributes(
+    HeaderUpdate *header_update) const {
+  if (!forwarded_attributes_encoded_) {
+    EncodeForwardedAttributes();
+  }
+  if (!encoded_forwarded_attributes_.empty()) {
+    header_update->AddEncodedIstioAttributes(encoded_forwarded_attributes_);
   }
 }
 
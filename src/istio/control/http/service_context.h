@@ -61,6 +61,10 @@ class ServiceContext {
   // Pre-process the config data to build parser objects.
   void BuildParsers();
 
+  // Serialize and base64 encode the static forwarded attributes, on the
+  // first request.
+  void EncodeForwardedAttributes() const;
+
   // The client context object.
   std::shared_ptr<ClientContext> client_context_;
 
@@ -71,6 +75,10 @@ class ServiceContext {
   // The service config.
   std::unique_ptr<::istio::mixer::v1::config::client::ServiceConfig>
       service_config_;
+
+  // The base64 encoded forwarded attributes, empty if none.
+  mutable bool forwarded_attributes_encoded_{};
+  mutable std::string encoded_forwarded_attributes_;
 };
 
 }  // namespace http
@@ -0,0 +1,149 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/control/http/service_context_table.h"
+
+#include <functional>
+
+namespace istio {
+namespace control {
+namespace http {
+
+ServiceContextTable::ServiceContextTable(int capacity)
+    : capacity_(capacity > 0 ? capacity : 1), head_(-1), tail_(-1) {
+  int bits = 1;
+  while ((1 << bits) < 2 * capacity_) {
+    ++bits;
+  }
+  index_.assign(1 << bits, -1);
+  index_shift_ = 64 - bits;
+  slots_.reserve(capacity_);
+}
+
+uint64_t ServiceContextTable::HashName(const std::string& name) {
+  return std::hash<std::string>()(name);
+}
+
+size_t ServiceContextTable::Home(uint64_t key) const {
+  return (key * 0x9E3779B97F4A7C15ull) >> index_shift_;
+}
+
+size_t ServiceContextTable::Find(uint64_t key, const std::string& name) const {
+  const size_t mask = index_.size() - 1;
+  size_t pos = Home(key);
+  while (index_[pos] >= 0) {
+    const Slot& slot = slots_[index_[pos]];
+    if (slot.key == key && slot.name == name) {
+      break;
+    }
+    pos = (pos + 1) & mask;
+  }
+  return pos;
+}
+
+std::shared_ptr<ServiceContext> ServiceContextTable::Lookup(
+    uint64_t key, const std::string& name) {
+  int slot = index_[Find(key, name)];
+  if (slot < 0) {
+    return nullptr;
+  }
+  if (slot != head_) {
+    Unlink(slot);
+    LinkFront(slot);
+  }
+  return slots_[slot].service_context;
+}
+
+void ServiceContextTable::Insert(
+    uint64_t key, const std::string& name,
+    std::shared_ptr<ServiceContext> service_context) {
+  size_t pos = Find(key, name);
+  int slot = index_[pos];
+  if (slot >= 0) {
+    Unlink(slot);
+  } else {
+    if (size() < capacity_) {
+      slot = size();
+      slots_.emplace_back();
+    } else {
+      // Reuse the least recently used slot.
+      slot = tail_;
+      EraseIndex(slot);
+      Unlink(slot);
+      pos = Find(key, name);
+    }
+    index_[pos] = slot;
+    slots_[slot].key = key;
+    slots_[slot].name = name;
+  }
+  slots_[slot].service_context = std::move(service_context);
+  LinkFront(slot);
+}
+
+void ServiceContextTable::EraseIndex(int slot) {
+  const size_t mask = index_.size() - 1;
+  size_t hole = Home(slots_[slot].key);
+  while (index_[hole] != slot) {
+    hole = (hole + 1) & mask;
+  }
+  // Shift back the following entries of the probe run which can't be found
+  // past the hole anymore.
+  size_t pos = hole;
+  while (true) {
+    pos = (pos + 1) & mask;
+    if (index_[pos] < 0) {
+      break;
+    }
+    size_t home = Home(slots_[index_[pos]].key);
+    // The entry stays if its home is cyclically in (hole, pos].
+    bool stays = hole <= pos ? (home > hole && home <= pos)
+                             : (home > hole || home <= pos);
+    if (!stays) {
+      index_[hole] = index_[pos];
+      hole = pos;
+    }
+  }
+  index_[hole] = -1;
+}
+
+void ServiceContextTable::Unlink(int slot) {
+  Slot& s = slots_[slot];
+  if (s.prev >= 0) {
+    slots_[s.prev].next = s.next;
+  } else {
+    head_ = s.next;
+  }
+  if (s.next >= 0) {
+    slots_[s.next].prev = s.prev;
+  } else {
+    tail_ = s.prev;
+  }
+}
+
+void ServiceContextTable::LinkFront(int slot) {
+  Slot& s = slots_[slot];
+  s.prev = -1;
+  s.next = head_;
+  if (head_ >= 0) {
+    slots_[head_].prev = slot;
+  } else {
+    tail_ = slot;
+  }
+  head_ = slot;
+}
+
+}  // namespace http
+}  // namespace control
+}  // namespace istio
@@ -0,0 +1,95 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ISTIO_CONTROL_HTTP_SERVICE_CONTEXT_TABLE_H
+#define ISTIO_CONTROL_HTTP_SERVICE_CONTEXT_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/istio/control/http/service_context.h"
+
+namespace istio {
+namespace control {
+namespace http {
+
+// A LRU table of service contexts with a fixed number of entries, keyed by
+// a 64 bit key.  The entries live in a preallocated array, linked in LRU
+// order by index, and are found through an open addressing index, so a
+// lookup is an integer probe without memory allocation.
+//
+// A key either identifies the entry by itself (a precomputed per-route
+// key), or is a hash of a name, in which case the name is stored and
+// compared to resolve collisions.
+//
+// Not thread-safe.
+class ServiceContextTable {
+ public:
+  explicit ServiceContextTable(int capacity);
+
+  // Lookup the service context for the key and the name. Return nullptr if
+  // not found.
+  std::shared_ptr<ServiceContext> Lookup(uint64_t key,
+                                         const std::string& name = "");
+
+  // Insert or replace the service context for the key and the name.  The
+  // least recently used entry is evicted if the table is full.
+  void Insert(uint64_t key, const std::string& name,
+              std::shared_ptr<ServiceContext> service_context);
+
+  // The key to use for a name.
+  static uint64_t HashName(const std::string& name);
+
+  int size() const { return static_cast<int>(slots_.size()); }
+  int capacity() const { return capacity_; }
+
+ private:
+  struct Slot {
+    uint64_t key;
+    std::string name;
+    std::shared_ptr<ServiceContext> service_context;
+    // The neighbors in the LRU list, -1 at the ends.
+    int prev;
+    int next;
+  };
+
+  // Return the index position holding the entry, or the empty position
+  // where it should be inserted.
+  size_t Find(uint64_t key, const std::string& name) const;
+  // The first position to probe for the key.
+  size_t Home(uint64_t key) const;
+  // Remove the slot from the index.
+  void EraseIndex(int slot);
+
+  void Unlink(int slot);
+  void LinkFront(int slot);
+
+  const int capacity_;
+  std::vector<Slot> slots_;
+  // Slot numbers, -1 for empty positions.  At most half full.
+  std::vector<int> index_;
+  int index_shift_;
+  // The most and the least recently used slots.
+  int head_;
+  int tail_;
+};
+
+}  // namespace http
+}  // namespace control
+}  // namespace istio
+
+#endif  // ISTIO_CONTROL_HTTP_SERVICE_CONTEXT_TABLE_H
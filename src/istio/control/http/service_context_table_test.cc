@@ -0,0 +1,124 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/control/http/service_context_table.h"
+
+#include <list>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace istio {
+namespace control {
+namespace http {
+namespace {
+
+std::shared_ptr<ServiceContext> NewContext() {
+  return std::make_shared<ServiceContext>(nullptr, nullptr);
+}
+
+TEST(ServiceContextTableTest, TestLookupInsert) {
+  ServiceContextTable table(10);
+  EXPECT_EQ(table.Lookup(1), nullptr);
+
+  auto context1 = NewContext();
+  auto context2 = NewContext();
+  table.Insert(1, "", context1);
+  table.Insert(2, "", context2);
+  EXPECT_EQ(table.Lookup(1), context1);
+  EXPECT_EQ(table.Lookup(2), context2);
+  EXPECT_EQ(table.size(), 2);
+
+  // Replace
+  table.Insert(1, "", context2);
+  EXPECT_EQ(table.Lookup(1), context2);
+  EXPECT_EQ(table.size(), 2);
+}
+
+TEST(ServiceContextTableTest, TestNameCollision) {
+  ServiceContextTable table(10);
+  auto context1 = NewContext();
+  auto context2 = NewContext();
+  auto context3 = NewContext();
+  // Same key, different names.
+  table.Insert(7, "foo", context1);
+  table.Insert(7, "bar", context2);
+  table.Insert(7, "", context3);
+  EXPECT_EQ(table.Lookup(7, "foo"), context1);
+  EXPECT_EQ(table.Lookup(7, "bar"), context2);
+  EXPECT_EQ(table.Lookup(7), context3);
+  EXPECT_EQ(table.Lookup(7, "baz"), nullptr);
+
+  EXPECT_EQ(table.Lookup(ServiceContextTable::HashName("foo"), "foo"),
+            nullptr);
+}
+
+TEST(ServiceContextTableTest, TestEvictLeastRecentlyUsed) {
+  ServiceContextTable table(3);
+  table.Insert(1, "", NewContext());
+  table.Insert(2, "", NewContext());
+  table.Insert(3, "", NewContext());
+  EXPECT_NE(table.Lookup(1), nullptr);
+
+  table.Insert(4, "", NewContext());
+  EXPECT_EQ(table.size(), 3);
+  EXPECT_EQ(table.Lookup(2), nullptr);
+  EXPECT_NE(table.Lookup(1), nullptr);
+  EXPECT_NE(table.Lookup(3), nullptr);
+  EXPECT_NE(table.Lookup(4), nullptr);
+}
+
+// Compare with a simple LRU list, keys collide in the index.
+TEST(ServiceContextTableTest, TestRandomOperations) {
+  const int kCapacity = 50;
+  ServiceContextTable table(kCapacity);
+  std::list<std::pair<uint64_t, std::shared_ptr<ServiceContext>>> lru;
+
+  std::mt19937 rand(1);
+  for (int i = 0; i < 100000; ++i) {
+    uint64_t key = rand() % 200;
+    auto it = lru.begin();
+    while (it != lru.end() && it->first != key) {
+      ++it;
+    }
+    if (rand() % 2 == 0) {
+      auto found = table.Lookup(key);
+      if (it == lru.end()) {
+        ASSERT_EQ(found, nullptr);
+      } else {
+        ASSERT_EQ(found, it->second);
+        lru.splice(lru.begin(), lru, it);
+      }
+    } else {
+      auto context = NewContext();
+      table.Insert(key, "", context);
+      if (it != lru.end()) {
+        lru.erase(it);
+      } else if (lru.size() == kCapacity) {
+        lru.pop_back();
+      }
+      lru.emplace_front(key, context);
+    }
+    ASSERT_EQ(table.size(), static_cast<int>(lru.size()));
+  }
+  for (const auto& entry : lru) {
+    EXPECT_EQ(table.Lookup(entry.first), entry.second);
+  }
+}
+
+}  // namespace
+}  // namespace http
+}  // namespace control
+}  // namespace istio
@@ -82,7 +82,8 @@ void RequestHandlerImpl::Report(ReportData* report_data,
   builder.ExtractReportAttributes(check_context_->status(), report_data, event,
                                   &last_report_info_);
 
-  client_context_->SendReport(attributes_);
+  // attributes_ is updated by the next periodical report.
+  client_context_->SendReportSnapshot(attributes_);
 }
 
 }  // namespace tcp
@@ -0,0 +1,96 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/mixerclient/adaptive_batch_sizer.h"
+
+#include <algorithm>
+
+using namespace std::chrono;
+
+namespace istio {
+namespace mixerclient {
+namespace {
+
+// Weight of a new sample in the moving averages.
+const double kSampleWeight = 0.25;
+
+// A partially filled batch is kept for this many transport latencies.
+const double kLatencyMultiple = 4;
+
+double Average(double average, double sample) {
+  if (average == 0) {
+    return sample;
+  }
+  return average + kSampleWeight * (sample - average);
+}
+
+}  // namespace
+
+AdaptiveBatchSizer::AdaptiveBatchSizer(const ReportAggregatorOptions& options)
+    : max_batch_bytes_(options.max_batch_bytes),
+      min_batch_entries_(
+          std::min(options.min_batch_entries, options.max_batch_entries)),
+      max_batch_entries_(options.max_batch_entries),
+      min_batch_time_ms_(
+          std::min(options.min_batch_time_ms, options.max_batch_time_ms)),
+      max_batch_time_ms_(options.max_batch_time_ms),
+      batch_entries_(options.max_batch_entries),
+      batch_time_ms_(options.max_batch_time_ms) {}
+
+void AdaptiveBatchSizer::OnFlush(int entries, size_t bytes, Tick batch_start,
+                                 Tick time_now) {
+  if (entries <= 0) {
+    return;
+  }
+  bytes_per_entry_ =
+      Average(bytes_per_entry_, static_cast<double>(bytes) / entries);
+
+  double elapsed_ms = std::max(
+      1.0, duration<double, std::milli>(time_now - batch_start).count());
+  entries_per_ms_ = Average(entries_per_ms_, entries / elapsed_ms);
+
+  int64_t latency_us = last_latency_us_.exchange(-1);
+  if (latency_us >= 0) {
+    latency_ms_ = Average(latency_ms_, std::max(latency_us / 1000.0, 0.001));
+  }
+
+  Update();
+}
+
+void AdaptiveBatchSizer::OnTransportDone(microseconds latency) {
+  last_latency_us_ = latency.count();
+}
+
+void AdaptiveBatchSizer::Update() {
+  double entries = max_batch_entries_;
+  if (bytes_per_entry_ > 0) {
+    entries = max_batch_bytes_ / bytes_per_entry_;
+  }
+  batch_entries_ = static_cast<int>(std::max<double>(
+      min_batch_entries_, std::min<double>(max_batch_entries_, entries)));
+
+  double time_ms = max_batch_time_ms_;
+  if (latency_ms_ > 0) {
+    time_ms = kLatencyMultiple * latency_ms_;
+  }
+  if (entries_per_ms_ > 0) {
+    time_ms = std::min(time_ms, batch_entries_ / entries_per_ms_);
+  }
+  batch_time_ms_ = static_cast<int>(std::max<double>(
+      min_batch_time_ms_, std::min<double>(max_batch_time_ms_, time_ms)));
+}
+
+}  // namespace mixerclient
+}  // namespace istio
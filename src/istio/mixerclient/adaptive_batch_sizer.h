@@ -0,0 +1,84 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ISTIO_MIXERCLIENT_ADAPTIVE_BATCH_SIZER_H
+#define ISTIO_MIXERCLIENT_ADAPTIVE_BATCH_SIZER_H
+
+#include <atomic>
+#include <chrono>
+
+#include "google/protobuf/stubs/common.h"
+#include "include/istio/mixerclient/options.h"
+
+namespace istio {
+namespace mixerclient {
+
+// Computes the report batch size and flush interval from the observed
+// report arrival rate, serialized batch size and transport latency.
+//
+// The entry limit is the number of reports expected to fit in
+// max_batch_bytes. The flush interval follows the transport latency, so a
+// partially filled batch is not held much longer than one report call
+// takes, and is never longer than filling a batch at the arrival rate.
+// Both are clamped to the bounds in ReportAggregatorOptions.
+//
+// OnFlush() and the getters must be serialized by the caller,
+// OnTransportDone() can be called from any thread.
+class AdaptiveBatchSizer {
+ public:
+  using Tick = std::chrono::time_point<std::chrono::steady_clock>;
+
+  AdaptiveBatchSizer(const ReportAggregatorOptions& options);
+
+  // Called when a batch of `entries` reports and `bytes` serialized bytes is
+  // flushed. `batch_start` is when its first report was added.
+  void OnFlush(int entries, size_t bytes, Tick batch_start, Tick time_now);
+
+  // Called when a report call completed.
+  void OnTransportDone(std::chrono::microseconds latency);
+
+  // Number of reports to flush a batch at.
+  int batch_entries() const { return batch_entries_; }
+
+  // Milliseconds a batch is kept before it is flushed.
+  int batch_time_ms() const { return batch_time_ms_; }
+
+ private:
+  void Update();
+
+  const int max_batch_bytes_;
+  const int min_batch_entries_;
+  const int max_batch_entries_;
+  const int min_batch_time_ms_;
+  const int max_batch_time_ms_;
+
+  // Moving averages, 0 until the first sample.
+  double bytes_per_entry_{0};
+  double entries_per_ms_{0};
+  double latency_ms_{0};
+
+  // The latest transport latency, folded into latency_ms_ by OnFlush().
+  std::atomic<int64_t> last_latency_us_{-1};
+
+  int batch_entries_;
+  int batch_time_ms_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(AdaptiveBatchSizer);
+};
+
+}  // namespace mixerclient
+}  // namespace istio
+
+#endif  // ISTIO_MIXERCLIENT_ADAPTIVE_BATCH_SIZER_H
@@ -0,0 +1,83 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/mixerclient/adaptive_batch_sizer.h"
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono;
+
+namespace istio {
+namespace mixerclient {
+namespace {
+
+class AdaptiveBatchSizerTest : public ::testing::Test {
+ public:
+  AdaptiveBatchSizerTest() : options_(1000, 1000) {
+    options_.max_batch_bytes = 10000;
+    options_.min_batch_entries = 10;
+    options_.min_batch_time_ms = 10;
+    sizer_.reset(new AdaptiveBatchSizer(options_));
+  }
+
+  ReportAggregatorOptions options_;
+  std::unique_ptr<AdaptiveBatchSizer> sizer_;
+  AdaptiveBatchSizer::Tick start_;
+};
+
+TEST_F(AdaptiveBatchSizerTest, TestInitialBounds) {
+  EXPECT_EQ(sizer_->batch_entries(), 1000);
+  EXPECT_EQ(sizer_->batch_time_ms(), 1000);
+}
+
+TEST_F(AdaptiveBatchSizerTest, TestTargetBytes) {
+  // 50 bytes per report, 10 reports per millisecond.
+  sizer_->OnFlush(100, 5000, start_, start_ + milliseconds(10));
+  EXPECT_EQ(sizer_->batch_entries(), 200);
+  // Time to fill 200 reports.
+  EXPECT_EQ(sizer_->batch_time_ms(), 20);
+}
+
+TEST_F(AdaptiveBatchSizerTest, TestLowLoadFollowsLatency) {
+  sizer_->OnTransportDone(milliseconds(5));
+  // A single report in one second.
+  sizer_->OnFlush(1, 50, start_, start_ + seconds(1));
+  EXPECT_EQ(sizer_->batch_entries(), 200);
+  EXPECT_EQ(sizer_->batch_time_ms(), 20);
+
+  // Latency is averaged.
+  sizer_->OnTransportDone(milliseconds(25));
+  sizer_->OnFlush(1, 50, start_, start_ + seconds(1));
+  EXPECT_EQ(sizer_->batch_time_ms(), 40);
+}
+
+TEST_F(AdaptiveBatchSizerTest, TestClampToBounds) {
+  sizer_->OnTransportDone(microseconds(100));
+  // Large reports at a high rate.
+  sizer_->OnFlush(10, 100000, start_, start_);
+  EXPECT_EQ(sizer_->batch_entries(), 10);
+  EXPECT_EQ(sizer_->batch_time_ms(), 10);
+
+  sizer_.reset(new AdaptiveBatchSizer(options_));
+  sizer_->OnTransportDone(seconds(10));
+  // Small reports at a low rate.
+  sizer_->OnFlush(1, 1, start_, start_ + seconds(10));
+  EXPECT_EQ(sizer_->batch_entries(), 1000);
+  EXPECT_EQ(sizer_->batch_time_ms(), 1000);
+}
+
+}  // namespace
+}  // namespace mixerclient
+}  // namespace istio
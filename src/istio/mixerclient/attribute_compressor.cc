@@ -83,46 +83,93 @@ class MessageDictionary {
   return compressed_map;
 }
 
+void CompressAttribute(const std::string& name,
+                       const Attributes_AttributeValue& value,
+                       MessageDictionary& dict, CompressedAttributes* pb) {
+  int index = dict.GetIndex(name);
+
+  // Fill the attribute to proper map.
+  switch (value.value_case()) {
+    case Attributes_AttributeValue::kStringValue:
+      (*pb->mutable_strings())[index] = dict.GetIndex(value.string_value());
+      break;
+    case Attributes_AttributeValue::kBytesValue:
+      (*pb->mutable_bytes())[index] = value.bytes_value();
+      break;
+    case Attributes_AttributeValue::kInt64Value:
+      (*pb->mutable_int64s())[index] = value.int64_value();
+      break;
+    case Attributes_AttributeValue::kDoubleValue:
+      (*pb->mutable_doubles())[index] = value.double_value();
+      break;
+    case Attributes_AttributeValue::kBoolValue:
+      (*pb->mutable_bools())[index] = value.bool_value();
+      break;
+    case Attributes_AttributeValue::kTimestampValue:
+      (*pb->mutable_timestamps())[index] = value.timestamp_value();
+      break;
+    case Attributes_AttributeValue::kDurationValue:
+      (*pb->mutable_durations())[index] = value.duration_value();
+      break;
+    case Attributes_AttributeValue::kStringMapValue:
+      (*pb->mutable_string_maps())[index] =
+          CreateStringMap(value.string_map_value(), dict);
+      break;
+    case Attributes_AttributeValue::VALUE_NOT_SET:
+      break;
+  }
+}
+
 void CompressByDict(const Attributes& attributes, MessageDictionary& dict,
                     CompressedAttributes* pb) {
   // Fill attributes.
   for (const auto& it : attributes.attributes()) {
-    const std::string& name = it.first;
-    const Attributes_AttributeValue& value = it.second;
-
-    int index = dict.GetIndex(name);
-
-    // Fill the attribute to proper map.
-    switch (value.value_case()) {
-      case Attributes_AttributeValue::kStringValue:
-        (*pb->mutable_strings())[index] = dict.GetIndex(value.string_value());
-        break;
-      case Attributes_AttributeValue::kBytesValue:
-        (*pb->mutable_bytes())[index] = value.bytes_value();
-        break;
-      case Attributes_AttributeValue::kInt64Value:
-        (*pb->mutable_int64s())[index] = value.int64_value();
-        break;
-      case Attributes_AttributeValue::kDoubleValue:
-        (*pb->mutable_doubles())[index] = value.double_value();
-        break;
-      case Attributes_AttributeValue::kBoolValue:
-        (*pb->mutable_bools())[index] = value.bool_value();
-        break;
-      case Attributes_AttributeValue::kTimestampValue:
-        (*pb->mutable_timestamps())[index] = value.timestamp_value();
-        break;
-      case Attributes_AttributeValue::kDurationValue:
-        (*pb->mutable_durations())[index] = value.duration_value();
-        break;
-      case Attributes_AttributeValue::kStringMapValue:
-        (*pb->mutable_string_maps())[index] =
-            CreateStringMap(value.string_map_value(), dict);
-        break;
-      case Attributes_AttributeValue::VALUE_NOT_SET:
-        break;
+    CompressAttribute(it.first, it.second, dict, pb);
+  }
+}
+
+bool StringMapEqual(const Attributes_StringMap& a,
+                    const Attributes_StringMap& b) {
+  if (a.entries_size() != b.entries_size()) {
+    return false;
+  }
+  for (const auto& it : a.entries()) {
+    const auto b_it = b.entries().find(it.first);
+    if (b_it == b.entries().end() || b_it->second != it.second) {
+      return false;
     }
   }
+  return true;
+}
+
+bool AttributeValueEqual(const Attributes_AttributeValue& a,
+                         const Attributes_AttributeValue& b) {
+  if (a.value_case() != b.value_case()) {
+    return false;
+  }
+  switch (a.value_case()) {
+    case Attributes_AttributeValue::kStringValue:
+      return a.string_value() == b.string_value();
+    case Attributes_AttributeValue::kBytesValue:
+      return a.bytes_value() == b.bytes_value();
+    case Attributes_AttributeValue::kInt64Value:
+      return a.int64_value() == b.int64_value();
+    case Attributes_AttributeValue::kDoubleValue:
+      return a.double_value() == b.double_value();
+    case Attributes_AttributeValue::kBoolValue:
+      return a.bool_value() == b.bool_value();
+    case Attributes_AttributeValue::kTimestampValue:
+      return a.timestamp_value().seconds() == b.timestamp_value().seconds() &&
+             a.timestamp_value().nanos() == b.timestamp_value().nanos();
+    case Attributes_AttributeValue::kDurationValue:
+      return a.duration_value().seconds() == b.duration_value().seconds() &&
+             a.duration_value().nanos() == b.duration_value().nanos();
+    case Attributes_AttributeValue::kStringMapValue:
+      return StringMapEqual(a.string_map_value(), b.string_map_value());
+    case Attributes_AttributeValue::VALUE_NOT_SET:
+      return true;
+  }
+  return false;
 }
 
 class BatchCompressorImpl : public BatchCompressor {
@@ -130,8 +177,9 @@ class BatchCompressorImpl : public BatchCompressor {
   BatchCompressorImpl(const GlobalDictionary& global_dict)
       : global_dict_(global_dict), dict_(global_dict) {}
 
-  void Add(const Attributes& attributes) override {
+  bool Add(const Attributes& attributes) override {
     CompressByDict(attributes, dict_, report_.add_attributes());
+    return true;
   }
 
   int size() const override { return report_.attributes_size(); }
@@ -158,6 +206,72 @@ class BatchCompressorImpl : public BatchCompressor {
   ::istio::mixer::v1::ReportRequest report_;
 };
 
+// Encode each attribute set with the attributes changed from the previous
+// one, as in ReportRequest DELTA_ENCODING.
+class DeltaBatchCompressorImpl : public BatchCompressor {
+ public:
+  DeltaBatchCompressorImpl(const GlobalDictionary& global_dict)
+      : global_dict_(global_dict), dict_(global_dict) {}
+
+  bool Add(const Attributes& attributes) override {
+    const auto& last = last_.attributes();
+    changed_.clear();
+    int found = 0;
+    for (const auto& it : attributes.attributes()) {
+      const auto last_it = last.find(it.first);
+      if (last_it == last.end()) {
+        changed_.push_back(&it);
+        continue;
+      }
+      ++found;
+      if (!AttributeValueEqual(it.second, last_it->second)) {
+        changed_.push_back(&it);
+      }
+    }
+    if (found != last_.attributes_size()) {
+      // Some attributes of the previous set are removed.
+      return false;
+    }
+
+    CompressedAttributes* pb = report_.add_attributes();
+    auto* last_map = last_.mutable_attributes();
+    for (const auto* it : changed_) {
+      CompressAttribute(it->first, it->second, dict_, pb);
+      (*last_map)[it->first] = it->second;
+    }
+    return true;
+  }
+
+  int size() const override { return report_.attributes_size(); }
+
+  const ::istio::mixer::v1::ReportRequest& Finish() override {
+    for (const std::string& word : dict_.GetWords()) {
+      report_.add_default_words(word);
+    }
+    report_.set_global_word_count(global_dict_.size());
+    report_.set_repeated_attributes_semantics(
+        mixer::v1::ReportRequest_RepeatedAttributesSemantics_DELTA_ENCODING);
+    return report_;
+  }
+
+  void Clear() override {
+    dict_.Clear();
+    report_.Clear();
+    last_.Clear();
+  }
+
+ private:
+  const GlobalDictionary& global_dict_;
+  MessageDictionary dict_;
+  ::istio::mixer::v1::ReportRequest report_;
+  // The attributes as seen by the receiver after the last Add().
+  Attributes last_;
+  // The attributes changed by the current Add(), kept to reuse its memory.
+  std::vector<const google::protobuf::MapPair<std::string,
+                                              Attributes_AttributeValue>*>
+      changed_;
+};
+
 }  // namespace
 
 GlobalDictionary::GlobalDictionary() {
@@ -204,5 +318,11 @@ std::unique_ptr<BatchCompressor> AttributeCompressor::CreateBatchCompressor()
       new BatchCompressorImpl(global_dict_));
 }
 
+std::unique_ptr<BatchCompressor>
+AttributeCompressor::CreateDeltaBatchCompressor() const {
+  return std::unique_ptr<BatchCompressor>(
+      new DeltaBatchCompressorImpl(global_dict_));
+}
+
 }  // namespace mixerclient
 }  // namespace istio
@@ -49,8 +49,10 @@ class BatchCompressor {
  public:
   virtual ~BatchCompressor() {}
 
-  // Add an attribute set to the batch.
-  virtual void Add(const ::istio::mixer::v1::Attributes& attributes) = 0;
+  // Add an attribute set to the batch. Return false if the attribute set can
+  // not be encoded in this batch, the batch should be finished and cleared
+  // before adding it again.
+  virtual bool Add(const ::istio::mixer::v1::Attributes& attributes) = 0;
 
   // Get the batched size.
   virtual int size() const = 0;
@@ -71,6 +73,12 @@ class AttributeCompressor {
   // Create a batch compressor.
   std::unique_ptr<BatchCompressor> CreateBatchCompressor() const;
 
+  // Create a batch compressor using delta encoding, each attribute set only
+  // carries the attributes changed from the previous one. Its Add() returns
+  // false for an attribute set missing an attribute of the previous one,
+  // delta encoding can not remove attributes.
+  std::unique_ptr<BatchCompressor> CreateDeltaBatchCompressor() const;
+
   int global_word_count() const { return global_dict_.size(); }
 
   // Shrink global dictionary to the first version.
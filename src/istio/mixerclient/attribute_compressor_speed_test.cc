@@ -0,0 +1,120 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+
+#include "benchmark/benchmark.h"
+#include "include/istio/utils/attributes_builder.h"
+#include "src/istio/mixerclient/attribute_compressor.h"
+#include "src/istio/mixerclient/attribute_decompressor.h"
+
+using ::istio::mixer::v1::Attributes;
+
+namespace istio {
+namespace mixerclient {
+namespace {
+
+const int kBatchSize = 100;
+
+// Reports as sent by a sidecar serving a few routes of the same service:
+// source, destination and protocol attributes are shared, request specific
+// attributes vary.
+std::vector<Attributes> CreateReports() {
+  std::vector<Attributes> reports;
+  auto now = std::chrono::system_clock::now();
+  for (int i = 0; i < kBatchSize; ++i) {
+    Attributes attributes;
+    utils::AttributesBuilder builder(&attributes);
+    builder.AddString("source.uid", "kubernetes://productpage-v1-84975bc778");
+    builder.AddString("source.namespace", "default");
+    builder.AddBytes("source.ip", std::string("\x0a\x24\x00\x0f", 4));
+    builder.AddString("destination.uid", "kubernetes://reviews-v2-5b7f8c9d4");
+    builder.AddString("destination.namespace", "default");
+    builder.AddString("destination.service.host",
+                      "reviews.default.svc.cluster.local");
+    builder.AddBytes("destination.ip", std::string("\x0a\x24\x00\x12", 4));
+    builder.AddInt64("destination.port", 9080);
+    builder.AddString("context.protocol", "http");
+    builder.AddString("context.reporter.kind", "inbound");
+    builder.AddString("request.method", "GET");
+    builder.AddString("request.scheme", "http");
+    builder.AddString("request.host", "reviews:9080");
+    builder.AddString("request.path", "/reviews/" + std::to_string(i % 5));
+    builder.AddString("request.useragent", "Mozilla/5.0 (X11; Linux x86_64)");
+    builder.AddString("request.id",
+                      "6a8d4f0e-8c4b-9f1b-a5c3-" + std::to_string(100000 + i));
+    builder.AddInt64("request.size", 0);
+    builder.AddInt64("request.total_size", 280 + i % 7);
+    builder.AddTimestamp("request.time", now + std::chrono::milliseconds(i));
+    builder.AddInt64("response.code", i % 20 == 0 ? 503 : 200);
+    builder.AddInt64("response.size", 295);
+    builder.AddInt64("response.total_size", 472);
+    builder.AddTimestamp("response.time",
+                         now + std::chrono::milliseconds(i + 3));
+    builder.AddDuration("response.duration", std::chrono::milliseconds(3));
+    builder.AddStringMap("request.headers",
+                         {{":authority", "reviews:9080"},
+                          {":method", "GET"},
+                          {":path", "/reviews/" + std::to_string(i % 5)},
+                          {"x-request-id", "6a8d4f0e-8c4b-9f1b-a5c3"}});
+    reports.push_back(std::move(attributes));
+  }
+  return reports;
+}
+
+void BM_BatchCompress(benchmark::State& state, bool delta) {
+  AttributeCompressor compressor;
+  auto batch_compressor = delta ? compressor.CreateDeltaBatchCompressor()
+                                : compressor.CreateBatchCompressor();
+  const auto reports = CreateReports();
+
+  size_t bytes = 0;
+  for (auto _ : state) {
+    for (const auto& attributes : reports) {
+      batch_compressor->Add(attributes);
+    }
+    bytes = batch_compressor->Finish().ByteSizeLong();
+    batch_compressor->Clear();
+  }
+  state.counters["serialized_bytes"] = bytes;
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
+void BM_BatchDecompress(benchmark::State& state, bool delta) {
+  AttributeCompressor compressor;
+  auto batch_compressor = delta ? compressor.CreateDeltaBatchCompressor()
+                                : compressor.CreateBatchCompressor();
+  for (const auto& attributes : CreateReports()) {
+    batch_compressor->Add(attributes);
+  }
+  const auto& request = batch_compressor->Finish();
+
+  std::vector<Attributes> decoded;
+  for (auto _ : state) {
+    DecompressReport(request, &decoded);
+  }
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
+BENCHMARK_CAPTURE(BM_BatchCompress, Independent, false);
+BENCHMARK_CAPTURE(BM_BatchCompress, Delta, true);
+BENCHMARK_CAPTURE(BM_BatchDecompress, Independent, false);
+BENCHMARK_CAPTURE(BM_BatchDecompress, Delta, true);
+
+}  // namespace
+}  // namespace mixerclient
+}  // namespace istio
+
+BENCHMARK_MAIN();
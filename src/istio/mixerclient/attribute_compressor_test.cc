@@ -21,6 +21,7 @@
 #include "google/protobuf/util/message_differencer.h"
 #include "gtest/gtest.h"
 #include "include/istio/utils/attributes_builder.h"
+#include "src/istio/mixerclient/attribute_decompressor.h"
 
 using ::istio::mixer::v1::Attributes;
 using ::istio::mixer::v1::Attributes_AttributeValue;
@@ -349,6 +350,82 @@ TEST_F(AttributeCompressorTest, BatchCompressTest) {
   EXPECT_TRUE(MessageDifferencer::Equals(report_pb, expected_report_pb));
 }
 
+TEST_F(AttributeCompressorTest, BatchRoundTripTest) {
+  AttributeCompressor compressor;
+  auto batch_compressor = compressor.CreateBatchCompressor();
+
+  std::vector<Attributes> expected;
+  expected.push_back(attributes_);
+  batch_compressor->Add(attributes_);
+
+  utils::AttributesBuilder builder(&attributes_);
+  builder.AddInt64("response.size", 111);
+  builder.AddString("request.path", "/unknown-word");
+  expected.push_back(attributes_);
+  batch_compressor->Add(attributes_);
+
+  std::vector<Attributes> decoded;
+  ASSERT_TRUE(DecompressReport(batch_compressor->Finish(), &decoded));
+  ASSERT_EQ(decoded.size(), expected.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    EXPECT_TRUE(MessageDifferencer::Equals(decoded[i], expected[i]));
+  }
+}
+
+TEST_F(AttributeCompressorTest, DeltaBatchCompressTest) {
+  AttributeCompressor compressor;
+  auto batch_compressor = compressor.CreateDeltaBatchCompressor();
+
+  std::vector<Attributes> expected;
+  expected.push_back(attributes_);
+  EXPECT_TRUE(batch_compressor->Add(attributes_));
+
+  // The same attributes again, nothing to encode.
+  expected.push_back(attributes_);
+  EXPECT_TRUE(batch_compressor->Add(attributes_));
+
+  // modify some attributes
+  utils::AttributesBuilder builder(&attributes_);
+  builder.AddDouble("range", 123.99);
+  builder.AddInt64("response.size", 111);
+  builder.AddStringMap("request.headers", {{"content-type", "application/json"},
+                                           {":method", "GET"}});
+  expected.push_back(attributes_);
+  EXPECT_TRUE(batch_compressor->Add(attributes_));
+
+  // remove a key, it can not be delta encoded.
+  attributes_.mutable_attributes()->erase("response.size");
+  EXPECT_FALSE(batch_compressor->Add(attributes_));
+  EXPECT_EQ(batch_compressor->size(), 3);
+
+  const auto& report_pb = batch_compressor->Finish();
+  EXPECT_EQ(report_pb.repeated_attributes_semantics(),
+            ::istio::mixer::v1::ReportRequest::DELTA_ENCODING);
+  EXPECT_EQ(report_pb.attributes(1).ByteSizeLong(), 0);
+  // Only the 3 changed attributes are encoded.
+  const auto& delta = report_pb.attributes(2);
+  EXPECT_EQ(delta.doubles_size() + delta.int64s_size() +
+                delta.string_maps_size(),
+            3);
+  EXPECT_EQ(delta.strings_size() + delta.bytes_size() + delta.bools_size() +
+                delta.timestamps_size() + delta.durations_size(),
+            0);
+
+  std::vector<Attributes> decoded;
+  ASSERT_TRUE(DecompressReport(report_pb, &decoded));
+  ASSERT_EQ(decoded.size(), expected.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    EXPECT_TRUE(MessageDifferencer::Equals(decoded[i], expected[i]));
+  }
+
+  // After Clear(), the attribute set with the removed key starts a new batch.
+  batch_compressor->Clear();
+  EXPECT_TRUE(batch_compressor->Add(attributes_));
+  ASSERT_TRUE(DecompressReport(batch_compressor->Finish(), &decoded));
+  ASSERT_EQ(decoded.size(), 1);
+  EXPECT_TRUE(MessageDifferencer::Equals(decoded[0], attributes_));
+}
+
 }  // namespace
 }  // namespace mixerclient
 }  // namespace istio
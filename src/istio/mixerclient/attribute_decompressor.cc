@@ -0,0 +1,153 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/mixerclient/attribute_decompressor.h"
+
+#include "src/istio/mixerclient/global_dictionary.h"
+
+using ::google::protobuf::RepeatedPtrField;
+using ::istio::mixer::v1::Attributes;
+using ::istio::mixer::v1::CompressedAttributes;
+using ::istio::mixer::v1::ReportRequest;
+
+namespace istio {
+namespace mixerclient {
+namespace {
+
+// Lookup words by index, the reverse of MessageDictionary::GetIndex().
+class WordLookup {
+ public:
+  WordLookup(int global_word_count, const RepeatedPtrField<std::string>& words)
+      : global_words_(GetGlobalWords()),
+        global_word_count_(global_word_count),
+        words_(words) {}
+
+  bool Get(int index, std::string* word) const {
+    if (index >= 0) {
+      if (index >= global_word_count_ ||
+          index >= static_cast<int>(global_words_.size())) {
+        return false;
+      }
+      *word = global_words_[index];
+      return true;
+    }
+    int message_index = -index - 1;
+    if (message_index >= words_.size()) {
+      return false;
+    }
+    *word = words_.Get(message_index);
+    return true;
+  }
+
+ private:
+  const std::vector<std::string>& global_words_;
+  int global_word_count_;
+  const RepeatedPtrField<std::string>& words_;
+};
+
+}  // namespace
+
+bool DecompressAttributes(const CompressedAttributes& pb, int global_word_count,
+                          const RepeatedPtrField<std::string>& default_words,
+                          Attributes* attributes) {
+  WordLookup lookup(global_word_count,
+                    pb.words_size() > 0 ? pb.words() : default_words);
+  auto* attributes_map = attributes->mutable_attributes();
+
+  std::string name;
+  for (const auto& it : pb.strings()) {
+    std::string value;
+    if (!lookup.Get(it.first, &name) || !lookup.Get(it.second, &value)) {
+      return false;
+    }
+    (*attributes_map)[name].set_string_value(value);
+  }
+  for (const auto& it : pb.bytes()) {
+    if (!lookup.Get(it.first, &name)) {
+      return false;
+    }
+    (*attributes_map)[name].set_bytes_value(it.second);
+  }
+  for (const auto& it : pb.int64s()) {
+    if (!lookup.Get(it.first, &name)) {
+      return false;
+    }
+    (*attributes_map)[name].set_int64_value(it.second);
+  }
+  for (const auto& it : pb.doubles()) {
+    if (!lookup.Get(it.first, &name)) {
+      return false;
+    }
+    (*attributes_map)[name].set_double_value(it.second);
+  }
+  for (const auto& it : pb.bools()) {
+    if (!lookup.Get(it.first, &name)) {
+      return false;
+    }
+    (*attributes_map)[name].set_bool_value(it.second);
+  }
+  for (const auto& it : pb.timestamps()) {
+    if (!lookup.Get(it.first, &name)) {
+      return false;
+    }
+    *(*attributes_map)[name].mutable_timestamp_value() = it.second;
+  }
+  for (const auto& it : pb.durations()) {
+    if (!lookup.Get(it.first, &name)) {
+      return false;
+    }
+    *(*attributes_map)[name].mutable_duration_value() = it.second;
+  }
+  for (const auto& it : pb.string_maps()) {
+    if (!lookup.Get(it.first, &name)) {
+      return false;
+    }
+    // A string map is replaced as a whole, not merged.
+    auto* entries =
+        (*attributes_map)[name].mutable_string_map_value()->mutable_entries();
+    entries->clear();
+    for (const auto& entry : it.second.entries()) {
+      std::string key, value;
+      if (!lookup.Get(entry.first, &key) || !lookup.Get(entry.second, &value)) {
+        return false;
+      }
+      (*entries)[key] = value;
+    }
+  }
+  return true;
+}
+
+bool DecompressReport(const ReportRequest& request,
+                      std::vector<Attributes>* reports) {
+  const bool delta = request.repeated_attributes_semantics() ==
+                     ReportRequest::DELTA_ENCODING;
+  reports->clear();
+  for (const auto& pb : request.attributes()) {
+    Attributes attributes;
+    if (delta && !reports->empty()) {
+      // Start from the previous attribute set.
+      attributes = reports->back();
+    }
+    if (!DecompressAttributes(pb, request.global_word_count(),
+                              request.default_words(), &attributes)) {
+      return false;
+    }
+    reports->push_back(std::move(attributes));
+  }
+  return true;
+}
+
+}  // namespace mixerclient
+}  // namespace istio
@@ -0,0 +1,44 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ISTIO_MIXERCLIENT_ATTRIBUTE_DECOMPRESSOR_H
+#define ISTIO_MIXERCLIENT_ATTRIBUTE_DECOMPRESSOR_H
+
+#include <vector>
+
+#include "mixer/v1/attributes.pb.h"
+#include "mixer/v1/mixer.pb.h"
+
+namespace istio {
+namespace mixerclient {
+
+// Decode compressed attributes, the reverse of AttributeCompressor.
+// Used by tests and benchmarks to verify the encoding round trip.
+// Return false if a word index is out of range.
+bool DecompressAttributes(
+    const ::istio::mixer::v1::CompressedAttributes& attributes_pb,
+    int global_word_count,
+    const ::google::protobuf::RepeatedPtrField<std::string>& default_words,
+    ::istio::mixer::v1::Attributes* attributes);
+
+// Decode a batched report request, with either INDEPENDENT_ENCODING or
+// DELTA_ENCODING semantics, into one attribute set per report.
+bool DecompressReport(const ::istio::mixer::v1::ReportRequest& request,
+                      std::vector<::istio::mixer::v1::Attributes>* reports);
+
+}  // namespace mixerclient
+}  // namespace istio
+
+#endif  // ISTIO_MIXERCLIENT_ATTRIBUTE_DECOMPRESSOR_H
@@ -29,6 +29,8 @@ namespace mixerclient {
 
 void CheckCache::CacheElem::CacheElem::SetResponse(
     const CheckResponse &response, Tick time_now) {
+  stale_ = false;
+  refreshing_ = false;
   if (response.has_precondition()) {
     status_ = parent_.ConvertRpcStatus(response.precondition().status());
 
@@ -60,6 +62,26 @@ bool CheckCache::CacheElem::CacheElem::IsExpired(Tick time_now) {
   return false;
 }
 
+bool CheckCache::CacheElem::UseStale(Tick time_now, bool *refresh) {
+  const auto max_stale = milliseconds(parent_.options_.max_stale_ms);
+  if (max_stale.count() == 0 || !status_.ok()) {
+    return false;
+  }
+  if (!stale_) {
+    stale_ = true;
+    stale_expire_time_ =
+        (time_now > expire_time_ ? expire_time_ : time_now) + max_stale;
+  }
+  if (time_now > stale_expire_time_) {
+    return false;
+  }
+  if (!refreshing_ && refresh) {
+    refreshing_ = true;
+    *refresh = true;
+  }
+  return true;
+}
+
 CheckCache::CheckResult::CheckResult() : status_(Code::UNAVAILABLE, "") {}
 
 bool CheckCache::CheckResult::IsCacheHit() const {
@@ -83,18 +105,25 @@ void CheckCache::Check(const Attributes &attributes, CheckResult *result) {
     result->status_ = status;
   }
 
-  result->on_response_ = [this](const Status &status,
-                                const Attributes &attributes,
-                                const CheckResponse &response) -> Status {
+  const bool refresh = result->refresh_;
+  const utils::HashType signature = result->signature_;
+  result->on_response_ = [this, refresh, signature](
+                             const Status &status, const Attributes &attributes,
+                             const CheckResponse &response) -> Status {
+    Status converted;
     if (!status.ok()) {
       if (options_.network_fail_open) {
-        return Status::OK;
+        converted = Status::OK;
       } else {
-        return status;
+        converted = status;
       }
     } else {
-      return CacheResponse(attributes, response, system_clock::now());
+      converted = CacheResponse(attributes, response, system_clock::now());
+    }
+    if (refresh) {
+      EndRefresh(signature);
     }
+    return converted;
   };
 }
 
@@ -113,12 +142,19 @@ Status CheckCache::Check(const Attributes &attributes, Tick time_now,
       continue;
     }
 
+    if (result && !result->has_signature_) {
+      result->has_signature_ = true;
+      result->signature_ = signature;
+    }
+
     CheckLRUCache::ScopedLookup lookup(cache_.get(), signature);
     if (lookup.Found()) {
       CacheElem *elem = lookup.value();
       if (elem->IsExpired(time_now)) {
-        cache_->Remove(signature);
-        return Status(Code::NOT_FOUND, "");
+        if (!elem->UseStale(time_now, result ? &result->refresh_ : nullptr)) {
+          cache_->Remove(signature);
+          return Status(Code::NOT_FOUND, "");
+        }
       }
       if (result) {
         result->route_directive_ = elem->route_directive();
@@ -175,6 +211,17 @@ Status CheckCache::CacheResponse(const Attributes &attributes,
   return cache_elem->status();
 }
 
+void CheckCache::EndRefresh(utils::HashType signature) {
+  if (!cache_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  CheckLRUCache::ScopedLookup lookup(cache_.get(), signature);
+  if (lookup.Found()) {
+    lookup.value()->EndRefresh();
+  }
+}
+
 // Flush out aggregated check requests, clear all cache items.
 // Usually called at destructor.
 Status CheckCache::FlushAll() {
@@ -53,12 +53,25 @@ class CheckCache {
 
     bool IsCacheHit() const;
 
+    // True if the cache hit is stale and this request should refresh it.
+    bool IsRefreshRequired() const { return refresh_; }
+
     const ::google::protobuf::util::Status& status() const { return status_; }
 
     const ::istio::mixer::v1::RouteDirective& route_directive() const {
       return route_directive_;
     }
 
+    // On a cache miss, get the cache signature of the request if it matches
+    // known referenced attributes. Requests with the same signature get the
+    // same check response.
+    bool GetSignature(utils::HashType* signature) const {
+      if (has_signature_) {
+        *signature = signature_;
+      }
+      return has_signature_;
+    }
+
     void SetResponse(const ::google::protobuf::util::Status& status,
                      const ::istio::mixer::v1::Attributes& attributes,
                      const ::istio::mixer::v1::CheckResponse& response) {
@@ -78,6 +91,13 @@ class CheckCache {
     // Route directive
     ::istio::mixer::v1::RouteDirective route_directive_;
 
+    // Cache signature of a missed or stale request.
+    bool has_signature_{false};
+    utils::HashType signature_;
+
+    // Set if this request should refresh a stale entry.
+    bool refresh_{false};
+
     // The function to set check response.
     using OnResponseFunc = std::function<::google::protobuf::util::Status(
         const ::google::protobuf::util::Status&,
@@ -105,6 +125,9 @@ class CheckCache {
       const ::istio::mixer::v1::Attributes& attributes,
       const ::istio::mixer::v1::CheckResponse& response, Tick time_now);
 
+  // Allows another refresh of a stale entry.
+  void EndRefresh(utils::HashType signature);
+
   // Flushes out all cached check responses; clears all cache items.
   // Usually called at destructor.
   ::google::protobuf::util::Status FlushAll();
@@ -128,6 +151,12 @@ class CheckCache {
     // Check if the item is expired.
     bool IsExpired(Tick time_now);
 
+    // Check if the expired item can still be used. Sets refresh if this is
+    // the first use since it expired.
+    bool UseStale(Tick time_now, bool* refresh);
+
+    void EndRefresh() { refreshing_ = false; }
+
     // getter for converted status from response.
     ::google::protobuf::util::Status status() const { return status_; }
 
@@ -149,6 +178,11 @@ class CheckCache {
     // if 0, cache item should not be used.
     // use_count is decreased by 1 for each request,
     int use_count_;
+    // Set once the item is expired, the stale item is used until then.
+    bool stale_;
+    std::chrono::time_point<std::chrono::system_clock> stale_expire_time_;
+    // Whether a refresh of the stale item is in flight.
+    bool refreshing_;
   };
 
   // Key is the signature of the Attributes. Value is the CacheElem.
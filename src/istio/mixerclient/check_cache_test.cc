@@ -60,9 +60,11 @@ class CheckCacheTest : public ::testing::Test {
                       cache_->Check(attributes_, FakeTime(0), nullptr));
   }
 
-  Status Check(const Attributes& request, time_point<system_clock> time_now) {
-    return cache_->Check(request, time_now, nullptr);
+  Status Check(const Attributes& request, time_point<system_clock> time_now,
+               CheckCache::CheckResult* result = nullptr) {
+    return cache_->Check(request, time_now, result);
   }
+  void EndRefresh(utils::HashType signature) { cache_->EndRefresh(signature); }
   Status CacheResponse(const Attributes& attributes,
                        const ::istio::mixer::v1::CheckResponse& response,
                        time_point<system_clock> time_now) {
@@ -127,6 +129,72 @@ TEST_F(CheckCacheTest, TestExpiredByDuration) {
   EXPECT_ERROR_CODE(Code::NOT_FOUND, Check(attributes_, FakeTime(11)));
 }
 
+TEST_F(CheckCacheTest, TestStaleWhileRefresh) {
+  CheckOptions options;
+  options.max_stale_ms = 100;
+  cache_ = std::unique_ptr<CheckCache>(new CheckCache(options));
+
+  auto check = [this](int t, bool* refresh) -> Status {
+    CheckCache::CheckResult result;
+    Status status = Check(attributes_, FakeTime(t), &result);
+    *refresh = result.IsRefreshRequired();
+    return status;
+  };
+  bool refresh;
+  EXPECT_ERROR_CODE(Code::NOT_FOUND, check(0, &refresh));
+
+  CheckResponse ok_response;
+  ok_response.mutable_precondition()->set_valid_use_count(1000);
+  // expired in 10 milliseconds.
+  *ok_response.mutable_precondition()->mutable_valid_duration() =
+      utils::CreateDuration(duration_cast<nanoseconds>(milliseconds(10)));
+  EXPECT_OK(CacheResponse(attributes_, ok_response, FakeTime(0)));
+
+  EXPECT_OK(check(5, &refresh));
+  EXPECT_FALSE(refresh);
+
+  // Expired, the first request refreshes the entry.
+  EXPECT_OK(check(20, &refresh));
+  EXPECT_TRUE(refresh);
+  EXPECT_OK(check(30, &refresh));
+  EXPECT_FALSE(refresh);
+
+  // A failed refresh allows another one.
+  utils::HashType signature;
+  CheckCache::CheckResult result;
+  Check(attributes_, FakeTime(40), &result);
+  EXPECT_TRUE(result.GetSignature(&signature));
+  EndRefresh(signature);
+  EXPECT_OK(check(50, &refresh));
+  EXPECT_TRUE(refresh);
+
+  // Refreshed.
+  EXPECT_OK(CacheResponse(attributes_, ok_response, FakeTime(60)));
+  EXPECT_OK(check(65, &refresh));
+  EXPECT_FALSE(refresh);
+  EXPECT_OK(check(75, &refresh));
+  EXPECT_TRUE(refresh);
+
+  // Not used after the maximum staleness.
+  EXPECT_ERROR_CODE(Code::NOT_FOUND, check(171, &refresh));
+}
+
+TEST_F(CheckCacheTest, TestNoStaleDeny) {
+  CheckOptions options;
+  options.max_stale_ms = 100;
+  cache_ = std::unique_ptr<CheckCache>(new CheckCache(options));
+
+  EXPECT_ERROR_CODE(Code::NOT_FOUND, Check(attributes_, FakeTime(0)));
+  CheckResponse deny_response;
+  deny_response.mutable_precondition()->set_valid_use_count(1);
+  deny_response.mutable_precondition()->mutable_status()->set_code(
+      Code::PERMISSION_DENIED);
+  EXPECT_ERROR_CODE(Code::PERMISSION_DENIED,
+                    CacheResponse(attributes_, deny_response, FakeTime(0)));
+  EXPECT_ERROR_CODE(Code::PERMISSION_DENIED, Check(attributes_, FakeTime(1)));
+  EXPECT_ERROR_CODE(Code::NOT_FOUND, Check(attributes_, FakeTime(2)));
+}
+
 TEST_F(CheckCacheTest, TestCheckResult) {
   CheckCache::CheckResult result;
   cache_->Check(attributes_, &result);
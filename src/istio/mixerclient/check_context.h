@@ -79,6 +79,27 @@ class CheckContext : public CheckResponseInfo {
                                      response);
   }
 
+  bool policyCacheSignature(utils::HashType* signature) const {
+    return policy_cache_result_.GetSignature(signature);
+  }
+
+  bool policyCacheRefreshRequired() const {
+    return policy_cache_result_.IsRefreshRequired();
+  }
+
+  // Take over the policy cache update of other, either for its cache miss or
+  // to refresh the stale entry it hit.
+  void takePolicyCacheUpdate(const CheckContext& other) {
+    policy_cache_result_ = other.policy_cache_result_;
+  }
+
+  // Complete this check with the result of a remote check it was coalesced
+  // with.
+  void setCoalescedResult(const CheckContext& other) {
+    policy_cache_result_ = other.policy_cache_result_;
+    setFinalStatus(other.status());
+  }
+
   //
   // Quota Cache Checks
   //
@@ -142,6 +163,11 @@ class CheckContext : public CheckResponseInfo {
     return response_;
   }
 
+  // The response of the remote check call, nullptr if none was made.
+  const istio::mixer::v1::CheckResponse* remoteResponse() const {
+    return response_;
+  }
+
   void setFinalStatus(const google::protobuf::util::Status& status,
                       bool add_report_attributes = true) {
     if (add_report_attributes) {
@@ -36,17 +36,40 @@ using ::istio::mixerclient::SharedAttributesSharedPtr;
 
 namespace istio {
 namespace mixerclient {
+namespace {
+
+// Fill the report counters from either ReportBatch or ReportAggregator.
+template <class Reporter>
+void GetReportStatistics(const Reporter &reporter, Statistics *stat) {
+  stat->total_report_calls_ = reporter.total_report_calls();
+  stat->total_remote_report_calls_ = reporter.total_remote_report_calls();
+  stat->total_remote_report_successes_ =
+      reporter.total_remote_report_successes();
+  stat->total_remote_report_timeouts_ = reporter.total_remote_report_timeouts();
+  stat->total_remote_report_send_errors_ =
+      reporter.total_remote_report_send_errors();
+  stat->total_remote_report_other_errors_ =
+      reporter.total_remote_report_other_errors();
+}
+
+}  // namespace
 
 MixerClientImpl::MixerClientImpl(const MixerClientOptions &options)
     : options_(options) {
   timer_create_ = options.env.timer_create_func;
   check_cache_ =
       std::unique_ptr<CheckCache>(new CheckCache(options.check_options));
-  report_batch_ = std::shared_ptr<ReportBatch>(
-      new ReportBatch(options.report_options, options_.env.report_transport,
-                      timer_create_, compressor_));
-  quota_cache_ =
-      std::unique_ptr<QuotaCache>(new QuotaCache(options.quota_options));
+  report_aggregator_ = options.env.report_aggregator;
+  if (report_aggregator_) {
+    report_producer_ = report_aggregator_->CreateProducer(
+        options_.env.report_transport, options_.env.post_func);
+  } else {
+    report_batch_ = std::shared_ptr<ReportBatch>(
+        new ReportBatch(options.report_options, options_.env.report_transport,
+                        timer_create_, compressor_));
+  }
+  quota_cache_ = std::unique_ptr<QuotaCache>(
+      new QuotaCache(options.quota_options, options.env.quota_pool));
 
   if (options_.env.uuid_generate_func) {
     deduplication_id_base_ = options_.env.uuid_generate_func();
@@ -54,6 +77,9 @@ MixerClientImpl::MixerClientImpl(const MixerClientOptions &options)
 }
 
 MixerClientImpl::~MixerClientImpl() {
+  if (report_producer_) {
+    report_aggregator_->RemoveProducer(report_producer_);
+  }
   if (report_batch_) {
     report_batch_->Flush();
     report_batch_.reset();
@@ -86,6 +112,10 @@ void MixerClientImpl::Check(CheckContextSharedPtr &context,
               context->policyCacheHit() ? "true" : "false",
               context->policyStatus().ToString().c_str());
 
+  if (context->policyCacheRefreshRequired()) {
+    RefreshPolicyCache(*context);
+  }
+
   if (context->policyCacheHit()) {
     ++total_check_cache_hits_;
 
@@ -151,6 +181,14 @@ void MixerClientImpl::Check(CheckContextSharedPtr &context,
     }
   }
 
+  utils::HashType signature;
+  if (options_.check_options.coalesce_checks && !context->policyCacheHit() &&
+      !context->quotaCheckRequired() &&
+      context->policyCacheSignature(&signature)) {
+    CoalesceCheck(context, signature, on_done);
+    return;
+  }
+
   // TODO(jblatt) mjog thinks this is a big CPU hog.  Look into it.
   context->compressRequest(
       compressor_,
@@ -178,6 +216,135 @@ void MixerClientImpl::Check(CheckContextSharedPtr &context,
               remote_quota_prefetch ? nullptr : on_done);
 }
 
+CheckContextSharedPtr MixerClientImpl::CopyCheckContext(
+    const CheckContext &context) {
+  SharedAttributesSharedPtr attributes{new SharedAttributes()};
+  *attributes->attributes() = *context.attributes();
+  auto copy = std::make_shared<CheckContext>(
+      options_.check_options.retries, context.networkFailOpen(), attributes);
+  copy->takePolicyCacheUpdate(context);
+  copy->compressRequest(
+      compressor_,
+      deduplication_id_base_ + std::to_string(deduplication_id_.fetch_add(1)));
+  return copy;
+}
+
+void MixerClientImpl::RefreshPolicyCache(const CheckContext &context) {
+  CheckContextSharedPtr refresh_context = CopyCheckContext(context);
+
+  ++total_check_cache_refreshes_;
+  ++total_remote_calls_;
+  ++total_remote_check_calls_;
+
+  // The refresh outlives the request, it does not use its transport.
+  RemoteCheck(refresh_context, options_.env.check_transport, nullptr);
+}
+
+void MixerClientImpl::CoalesceCheck(CheckContextSharedPtr context,
+                                    utils::HashType signature,
+                                    const CheckDoneFunc &on_done) {
+  std::shared_ptr<CoalescedCheck> coalesced;
+  bool send = false;
+  {
+    std::lock_guard<std::mutex> lock(coalesced_checks_mutex_);
+    auto &entry = coalesced_checks_[signature];
+    if (!entry) {
+      //
+      // The remote check is made with its own context, so it outlives the
+      // cancellation of the check that started it as long as others wait.
+      //
+      entry = std::make_shared<CoalescedCheck>();
+      entry->context = CopyCheckContext(*context);
+      send = true;
+    }
+    coalesced = entry;
+    coalesced->waiters.emplace_back(context, on_done);
+  }
+
+  std::weak_ptr<CoalescedCheck> weak_coalesced = coalesced;
+  const CheckContext *waiter = context.get();
+  context->setCancel([this, signature, weak_coalesced, waiter]() {
+    CancelCoalescedCheck(signature, weak_coalesced, waiter);
+  });
+
+  if (!send) {
+    ++total_coalesced_check_calls_;
+    return;
+  }
+
+  ++total_remote_calls_;
+  ++total_remote_check_calls_;
+
+  //
+  // The shared check may outlive the request that started it, it is sent with
+  // the environment transport rather than the per-request one, which refers
+  // to the request's tracing span.
+  //
+  RemoteCheck(coalesced->context, options_.env.check_transport,
+              [this, signature, weak_coalesced](const CheckResponseInfo &) {
+                CompleteCoalescedCheck(signature, weak_coalesced);
+              });
+}
+
+void MixerClientImpl::CompleteCoalescedCheck(
+    utils::HashType signature, std::weak_ptr<CoalescedCheck> weak_coalesced) {
+  auto coalesced = weak_coalesced.lock();
+  if (!coalesced) {
+    return;
+  }
+
+  std::vector<std::pair<CheckContextSharedPtr, CheckDoneFunc>> waiters;
+  {
+    std::lock_guard<std::mutex> lock(coalesced_checks_mutex_);
+    auto it = coalesced_checks_.find(signature);
+    if (it != coalesced_checks_.end() && it->second == coalesced) {
+      coalesced_checks_.erase(it);
+    }
+    waiters.swap(coalesced->waiters);
+  }
+
+  for (const auto &waiter : waiters) {
+    waiter.first->resetCancel();
+    waiter.first->setCoalescedResult(*coalesced->context);
+    if (waiter.second) {
+      waiter.second(*waiter.first);
+    }
+  }
+}
+
+void MixerClientImpl::CancelCoalescedCheck(
+    utils::HashType signature, std::weak_ptr<CoalescedCheck> weak_coalesced,
+    const CheckContext *context) {
+  CheckContextSharedPtr remote_context;
+  {
+    std::lock_guard<std::mutex> lock(coalesced_checks_mutex_);
+    auto coalesced = weak_coalesced.lock();
+    if (!coalesced) {
+      return;
+    }
+
+    auto &waiters = coalesced->waiters;
+    waiters.erase(
+        std::remove_if(waiters.begin(), waiters.end(),
+                       [context](const std::pair<CheckContextSharedPtr,
+                                                 CheckDoneFunc> &waiter) {
+                         return waiter.first.get() == context;
+                       }),
+        waiters.end());
+    if (!waiters.empty()) {
+      return;
+    }
+
+    auto it = coalesced_checks_.find(signature);
+    if (it != coalesced_checks_.end() && it->second == coalesced) {
+      coalesced_checks_.erase(it);
+    }
+    remote_context = coalesced->context;
+  }
+
+  remote_context->cancel();
+}
+
 void MixerClientImpl::RemoteCheck(CheckContextSharedPtr context,
                                   const TransportCheckFunc &transport,
                                   const CheckDoneFunc &on_done) {
@@ -307,7 +474,11 @@ void MixerClientImpl::RemoteCheck(CheckContextSharedPtr context,
 }
 
 void MixerClientImpl::Report(const SharedAttributesSharedPtr &attributes) {
-  report_batch_->Report(attributes);
+  if (report_producer_) {
+    report_producer_->Report(attributes);
+  } else {
+    report_batch_->Report(attributes);
+  }
 }
 
 void MixerClientImpl::GetStatistics(Statistics *stat) const {
@@ -319,6 +490,8 @@ void MixerClientImpl::GetStatistics(Statistics *stat) const {
   stat->total_remote_check_calls_ = total_remote_check_calls_;
   stat->total_remote_check_accepts_ = total_remote_check_accepts_;
   stat->total_remote_check_denies_ = total_remote_check_denies_;
+  stat->total_coalesced_check_calls_ = total_coalesced_check_calls_;
+  stat->total_check_cache_refreshes_ = total_check_cache_refreshes_;
   stat->total_quota_calls_ = total_quota_calls_;
   stat->total_quota_cache_hits_ = total_quota_cache_hits_;
   stat->total_quota_cache_misses_ = total_quota_cache_misses_;
@@ -336,16 +509,12 @@ void MixerClientImpl::GetStatistics(Statistics *stat) const {
   stat->total_remote_call_retries_ = total_remote_call_retries_;
   stat->total_remote_call_cancellations_ = total_remote_call_cancellations_;
 
-  stat->total_report_calls_ = report_batch_->total_report_calls();
-  stat->total_remote_report_calls_ = report_batch_->total_remote_report_calls();
-  stat->total_remote_report_successes_ =
-      report_batch_->total_remote_report_successes();
-  stat->total_remote_report_timeouts_ =
-      report_batch_->total_remote_report_timeouts();
-  stat->total_remote_report_send_errors_ =
-      report_batch_->total_remote_report_send_errors();
-  stat->total_remote_report_other_errors_ =
-      report_batch_->total_remote_report_other_errors();
+  if (report_producer_) {
+    GetReportStatistics(*report_producer_, stat);
+    stat->total_report_drops_ = report_producer_->total_report_drops();
+  } else {
+    GetReportStatistics(*report_batch_, stat);
+  }
 }
 
 // Creates a MixerClient object.
@@ -17,12 +17,16 @@
 #define ISTIO_MIXERCLIENT_CLIENT_IMPL_H
 
 #include <atomic>
+#include <mutex>
 #include <random>
+#include <unordered_map>
+#include <vector>
 
 #include "include/istio/mixerclient/client.h"
 #include "src/istio/mixerclient/attribute_compressor.h"
 #include "src/istio/mixerclient/check_cache.h"
 #include "src/istio/mixerclient/quota_cache.h"
+#include "src/istio/mixerclient/report_aggregator.h"
 #include "src/istio/mixerclient/report_batch.h"
 
 using ::istio::mixerclient::CheckContextSharedPtr;
@@ -52,6 +56,36 @@ class MixerClientImpl : public MixerClient {
                    const TransportCheckFunc& transport,
                    const CheckDoneFunc& on_done);
 
+  // Refresh the stale policy cache entry hit by context in the background,
+  // with the environment check transport.
+  void RefreshPolicyCache(const CheckContext& context);
+
+  // Create the context of a remote check made on behalf of context, with
+  // the compressed request.
+  CheckContextSharedPtr CopyCheckContext(const CheckContext& context);
+
+  // A remote check shared by all checks with the same cache signature.
+  struct CoalescedCheck {
+    // The context the remote check is made with.
+    CheckContextSharedPtr context;
+    // The checks waiting for the result.
+    std::vector<std::pair<CheckContextSharedPtr, CheckDoneFunc>> waiters;
+  };
+
+  // Wait for an in-flight remote check of the same signature, or start one
+  // with the environment check transport.
+  void CoalesceCheck(CheckContextSharedPtr context, utils::HashType signature,
+                     const CheckDoneFunc& on_done);
+
+  // Complete all the waiters with the result of the remote check.
+  void CompleteCoalescedCheck(utils::HashType signature,
+                              std::weak_ptr<CoalescedCheck> weak_coalesced);
+
+  // Remove a cancelled waiter, the remote check is cancelled with the last.
+  void CancelCoalescedCheck(utils::HashType signature,
+                            std::weak_ptr<CoalescedCheck> weak_coalesced,
+                            const CheckContext* context);
+
   uint32_t RetryDelay(uint32_t retry_attempt);
 
   // Store the options
@@ -66,9 +100,18 @@ class MixerClientImpl : public MixerClient {
   std::unique_ptr<CheckCache> check_cache_;
   // Report batch.
   std::shared_ptr<ReportBatch> report_batch_;
+  // Shared report aggregator, replaces report_batch_ if set.
+  std::shared_ptr<ReportAggregator> report_aggregator_;
+  // This client's handle to report_aggregator_.
+  ReportAggregator::ProducerSharedPtr report_producer_;
   // Cache for Quota call.
   std::unique_ptr<QuotaCache> quota_cache_;
 
+  // In-flight remote checks keyed by cache signature.
+  std::mutex coalesced_checks_mutex_;
+  std::unordered_map<utils::HashType, std::shared_ptr<CoalescedCheck>>
+      coalesced_checks_;
+
   // RNG for retry jitter
   std::default_random_engine rand_;
 
@@ -81,7 +124,8 @@ class MixerClientImpl : public MixerClient {
   //
   // total_check_calls = total_check_hits + total_check_misses
   // total_check_hits = total_check_hit_accepts + total_check_hit_denies
-  // total_remote_check_calls = total_check_misses
+  // total_check_misses + total_check_cache_refreshes =
+  // total_remote_check_calls + total_coalesced_check_calls
   // total_remote_check_calls >= total_remote_check_accepts +
   // total_remote_check_denies
   //    ^ Transport errors are responsible for the >=
@@ -95,6 +139,8 @@ class MixerClientImpl : public MixerClient {
   std::atomic<uint64_t> total_remote_check_calls_{0};       // 1.0
   std::atomic<uint64_t> total_remote_check_accepts_{0};     // 1.1
   std::atomic<uint64_t> total_remote_check_denies_{0};      // 1.1
+  std::atomic<uint64_t> total_coalesced_check_calls_{0};
+  std::atomic<uint64_t> total_check_cache_refreshes_{0};
 
   //
   // Quota check counters
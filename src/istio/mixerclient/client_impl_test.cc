@@ -18,6 +18,7 @@
 #include "include/istio/mixerclient/check_response.h"
 #include "include/istio/mixerclient/client.h"
 #include "include/istio/utils/attributes_builder.h"
+#include "src/istio/mixerclient/report_aggregator.h"
 #include "src/istio/mixerclient/status_test_util.h"
 #include "src/istio/utils/logger.h"
 
@@ -26,6 +27,8 @@ using ::google::protobuf::util::error::Code;
 using ::istio::mixer::v1::Attributes;
 using ::istio::mixer::v1::CheckRequest;
 using ::istio::mixer::v1::CheckResponse;
+using ::istio::mixer::v1::ReportRequest;
+using ::istio::mixer::v1::ReportResponse;
 using ::istio::mixerclient::CheckContextSharedPtr;
 using ::istio::mixerclient::CheckResponseInfo;
 using ::istio::quota_config::Requirement;
@@ -68,13 +71,22 @@ class MixerClientImplTest : public ::testing::Test {
     client_ = CreateMixerClient(options);
   }
 
+  // Create a client with caches and the given environment check transport.
+  void CreateClient(const TransportCheckFunc& check_transport) {
+    MixerClientOptions options(CheckOptions(1), ReportOptions(1, 1000),
+                               QuotaOptions(0, 600000));
+    options.env.check_transport = check_transport;
+    client_ = CreateMixerClient(options);
+  }
+
   void CheckStatisticsInvariants(const Statistics& stats) {
     //
     // Policy check counters.
     //
     // total_check_calls = total_check_hits + total_check_misses
     // total_check_hits = total_check_hit_accepts + total_check_hit_denies
-    // total_remote_check_calls = total_check_misses
+    // total_check_misses + total_check_cache_refreshes =
+    // total_remote_check_calls + total_coalesced_check_calls
     // total_remote_check_calls >= total_remote_check_accepts +
     // total_remote_check_denies
     //    ^ Transport errors are responsible for the >=
@@ -85,7 +97,9 @@ class MixerClientImplTest : public ::testing::Test {
     EXPECT_EQ(stats.total_check_cache_hits_,
               stats.total_check_cache_hit_accepts_ +
                   stats.total_check_cache_hit_denies_);
-    EXPECT_EQ(stats.total_remote_check_calls_, stats.total_check_cache_misses_);
+    EXPECT_EQ(
+        stats.total_check_cache_misses_ + stats.total_check_cache_refreshes_,
+        stats.total_remote_check_calls_ + stats.total_coalesced_check_calls_);
     EXPECT_GE(
         stats.total_remote_check_calls_,
         stats.total_remote_check_accepts_ + stats.total_remote_check_denies_);
@@ -564,6 +578,191 @@ TEST_F(MixerClientImplTest, TestUnavailableQuotaBackend) {
   }
 }
 
+// A check transport holding the callbacks until the test completes them.
+class PendingCheckTransport {
+ public:
+  TransportCheckFunc GetFunc() {
+    return [this](const CheckRequest& request, CheckResponse* response,
+                  DoneFunc on_done) -> CancelFunc {
+      responses_.push_back(response);
+      on_dones_.push_back(on_done);
+      return [this]() { ++cancels_; };
+    };
+  }
+
+  // Complete the oldest call with a response which is never used from cache.
+  void Complete() {
+    responses_.front()->mutable_precondition()->set_valid_use_count(0);
+    auto on_done = on_dones_.front();
+    responses_.erase(responses_.begin());
+    on_dones_.erase(on_dones_.begin());
+    on_done(Status::OK);
+  }
+
+  std::vector<CheckResponse*> responses_;
+  std::vector<DoneFunc> on_dones_;
+  int cancels_{0};
+};
+
+TEST_F(MixerClientImplTest, TestCoalescedCheck) {
+  PendingCheckTransport transport;
+  CreateClient(transport.GetFunc());
+  PendingCheckTransport request_transport;
+  int done = 0;
+  auto on_done = [&done](const CheckResponseInfo& info) {
+    EXPECT_TRUE(info.status().ok());
+    ++done;
+  };
+
+  // Nothing is known about the referenced attributes before the first
+  // response, checks are not coalesced.
+  CheckContextSharedPtr first = CreateContext(0);
+  client_->Check(first, request_transport.GetFunc(), on_done);
+  EXPECT_EQ(request_transport.on_dones_.size(), 1);
+  request_transport.Complete();
+  EXPECT_EQ(done, 1);
+
+  std::vector<CheckContextSharedPtr> contexts;
+  for (int i = 0; i < 3; ++i) {
+    contexts.push_back(CreateContext(0));
+    client_->Check(contexts.back(), request_transport.GetFunc(), on_done);
+  }
+  // One remote check for all, not made with any request's transport.
+  EXPECT_EQ(transport.on_dones_.size(), 1);
+  EXPECT_EQ(request_transport.on_dones_.size(), 0);
+  EXPECT_EQ(done, 1);
+  transport.Complete();
+  EXPECT_EQ(done, 4);
+
+  Statistics stat;
+  client_->GetStatistics(&stat);
+  CheckStatisticsInvariants(stat);
+  EXPECT_EQ(stat.total_check_calls_, 4);
+  EXPECT_EQ(stat.total_check_cache_misses_, 4);
+  EXPECT_EQ(stat.total_remote_check_calls_, 2);
+  EXPECT_EQ(stat.total_coalesced_check_calls_, 2);
+  EXPECT_EQ(stat.total_remote_calls_, 2);
+}
+
+TEST_F(MixerClientImplTest, TestCoalescedCheckCancel) {
+  PendingCheckTransport transport;
+  CreateClient(transport.GetFunc());
+  PendingCheckTransport request_transport;
+  int done = 0;
+  auto on_done = [&done](const CheckResponseInfo& info) { ++done; };
+
+  CheckContextSharedPtr first = CreateContext(0);
+  client_->Check(first, request_transport.GetFunc(), on_done);
+  request_transport.Complete();
+  done = 0;
+
+  CheckContextSharedPtr context1 = CreateContext(0);
+  CheckContextSharedPtr context2 = CreateContext(0);
+  client_->Check(context1, request_transport.GetFunc(), on_done);
+  client_->Check(context2, request_transport.GetFunc(), on_done);
+  EXPECT_EQ(transport.on_dones_.size(), 1);
+
+  // The remote check is kept for the other waiter.
+  context1->cancel();
+  EXPECT_EQ(transport.cancels_, 0);
+  transport.Complete();
+  EXPECT_EQ(done, 1);
+
+  // The remote check is cancelled with its last waiter.
+  CheckContextSharedPtr context3 = CreateContext(0);
+  CheckContextSharedPtr context4 = CreateContext(0);
+  client_->Check(context3, request_transport.GetFunc(), on_done);
+  client_->Check(context4, request_transport.GetFunc(), on_done);
+  context3->cancel();
+  context4->cancel();
+  EXPECT_EQ(transport.cancels_, 1);
+  EXPECT_EQ(done, 1);
+
+  // A new remote check is made after the cancellation.
+  CheckContextSharedPtr context5 = CreateContext(0);
+  client_->Check(context5, request_transport.GetFunc(), on_done);
+  EXPECT_EQ(transport.on_dones_.size(), 2);
+  EXPECT_EQ(request_transport.on_dones_.size(), 0);
+}
+
+TEST_F(MixerClientImplTest, TestStaleCheckRefresh) {
+  MixerClientOptions options(CheckOptions(1), ReportOptions(1, 1000),
+                             QuotaOptions(0, 600000));
+  options.check_options.max_stale_ms = 600000;
+  PendingCheckTransport transport;
+  options.env.check_transport = transport.GetFunc();
+  client_ = CreateMixerClient(options);
+
+  PendingCheckTransport request_transport;
+  int done = 0;
+  auto on_done = [&done](const CheckResponseInfo& info) {
+    EXPECT_TRUE(info.status().ok());
+    ++done;
+  };
+
+  // valid_use_count = 0, the cached response is stale right away.
+  CheckContextSharedPtr first = CreateContext(0);
+  client_->Check(first, request_transport.GetFunc(), on_done);
+  request_transport.Complete();
+  EXPECT_EQ(done, 1);
+
+  // The stale response is used, only the first check refreshes it. The
+  // refresh does not use the transport of the request.
+  for (int i = 0; i < 3; ++i) {
+    CheckContextSharedPtr context = CreateContext(0);
+    client_->Check(context, request_transport.GetFunc(), on_done);
+  }
+  EXPECT_EQ(done, 4);
+  EXPECT_EQ(transport.on_dones_.size(), 1);
+  EXPECT_EQ(request_transport.on_dones_.size(), 0);
+
+  // Once refreshed, the next check refreshes again.
+  transport.Complete();
+  CheckContextSharedPtr context = CreateContext(0);
+  client_->Check(context, request_transport.GetFunc(), on_done);
+  EXPECT_EQ(done, 5);
+  EXPECT_EQ(transport.on_dones_.size(), 1);
+  transport.Complete();
+  EXPECT_EQ(done, 5);
+
+  Statistics stat;
+  client_->GetStatistics(&stat);
+  CheckStatisticsInvariants(stat);
+  EXPECT_EQ(stat.total_check_calls_, 5);
+  EXPECT_EQ(stat.total_check_cache_hits_, 4);
+  EXPECT_EQ(stat.total_check_cache_refreshes_, 2);
+  EXPECT_EQ(stat.total_remote_check_calls_, 3);
+}
+
+TEST_F(MixerClientImplTest, TestQueuedReportsSentOnDestroy) {
+  MixerClientOptions options(CheckOptions(0), ReportOptions(100, 1000),
+                             QuotaOptions(0, 600000));
+  int report_entries = 0;
+  options.env.report_transport = [&](const ReportRequest& request,
+                                     ReportResponse* response,
+                                     DoneFunc on_done) -> CancelFunc {
+    report_entries += request.attributes_size();
+    on_done(Status::OK);
+    return nullptr;
+  };
+  options.env.post_func = [](std::function<void()> fn) { fn(); };
+  // The aggregator thread is not started, the reports stay queued.
+  options.env.report_aggregator = std::make_shared<ReportAggregator>(
+      ReportAggregatorOptions(100, 1000));
+  client_ = CreateMixerClient(options);
+
+  for (int i = 0; i < 3; ++i) {
+    SharedAttributesSharedPtr attributes{new SharedAttributes()};
+    utils::AttributesBuilder(attributes->attributes())
+        .AddInt64("request.size", i);
+    client_->Report(attributes);
+  }
+  EXPECT_EQ(report_entries, 0);
+
+  client_.reset();
+  EXPECT_EQ(report_entries, 3);
+}
+
 }  // namespace
 }  // namespace mixerclient
 }  // namespace istio
@@ -32,19 +32,21 @@ namespace istio {
 namespace mixerclient {
 
 QuotaCache::CacheElem::CacheElem(const std::string& name) : name_(name) {
+  // Allocation calls are made with the per-call transport in Quota().
   prefetch_ = QuotaPrefetch::Create(
-      [this](int amount, QuotaPrefetch::DoneFunc fn, QuotaPrefetch::Tick t) {
-        Alloc(amount, fn);
-      },
+      [](int, QuotaPrefetch::DoneFunc, QuotaPrefetch::Tick) {},
       QuotaPrefetch::Options(), system_clock::now());
 }
 
-void QuotaCache::CacheElem::Alloc(int amount, QuotaPrefetch::DoneFunc fn) {
-  quota_->amount = amount;
-  quota_->best_effort = true;
-  quota_->response_func =
-      [fn](const Attributes&,
-           const CheckResponse::QuotaResult* result) -> bool {
+void QuotaCache::CacheElem::Alloc(
+    int amount, QuotaPrefetch::DoneFunc fn,
+    const std::shared_ptr<QuotaPrefetch>& prefetch,
+    CheckResult::Quota* quota) {
+  quota->amount = amount;
+  quota->best_effort = true;
+  quota->response_func =
+      [fn, prefetch](const Attributes&,
+                     const CheckResponse::QuotaResult* result) -> bool {
     int amount = -1;
     milliseconds expire = duration_cast<milliseconds>(minutes(1));
     if (result != nullptr) {
@@ -59,16 +61,29 @@ void QuotaCache::CacheElem::Alloc(int amount, QuotaPrefetch::DoneFunc fn) {
 }
 
 void QuotaCache::CacheElem::Quota(int amount, CheckResult::Quota* quota) {
-  quota_ = quota;
-  if (prefetch_->Check(amount, system_clock::now())) {
+  // The prefetch code calls the transport within the Check() call.
+  auto prefetch = prefetch_;
+  if (prefetch_->Check(
+          amount,
+          [prefetch, quota](int amount, QuotaPrefetch::DoneFunc fn,
+                            QuotaPrefetch::Tick) {
+            Alloc(amount, fn, prefetch, quota);
+          },
+          system_clock::now())) {
     quota->result = CheckResult::Quota::Passed;
   } else {
     quota->result = CheckResult::Quota::Rejected;
   }
+}
 
-  // A hack that requires prefetch code to call transport Alloc() function
-  // within Check() call.
-  quota_ = nullptr;
+void QuotaCache::CacheElem::Share(QuotaPool* pool, utils::HashType signature) {
+  auto shared = pool->Share(signature, prefetch_);
+  if (shared != prefetch_) {
+    // Keep the amounts granted to the replaced object, including the one
+    // of the response being set.
+    prefetch_->MergeInto(shared, system_clock::now());
+    prefetch_ = shared;
+  }
 }
 
 QuotaCache::CheckResult::CheckResult() : status_(Code::UNAVAILABLE, "") {}
@@ -143,7 +158,9 @@ void QuotaCache::CheckResult::SetResponse(const Status& status,
   }
 }
 
-QuotaCache::QuotaCache(const QuotaOptions& options) : options_(options) {
+QuotaCache::QuotaCache(const QuotaOptions& options,
+                       std::shared_ptr<QuotaPool> pool)
+    : options_(options), pool_(pool) {
   if (options.num_entries > 0) {
     cache_.reset(new QuotaLRUCache(options.num_entries));
     cache_->SetMaxIdleSeconds(options.expiration_ms / 1000.0);
@@ -246,6 +263,9 @@ void QuotaCache::SetResponse(const Attributes& attributes,
                 quota_name.c_str(), referenced.DebugString().c_str());
   }
 
+  if (pool_ && quota_ref.pending_item) {
+    quota_ref.pending_item->Share(pool_.get(), signature);
+  }
   cache_->Insert(signature, quota_ref.pending_item.release(), 1);
 }
 
@@ -28,6 +28,7 @@
 #include "include/istio/quota_config/requirement.h"
 #include "include/istio/utils/simple_lru_cache.h"
 #include "include/istio/utils/simple_lru_cache_inl.h"
+#include "src/istio/mixerclient/quota_pool.h"
 #include "src/istio/mixerclient/referenced.h"
 
 namespace istio {
@@ -37,7 +38,10 @@ namespace mixerclient {
 // This interface is thread safe.
 class QuotaCache {
  public:
-  QuotaCache(const QuotaOptions& options);
+  // If the pool is set, prefetched amounts are shared with the quota caches
+  // of other clients through it.
+  QuotaCache(const QuotaOptions& options,
+             std::shared_ptr<QuotaPool> pool = nullptr);
 
   virtual ~QuotaCache();
 
@@ -119,20 +123,24 @@ class QuotaCache {
     // Use the prefetch object to check the quota.
     void Quota(int amount, CheckResult::Quota* quota);
 
+    // Use the prefetch object in the pool for the signature if there is one,
+    // otherwise add this one to the pool.
+    void Share(QuotaPool* pool, utils::HashType signature);
+
     // The quota name.
     const std::string& quota_name() const { return name_; }
 
    private:
-    // The quota allocation call.
-    void Alloc(int amount, prefetch::QuotaPrefetch::DoneFunc fn);
+    // The quota allocation call for the pending quota result. The response
+    // function holds the prefetch object until the response is set.
+    static void Alloc(int amount, prefetch::QuotaPrefetch::DoneFunc fn,
+                      const std::shared_ptr<prefetch::QuotaPrefetch>& prefetch,
+                      CheckResult::Quota* quota);
 
     std::string name_;
 
-    // A temporary pending quota result.
-    CheckResult::Quota* quota_;
-
-    // The prefetch object.
-    std::unique_ptr<prefetch::QuotaPrefetch> prefetch_;
+    // The prefetch object, may be shared through the quota pool.
+    std::shared_ptr<prefetch::QuotaPrefetch> prefetch_;
   };
 
   // Per quota Referenced data.
@@ -167,6 +175,9 @@ class QuotaCache {
   // The cache that maps from key to prefetch object
   std::unique_ptr<QuotaLRUCache> cache_;
 
+  // The quota pool shared with other clients.
+  std::shared_ptr<QuotaPool> pool_;
+
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(QuotaCache);
 };
 
@@ -329,6 +329,43 @@ TEST_F(QuotaCacheTest, TestTwoReferencedWith) {
   TestRequest(attr2, true, response2);
 }
 
+TEST_F(QuotaCacheTest, TestSharedPool) {
+  QuotaOptions options;
+  auto pool = std::make_shared<QuotaPool>();
+  cache_ = std::unique_ptr<QuotaCache>(new QuotaCache(options, pool));
+  std::unique_ptr<QuotaCache> cache2(new QuotaCache(options, pool));
+
+  CheckResponse response;
+  CheckResponse::QuotaResult quota_result;
+  quota_result.set_granted_amount(10);
+  (*response.mutable_quotas())[kQuotaName] = quota_result;
+  // The first cache prefetches 10, its prefetch object is added to
+  // the pool.
+  TestRequest(request_, true, response);
+  EXPECT_EQ(pool->size(), 1);
+
+  // The second cache is not granted by its own prefetch, but it then joins
+  // the prefetch object in the pool.
+  quota_result.set_granted_amount(0);
+  (*response.mutable_quotas())[kQuotaName] = quota_result;
+  QuotaCache::CheckResult result;
+  cache2->Check(request_, quotas_, true, &result);
+  CheckRequest request;
+  EXPECT_TRUE(result.BuildRequest(&request));
+  result.SetResponse(Status::OK, request_, response);
+  EXPECT_EQ(pool->size(), 1);
+
+  // The amount prefetched by the first cache is used without a remote call
+  // until it is low.
+  for (int i = 0; i < 4; i++) {
+    QuotaCache::CheckResult result;
+    cache2->Check(request_, quotas_, true, &result);
+    CheckRequest request;
+    EXPECT_FALSE(result.BuildRequest(&request));
+    EXPECT_OK(result.status());
+  }
+}
+
 }  // namespace
 }  // namespace mixerclient
 }  // namespace istio
@@ -0,0 +1,64 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/mixerclient/quota_pool.h"
+
+#include <algorithm>
+
+using ::istio::prefetch::QuotaPrefetch;
+
+namespace istio {
+namespace mixerclient {
+
+constexpr size_t QuotaPool::kMinRemoveSize;
+
+std::shared_ptr<QuotaPrefetch> QuotaPool::Share(
+    utils::HashType signature, const std::shared_ptr<QuotaPrefetch>& prefetch) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& entry = prefetches_[signature];
+  auto shared = entry.lock();
+  if (shared) {
+    return shared;
+  }
+  entry = prefetch;
+  if (prefetches_.size() >= remove_size_) {
+    RemoveReleased();
+  }
+  return prefetch;
+}
+
+size_t QuotaPool::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return prefetches_.size();
+}
+
+void QuotaPool::RemoveReleased() {
+  for (auto it = prefetches_.begin(); it != prefetches_.end();) {
+    if (it->second.expired()) {
+      it = prefetches_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  // Keep the removal cost amortized over the insertions.
+  remove_size_ = std::max(kMinRemoveSize, 2 * prefetches_.size());
+}
+
+std::shared_ptr<QuotaPool> CreateQuotaPool() {
+  return std::make_shared<QuotaPool>();
+}
+
+}  // namespace mixerclient
+}  // namespace istio
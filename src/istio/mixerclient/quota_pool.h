@@ -0,0 +1,69 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ISTIO_MIXERCLIENT_QUOTA_POOL_H
+#define ISTIO_MIXERCLIENT_QUOTA_POOL_H
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "google/protobuf/stubs/common.h"
+#include "include/istio/prefetch/quota_prefetch.h"
+#include "include/istio/utils/concat_hash.h"
+
+namespace istio {
+namespace mixerclient {
+
+// A proxy wide pool of quota prefetch objects, keyed by quota cache
+// signature.
+//
+// The quota caches of all worker threads share one prefetch object, and its
+// prefetched amount, for the same signature instead of each prefetching its
+// own share. The pool only holds weak references, a prefetch object lives as
+// long as a quota cache uses it.
+class QuotaPool {
+ public:
+  QuotaPool() {}
+
+  // Return the prefetch object in the pool for the signature. If there is
+  // none, the given one is added and returned.
+  std::shared_ptr<prefetch::QuotaPrefetch> Share(
+      utils::HashType signature,
+      const std::shared_ptr<prefetch::QuotaPrefetch>& prefetch);
+
+  // The number of signatures in the pool, including the released ones not
+  // removed yet.
+  size_t size() const;
+
+ private:
+  // Remove the released prefetch objects.
+  void RemoveReleased();
+
+  mutable std::mutex mutex_;
+  std::unordered_map<utils::HashType, std::weak_ptr<prefetch::QuotaPrefetch>>
+      prefetches_;
+  // Released objects are removed when the pool grows to this size.
+  size_t remove_size_{kMinRemoveSize};
+
+  static constexpr size_t kMinRemoveSize = 64;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(QuotaPool);
+};
+
+}  // namespace mixerclient
+}  // namespace istio
+
+#endif  // ISTIO_MIXERCLIENT_QUOTA_POOL_H
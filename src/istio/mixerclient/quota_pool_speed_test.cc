@@ -0,0 +1,150 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/istio/mixerclient/quota_pool.h"
+
+using namespace std::chrono;
+using ::istio::prefetch::QuotaPrefetch;
+
+namespace istio {
+namespace mixerclient {
+namespace {
+
+// A rolling window rate limit server shared by all workers.
+class RateServer {
+ public:
+  RateServer(int rate, milliseconds window) : rate_(rate), window_(window) {}
+
+  int Alloc(int amount, milliseconds* expire, QuotaPrefetch::Tick t) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (t >= expire_time_) {
+      avail_ = rate_;
+      expire_time_ = t + window_;
+    }
+    int granted = std::min(amount, avail_);
+    avail_ -= granted;
+    *expire = duration_cast<milliseconds>(expire_time_ - t);
+    ++calls_;
+    return granted;
+  }
+
+  uint64_t calls() const { return calls_; }
+
+ private:
+  std::mutex mutex_;
+  int rate_;
+  milliseconds window_;
+  int avail_{0};
+  QuotaPrefetch::Tick expire_time_;
+  std::atomic<uint64_t> calls_{0};
+};
+
+// Created by the first thread before the benchmark loop starts.
+RateServer* server;
+
+// A worker thread, responses are delivered on its next check as a network
+// round trip would be, not within the Check() call.
+class Worker {
+ public:
+  QuotaPrefetch::TransportFunc GetTransportFunc() {
+    return [this](int amount, QuotaPrefetch::DoneFunc fn,
+                          QuotaPrefetch::Tick t) {
+      milliseconds expire;
+      int granted = server->Alloc(amount, &expire, t);
+      pending_.push_back([fn, granted, expire](QuotaPrefetch::Tick t1) {
+        fn(granted, expire, t1);
+      });
+    };
+  }
+
+  void Deliver(QuotaPrefetch::Tick t) {
+    std::vector<std::function<void(QuotaPrefetch::Tick)>> pending;
+    pending.swap(pending_);
+    for (const auto& fn : pending) {
+      fn(t);
+    }
+  }
+
+ private:
+  std::vector<std::function<void(QuotaPrefetch::Tick)>> pending_;
+};
+
+std::shared_ptr<QuotaPrefetch> shared_prefetch;
+
+// Every worker checks the same quota, either with its own prefetch object
+// or with the one shared through the quota pool. The argument is the rate
+// limit per second.
+void BM_QuotaCheck(benchmark::State& state, bool shared) {
+  if (state.thread_index == 0) {
+    server = new RateServer(state.range(0), milliseconds(1000));
+    if (shared) {
+      QuotaPool pool;
+      shared_prefetch = pool.Share(
+          0, QuotaPrefetch::Create(
+                 [](int, QuotaPrefetch::DoneFunc, QuotaPrefetch::Tick) {},
+                 QuotaPrefetch::Options(), system_clock::now()));
+    }
+  }
+
+  Worker worker;
+  std::unique_ptr<QuotaPrefetch> own_prefetch;
+  if (!shared) {
+    own_prefetch = QuotaPrefetch::Create(worker.GetTransportFunc(),
+                                         QuotaPrefetch::Options(),
+                                         system_clock::now());
+  }
+  int64_t passed = 0;
+  for (auto _ : state) {
+    auto t = system_clock::now();
+    worker.Deliver(t);
+    if (shared) {
+      passed += shared_prefetch->Check(1, worker.GetTransportFunc(), t);
+    } else {
+      passed += own_prefetch->Check(1, t);
+    }
+  }
+
+  // The fraction of passed checks, averaged over the threads.
+  state.counters["passed"] = benchmark::Counter(
+      double(passed) / state.iterations(), benchmark::Counter::kAvgThreads);
+  if (state.thread_index == 0) {
+    // Remote calls per check of all threads.
+    state.counters["remote_calls"] =
+        double(server->calls()) / (state.iterations() * state.threads);
+    shared_prefetch.reset();
+    delete server;
+  }
+}
+
+BENCHMARK_CAPTURE(BM_QuotaCheck, PerWorker, false)
+    ->Arg(100000)
+    ->Arg(100000000)
+    ->ThreadRange(1, 16);
+BENCHMARK_CAPTURE(BM_QuotaCheck, Pooled, true)
+    ->Arg(100000)
+    ->Arg(100000000)
+    ->ThreadRange(1, 16);
+
+}  // namespace
+}  // namespace mixerclient
+}  // namespace istio
+
+BENCHMARK_MAIN();
@@ -0,0 +1,65 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/mixerclient/quota_pool.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using ::istio::prefetch::QuotaPrefetch;
+
+namespace istio {
+namespace mixerclient {
+namespace {
+
+std::shared_ptr<QuotaPrefetch> CreatePrefetch() {
+  return QuotaPrefetch::Create(
+      [](int, QuotaPrefetch::DoneFunc, QuotaPrefetch::Tick) {},
+      QuotaPrefetch::Options(), QuotaPrefetch::Tick());
+}
+
+TEST(QuotaPoolTest, TestShare) {
+  QuotaPool pool;
+  auto prefetch1 = CreatePrefetch();
+  auto prefetch2 = CreatePrefetch();
+  auto prefetch3 = CreatePrefetch();
+
+  EXPECT_EQ(pool.Share(1, prefetch1), prefetch1);
+  // The same signature shares the first prefetch object.
+  EXPECT_EQ(pool.Share(1, prefetch2), prefetch1);
+  EXPECT_EQ(pool.Share(2, prefetch3), prefetch3);
+  EXPECT_EQ(pool.size(), 2);
+
+  // A released prefetch object is replaced.
+  prefetch1.reset();
+  EXPECT_EQ(pool.Share(1, prefetch2), prefetch2);
+}
+
+TEST(QuotaPoolTest, TestRemoveReleased) {
+  QuotaPool pool;
+  auto kept = CreatePrefetch();
+  pool.Share(0, kept);
+  for (int i = 1; i < 1000; i++) {
+    pool.Share(i, CreatePrefetch());
+  }
+  // Released prefetch objects do not accumulate.
+  EXPECT_LT(pool.size(), 100);
+  EXPECT_EQ(pool.Share(0, CreatePrefetch()), kept);
+}
+
+}  // namespace
+}  // namespace mixerclient
+}  // namespace istio
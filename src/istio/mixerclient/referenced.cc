@@ -115,6 +115,26 @@ bool Referenced::Fill(const Attributes &attributes,
   return true;
 }
 
+bool Referenced::GetMapKeys(const ReferencedAttributes &reference,
+                            const std::string &name,
+                            std::vector<std::string> *map_keys) {
+  const std::vector<std::string> &global_words = GetGlobalWords();
+  std::string match_name;
+  for (const auto &match : reference.attribute_matches()) {
+    if (!Decode(match.name(), global_words, reference, &match_name)) {
+      return false;
+    }
+    if (match_name == name) {
+      map_keys->emplace_back();
+      if (!Decode(match.map_key(), global_words, reference,
+                  &map_keys->back())) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 bool Referenced::Signature(const Attributes &attributes,
                            const std::string &extra_key,
                            utils::HashType *signature) const {
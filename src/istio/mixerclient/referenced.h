@@ -48,6 +48,12 @@ class Referenced {
   // For debug logging only.
   std::string DebugString() const;
 
+  // Decode the map keys referenced for the string map attribute "name".
+  // Return false if any word could not be decoded.
+  static bool GetMapKeys(
+      const ::istio::mixer::v1::ReferencedAttributes &reference,
+      const std::string &name, std::vector<std::string> *map_keys);
+
  private:
   // Return true if all absent keys are not in the attributes.
   bool CheckAbsentKeys(const ::istio::mixer::v1::Attributes &attributes) const;
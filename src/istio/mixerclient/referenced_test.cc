@@ -177,6 +177,22 @@ TEST(ReferencedTest, FillSuccessTest) {
             "time-key, ");
 }
 
+TEST(ReferencedTest, GetMapKeysTest) {
+  ::istio::mixer::v1::ReferencedAttributes pb;
+  ASSERT_TRUE(TextFormat::ParseFromString(kReferencedText, &pb));
+
+  std::vector<std::string> map_keys;
+  EXPECT_TRUE(Referenced::GetMapKeys(pb, "string-map-key", &map_keys));
+  EXPECT_EQ(map_keys, std::vector<std::string>({"If-Match", "User-Agent"}));
+
+  map_keys.clear();
+  EXPECT_TRUE(Referenced::GetMapKeys(pb, "other-key", &map_keys));
+  EXPECT_TRUE(map_keys.empty());
+
+  ASSERT_TRUE(TextFormat::ParseFromString(kReferencedFailText2, &pb));
+  EXPECT_FALSE(Referenced::GetMapKeys(pb, "string-map-key", &map_keys));
+}
+
 TEST(ReferencedTest, FillFail1Test) {
   ::istio::mixer::v1::ReferencedAttributes pb;
   ASSERT_TRUE(TextFormat::ParseFromString(kReferencedFailText1, &pb));
@@ -0,0 +1,344 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/mixerclient/report_aggregator.h"
+
+#include <algorithm>
+#include <condition_variable>
+
+#include "include/istio/utils/protobuf.h"
+#include "src/istio/mixerclient/adaptive_batch_sizer.h"
+#include "src/istio/mixerclient/status_util.h"
+#include "src/istio/utils/logger.h"
+
+using namespace std::chrono;
+using ::google::protobuf::util::Status;
+using ::istio::mixer::v1::ReportRequest;
+using ::istio::mixer::v1::ReportResponse;
+
+namespace istio {
+namespace mixerclient {
+
+static std::atomic<uint32_t> REPORT_FAIL_LOG_MESSAGES{0};
+static constexpr uint32_t REPORT_FAIL_LOG_MODULUS{100};
+
+struct ReportAggregator::Producer::SharedState {
+  // Set by a failed report, the aggregator thread shrinks its dictionary.
+  std::atomic<bool> shrink_dictionary{false};
+  // Number of batches posted to producers but not sent yet.
+  std::atomic<int> pending_batches{0};
+  // Adapts the batch size, null if max_batch_bytes is not set. Producers
+  // only call its OnTransportDone().
+  std::unique_ptr<AdaptiveBatchSizer> sizer;
+
+  // Number of reports in the producer queues.
+  std::atomic<int> queued{0};
+  // The aggregator thread is woken once "queued" reaches it.
+  std::atomic<int> wake_threshold{1};
+  // Set while the aggregator thread sleeps, cleared by the producer waking
+  // it.
+  std::atomic<bool> idle{false};
+
+  // Mutex and condition the aggregator thread sleeps on.
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stopped{false};
+};
+
+ReportAggregator::Producer::Producer(int queue_size,
+                                     TransportReportFunc transport,
+                                     PostFunc post,
+                                     std::shared_ptr<SharedState> state)
+    : queue_(queue_size),
+      transport_(transport),
+      post_(post),
+      state_(state) {}
+
+void ReportAggregator::Producer::Report(
+    const SharedAttributesSharedPtr& attributes) {
+  ++total_report_calls_;
+  SharedAttributesSharedPtr item = attributes;
+  if (!queue_.Push(std::move(item))) {
+    ++total_report_drops_;
+    return;
+  }
+  // Only the first producer to see the thread idle takes the lock.
+  if (++state_->queued >= state_->wake_threshold &&
+      state_->idle.exchange(false)) {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->cv.notify_one();
+  }
+}
+
+void ReportAggregator::Producer::Send(std::shared_ptr<ReportRequest> request) {
+  if (closed_) {
+    total_report_drops_ += request->attributes_size();
+    return;
+  }
+  Transmit(request);
+}
+
+void ReportAggregator::Producer::Transmit(
+    std::shared_ptr<ReportRequest> request) {
+  ++total_remote_report_calls_;
+  std::shared_ptr<ReportResponse> response{new ReportResponse()};
+  auto shared_this = shared_from_this();
+  auto send_time = steady_clock::now();
+  transport_(*request, &*response,
+             [this, shared_this, request, response,
+              send_time](const Status& status) {
+               if (state_->sizer) {
+                 state_->sizer->OnTransportDone(duration_cast<microseconds>(
+                     steady_clock::now() - send_time));
+               }
+
+               switch (TransportStatus(status)) {
+                 case TransportResult::SUCCESS:
+                   ++total_remote_report_successes_;
+                   break;
+                 case TransportResult::RESPONSE_TIMEOUT:
+                   ++total_remote_report_timeouts_;
+                   break;
+                 case TransportResult::SEND_ERROR:
+                   ++total_remote_report_send_errors_;
+                   break;
+                 case TransportResult::OTHER:
+                   ++total_remote_report_other_errors_;
+                   break;
+               }
+
+               if (!status.ok()) {
+                 if (MIXER_WARN_ENABLED &&
+                     0 == REPORT_FAIL_LOG_MESSAGES++ %
+                              REPORT_FAIL_LOG_MODULUS) {
+                   MIXER_WARN("Mixer Report failed with: %s",
+                              status.ToString().c_str());
+                 } else {
+                   MIXER_DEBUG("Mixer Report failed with: %s",
+                               status.ToString().c_str());
+                 }
+                 if (utils::InvalidDictionaryStatus(status)) {
+                   // The dictionary is only touched by the aggregator thread.
+                   state_->shrink_dictionary = true;
+                 }
+               }
+             });
+}
+
+ReportAggregator::ReportAggregator(const ReportAggregatorOptions& options)
+    : options_(options),
+      batch_compressor_(options.delta_encoding
+                            ? compressor_.CreateDeltaBatchCompressor()
+                            : compressor_.CreateBatchCompressor()),
+      state_(std::make_shared<Producer::SharedState>()) {
+  if (options_.max_batch_bytes > 0) {
+    state_->sizer.reset(new AdaptiveBatchSizer(options_));
+  }
+}
+
+ReportAggregator::~ReportAggregator() {
+  if (thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      state_->stopped = true;
+    }
+    state_->cv.notify_one();
+    thread_.join();
+  }
+}
+
+void ReportAggregator::Start() {
+  thread_ = std::thread([this]() { Run(); });
+}
+
+ReportAggregator::ProducerSharedPtr ReportAggregator::CreateProducer(
+    TransportReportFunc transport, PostFunc post) {
+  ProducerSharedPtr producer(
+      new Producer(options_.max_queue_entries, transport, post, state_));
+  std::lock_guard<std::mutex> lock(producers_mutex_);
+  producers_.push_back(producer);
+  return producer;
+}
+
+void ReportAggregator::RemoveProducer(const ProducerSharedPtr& producer) {
+  std::lock_guard<std::mutex> process_lock(process_mutex_);
+  // Batches are no longer posted to the producer, its worker is going away.
+  producer->closed_ = true;
+  // The worker does not push any more, the queue stays empty once drained.
+  const Tick time_now = steady_clock::now();
+  Drain(producer.get(), time_now, producer.get());
+
+  bool last;
+  {
+    std::lock_guard<std::mutex> lock(producers_mutex_);
+    producers_.erase(
+        std::remove(producers_.begin(), producers_.end(), producer),
+        producers_.end());
+    last = producers_.empty();
+  }
+  if (last && batch_compressor_->size() > 0) {
+    FinishBatch(time_now, producer.get());
+  }
+}
+
+void ReportAggregator::Run() {
+  while (true) {
+    Process(steady_clock::now(), false);
+
+    // Sleep until enough reports are queued to fill the batch, or until the
+    // batch time is over. An empty batch waits for the first report.
+    int threshold = 1;
+    bool has_deadline = false;
+    Tick deadline;
+    {
+      std::lock_guard<std::mutex> process_lock(process_mutex_);
+      const int size = batch_compressor_->size();
+      if (size > 0) {
+        threshold = std::max(1, batch_entries() - size);
+        has_deadline = true;
+        deadline = batch_start_ + milliseconds(batch_time_ms());
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    if (state_->stopped) {
+      break;
+    }
+    state_->wake_threshold = threshold;
+    state_->idle = true;
+    // A report queued before "idle" was set did not wake the thread.
+    if (state_->queued >= threshold) {
+      state_->idle = false;
+      continue;
+    }
+    auto woken = [this]() { return !state_->idle || state_->stopped; };
+    if (has_deadline) {
+      state_->cv.wait_until(lock, deadline, woken);
+    } else {
+      state_->cv.wait(lock, woken);
+    }
+    state_->idle = false;
+  }
+  Process(steady_clock::now(), true);
+}
+
+void ReportAggregator::Process(Tick time_now, bool flush) {
+  std::lock_guard<std::mutex> process_lock(process_mutex_);
+  std::vector<ProducerSharedPtr> producers;
+  {
+    std::lock_guard<std::mutex> lock(producers_mutex_);
+    producers = producers_;
+  }
+
+  if (state_->shrink_dictionary.exchange(false)) {
+    compressor_.ShrinkGlobalDictionary();
+  }
+
+  for (const auto& producer : producers) {
+    Drain(producer.get(), time_now, nullptr);
+  }
+
+  if (batch_compressor_->size() > 0 &&
+      (flush ||
+       time_now - batch_start_ >= milliseconds(batch_time_ms()))) {
+    FinishBatch(time_now, nullptr);
+  }
+}
+
+void ReportAggregator::Drain(Producer* producer, Tick time_now,
+                             Producer* last) {
+  SharedAttributesSharedPtr attributes;
+  while (producer->queue_.Pop(&attributes)) {
+    --state_->queued;
+    if (batch_compressor_->size() == 0) {
+      batch_start_ = time_now;
+    }
+    if (!batch_compressor_->Add(*attributes->attributes())) {
+      FinishBatch(time_now, last);
+      batch_start_ = time_now;
+      batch_compressor_->Add(*attributes->attributes());
+    }
+    attributes.reset();
+    if (batch_compressor_->size() >= batch_entries()) {
+      FinishBatch(time_now, last);
+    }
+  }
+}
+
+int ReportAggregator::batch_entries() const {
+  return state_->sizer ? state_->sizer->batch_entries()
+                       : options_.max_batch_entries;
+}
+
+int ReportAggregator::batch_time_ms() const {
+  return state_->sizer ? state_->sizer->batch_time_ms()
+                       : options_.max_batch_time_ms;
+}
+
+void ReportAggregator::FinishBatch(Tick time_now, Producer* last) {
+  auto request = std::make_shared<ReportRequest>(batch_compressor_->Finish());
+  batch_compressor_->Clear();
+  if (state_->sizer) {
+    state_->sizer->OnFlush(request->attributes_size(), request->ByteSizeLong(),
+                           batch_start_, time_now);
+  }
+
+  ProducerSharedPtr sender;
+  {
+    std::lock_guard<std::mutex> lock(producers_mutex_);
+    for (size_t i = 0; i < producers_.size() && !sender; ++i) {
+      const auto& producer = producers_[next_sender_++ % producers_.size()];
+      if (!producer->closed_) {
+        sender = producer;
+      }
+    }
+  }
+
+  if (!sender) {
+    if (last) {
+      last->Transmit(request);
+      return;
+    }
+    MIXER_WARN("Drop %d reports, no worker is left to send them.",
+               request->attributes_size());
+    return;
+  }
+
+  if (state_->pending_batches >= options_.max_pending_batches) {
+    sender->total_report_drops_ += request->attributes_size();
+    return;
+  }
+
+  ++state_->pending_batches;
+  std::weak_ptr<Producer> weak_sender = sender;
+  auto state = state_;
+  sender->post_([weak_sender, state, request]() {
+    --state->pending_batches;
+    auto producer = weak_sender.lock();
+    if (producer) {
+      producer->Send(request);
+    }
+  });
+}
+
+std::shared_ptr<ReportAggregator> CreateReportAggregator(
+    const ReportAggregatorOptions& options) {
+  auto aggregator = std::make_shared<ReportAggregator>(options);
+  aggregator->Start();
+  return aggregator;
+}
+
+}  // namespace mixerclient
+}  // namespace istio
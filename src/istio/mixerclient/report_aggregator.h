@@ -0,0 +1,181 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ISTIO_MIXERCLIENT_REPORT_AGGREGATOR_H
+#define ISTIO_MIXERCLIENT_REPORT_AGGREGATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "include/istio/mixerclient/client.h"
+#include "src/istio/mixerclient/attribute_compressor.h"
+#include "src/istio/mixerclient/spsc_queue.h"
+
+namespace istio {
+namespace mixerclient {
+
+// Aggregates the reports of all worker threads into proxy wide batches.
+//
+// Each worker owns a Producer and hands raw attribute bags to it without
+// locking. A dedicated thread drains the producer queues, compresses the
+// attributes and assembles the batches. A finished batch is posted back to
+// one of the workers, whose transport sends it.
+//
+// The thread sleeps until a producer queue goes non-empty, enough reports
+// are queued to fill the current batch, or the batch time is over.
+class ReportAggregator {
+ public:
+  ReportAggregator(const ReportAggregatorOptions& options);
+
+  // Stops the aggregator thread. Batched reports are flushed to a producer
+  // if any is left.
+  virtual ~ReportAggregator();
+
+  // Starts the aggregator thread.
+  void Start();
+
+  // The per-worker handle to the aggregator.
+  class Producer : public std::enable_shared_from_this<Producer> {
+   public:
+    // Hand over the attributes to the aggregator. Only called by the worker
+    // thread, the attributes should not be modified after the call.
+    void Report(const SharedAttributesSharedPtr& attributes);
+
+    uint64_t total_report_calls() const { return total_report_calls_; }
+    uint64_t total_report_drops() const { return total_report_drops_; }
+    uint64_t total_remote_report_calls() const {
+      return total_remote_report_calls_;
+    }
+    uint64_t total_remote_report_successes() const {
+      return total_remote_report_successes_;
+    }
+    uint64_t total_remote_report_timeouts() const {
+      return total_remote_report_timeouts_;
+    }
+    uint64_t total_remote_report_send_errors() const {
+      return total_remote_report_send_errors_;
+    }
+    uint64_t total_remote_report_other_errors() const {
+      return total_remote_report_other_errors_;
+    }
+
+   private:
+    friend class ReportAggregator;
+    struct SharedState;
+
+    Producer(int queue_size, TransportReportFunc transport, PostFunc post,
+             std::shared_ptr<SharedState> state);
+
+    // Send a finished batch, dropped if the producer is closed. Called on
+    // the worker thread.
+    void Send(std::shared_ptr<::istio::mixer::v1::ReportRequest> request);
+
+    // Send a finished batch on the transport. Called on the worker thread.
+    void Transmit(std::shared_ptr<::istio::mixer::v1::ReportRequest> request);
+
+    // The queue of reports not yet aggregated.
+    SpscQueue<SharedAttributesSharedPtr> queue_;
+
+    // The worker transport and the function to post to the worker thread.
+    TransportReportFunc transport_;
+    PostFunc post_;
+
+    // State shared with the aggregator, may outlive it.
+    std::shared_ptr<SharedState> state_;
+
+    // Set when the worker is gone, its transport should not be used.
+    std::atomic<bool> closed_{false};
+
+    std::atomic<uint64_t> total_report_calls_{0};
+    std::atomic<uint64_t> total_report_drops_{0};
+    std::atomic<uint64_t> total_remote_report_calls_{0};
+    std::atomic<uint64_t> total_remote_report_successes_{0};
+    std::atomic<uint64_t> total_remote_report_timeouts_{0};
+    std::atomic<uint64_t> total_remote_report_send_errors_{0};
+    std::atomic<uint64_t> total_remote_report_other_errors_{0};
+  };
+  typedef std::shared_ptr<Producer> ProducerSharedPtr;
+
+  // Create a producer for a worker thread. The transport is only called
+  // from functions posted by post.
+  ProducerSharedPtr CreateProducer(TransportReportFunc transport,
+                                   PostFunc post);
+
+  // Close a producer, called on its worker thread before the transport is
+  // destroyed. Its queued reports are aggregated before it returns. If it
+  // is the last producer, the current batch is sent on its transport.
+  void RemoveProducer(const ProducerSharedPtr& producer);
+
+ private:
+  friend class ReportAggregatorTest;
+  using Tick = std::chrono::time_point<std::chrono::steady_clock>;
+
+  // The aggregator thread loop.
+  void Run();
+
+  // Drain the producer queues into the batch. The batch is finished when
+  // full, when it is older than the batch time, or if flush is true.
+  void Process(Tick time_now, bool flush);
+
+  // Drain the queue of a producer into the batch. Called with
+  // process_mutex_ held.
+  void Drain(Producer* producer, Tick time_now, Producer* last);
+
+  // Finish the current batch and post it to a producer. If no producer is
+  // left to post to, the batch is sent on the transport of "last" if it is
+  // not null, or dropped. Called with process_mutex_ held.
+  void FinishBatch(Tick time_now, Producer* last);
+
+  // The current batch size and batch time, adapted if max_batch_bytes is set.
+  int batch_entries() const;
+  int batch_time_ms() const;
+
+  // The aggregator options.
+  ReportAggregatorOptions options_;
+
+  // Mutex serializing the aggregation of the aggregator thread with the
+  // one of RemoveProducer(), guarding the compressors and the batch.
+  std::mutex process_mutex_;
+
+  // Attribute compressor, only used by the aggregator thread.
+  AttributeCompressor compressor_;
+
+  // The batch compressor for the batch being assembled.
+  std::unique_ptr<BatchCompressor> batch_compressor_;
+
+  // Time the first report of the current batch was aggregated.
+  Tick batch_start_;
+
+  // State shared with producers.
+  std::shared_ptr<Producer::SharedState> state_;
+
+  // Mutex guarding producers_ and next_sender_.
+  std::mutex producers_mutex_;
+  std::vector<ProducerSharedPtr> producers_;
+  size_t next_sender_{0};
+
+  std::thread thread_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ReportAggregator);
+};
+
+}  // namespace mixerclient
+}  // namespace istio
+
+#endif  // ISTIO_MIXERCLIENT_REPORT_AGGREGATOR_H
@@ -0,0 +1,312 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/mixerclient/report_aggregator.h"
+
+#include <condition_variable>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "include/istio/utils/attributes_builder.h"
+
+using ::google::protobuf::util::Status;
+using ::istio::mixer::v1::ReportRequest;
+using ::istio::mixer::v1::ReportResponse;
+using ::testing::_;
+using ::testing::Invoke;
+
+namespace istio {
+namespace mixerclient {
+
+// A mocking class to mock ReportTransport interface.
+class MockReportTransport {
+ public:
+  MOCK_METHOD3(Report, void(const ReportRequest&, ReportResponse*, DoneFunc));
+  TransportReportFunc GetFunc() {
+    return [this](const ReportRequest& request, ReportResponse* response,
+                  DoneFunc on_done) -> CancelFunc {
+      Report(request, response, on_done);
+      return nullptr;
+    };
+  }
+};
+
+class ReportAggregatorTest : public ::testing::Test {
+ public:
+  ReportAggregatorTest() { Reset(ReportAggregatorOptions(3, 1000)); }
+
+  void Reset(const ReportAggregatorOptions& options) {
+    aggregator_.reset(new ReportAggregator(options));
+    producer_ = aggregator_->CreateProducer(mock_report_transport_.GetFunc(),
+                                            GetPostFunc());
+  }
+
+  // Posted functions run when RunPosted() is called, like a worker would.
+  PostFunc GetPostFunc() {
+    return [this](std::function<void()> fn) { posted_.push_back(fn); };
+  }
+
+  void RunPosted() {
+    auto posted = std::move(posted_);
+    posted_.clear();
+    for (const auto& fn : posted) {
+      fn();
+    }
+  }
+
+  void Process(ReportAggregator::Tick time_now, bool flush) {
+    aggregator_->Process(time_now, flush);
+  }
+
+  size_t producer_count() const { return aggregator_->producers_.size(); }
+
+  SharedAttributesSharedPtr CreateReport(int64_t size) {
+    SharedAttributesSharedPtr report{new SharedAttributes()};
+    utils::AttributesBuilder(report->attributes())
+        .AddInt64("request.size", size);
+    return report;
+  }
+
+  ::testing::NiceMock<MockReportTransport> mock_report_transport_;
+  std::vector<std::function<void()>> posted_;
+  std::unique_ptr<ReportAggregator> aggregator_;
+  ReportAggregator::ProducerSharedPtr producer_;
+};
+
+TEST_F(ReportAggregatorTest, TestBatchAcrossProducers) {
+  auto other = aggregator_->CreateProducer(mock_report_transport_.GetFunc(),
+                                           GetPostFunc());
+  std::vector<int> batch_sizes;
+  EXPECT_CALL(mock_report_transport_, Report(_, _, _))
+      .WillRepeatedly(Invoke([&](const ReportRequest& request,
+                                 ReportResponse* response, DoneFunc on_done) {
+        batch_sizes.push_back(request.attributes_size());
+        on_done(Status::OK);
+      }));
+
+  for (int i = 0; i < 4; ++i) {
+    producer_->Report(CreateReport(i));
+    other->Report(CreateReport(i));
+  }
+  // Nothing is compressed nor sent on the worker threads.
+  EXPECT_TRUE(posted_.empty());
+
+  Process(std::chrono::steady_clock::now(), false);
+  RunPosted();
+  EXPECT_EQ(batch_sizes, std::vector<int>({3, 3}));
+
+  Process(std::chrono::steady_clock::now(), true);
+  RunPosted();
+  EXPECT_EQ(batch_sizes, std::vector<int>({3, 3, 2}));
+
+  EXPECT_EQ(producer_->total_report_calls(), 4);
+  EXPECT_EQ(other->total_report_calls(), 4);
+  EXPECT_EQ(producer_->total_remote_report_calls() +
+                other->total_remote_report_calls(),
+            3);
+}
+
+TEST_F(ReportAggregatorTest, TestBatchTimeout) {
+  int report_call_count = 0;
+  EXPECT_CALL(mock_report_transport_, Report(_, _, _))
+      .WillRepeatedly(Invoke([&](const ReportRequest& request,
+                                 ReportResponse* response, DoneFunc on_done) {
+        report_call_count++;
+        on_done(Status::OK);
+      }));
+
+  auto start = std::chrono::steady_clock::now();
+  producer_->Report(CreateReport(1));
+  Process(start, false);
+  RunPosted();
+  EXPECT_EQ(report_call_count, 0);
+
+  Process(start + std::chrono::milliseconds(999), false);
+  RunPosted();
+  EXPECT_EQ(report_call_count, 0);
+
+  Process(start + std::chrono::milliseconds(1000), false);
+  RunPosted();
+  EXPECT_EQ(report_call_count, 1);
+  EXPECT_EQ(producer_->total_remote_report_successes(), 1);
+}
+
+TEST_F(ReportAggregatorTest, TestAdaptiveBatchSize) {
+  ReportAggregatorOptions options(100, 1000);
+  options.max_batch_bytes = 1;
+  options.min_batch_entries = 2;
+  Reset(options);
+
+  std::vector<int> batch_sizes;
+  EXPECT_CALL(mock_report_transport_, Report(_, _, _))
+      .WillRepeatedly(Invoke([&](const ReportRequest& request,
+                                 ReportResponse* response, DoneFunc on_done) {
+        batch_sizes.push_back(request.attributes_size());
+        on_done(Status::OK);
+      }));
+
+  for (int i = 0; i < 5; ++i) {
+    producer_->Report(CreateReport(i));
+  }
+  Process(std::chrono::steady_clock::now(), true);
+  RunPosted();
+  // The first batch is not sized yet, then batches shrink to the minimum as
+  // any report exceeds max_batch_bytes.
+  EXPECT_EQ(batch_sizes, std::vector<int>({5}));
+
+  batch_sizes.clear();
+  for (int i = 0; i < 5; ++i) {
+    producer_->Report(CreateReport(i));
+  }
+  Process(std::chrono::steady_clock::now(), false);
+  RunPosted();
+  EXPECT_EQ(batch_sizes, std::vector<int>({2, 2}));
+}
+
+TEST_F(ReportAggregatorTest, TestQueueOverflow) {
+  ReportAggregatorOptions options(100, 1000);
+  options.max_queue_entries = 2;
+  Reset(options);
+
+  for (int i = 0; i < 5; ++i) {
+    producer_->Report(CreateReport(i));
+  }
+  EXPECT_EQ(producer_->total_report_calls(), 5);
+  EXPECT_EQ(producer_->total_report_drops(), 3);
+}
+
+TEST_F(ReportAggregatorTest, TestPendingBatchOverflow) {
+  ReportAggregatorOptions options(1, 1000);
+  options.max_pending_batches = 2;
+  Reset(options);
+
+  EXPECT_CALL(mock_report_transport_, Report(_, _, _)).Times(2);
+  for (int i = 0; i < 5; ++i) {
+    producer_->Report(CreateReport(i));
+  }
+  // Worker did not run the posted sends, the last three batches are dropped.
+  Process(std::chrono::steady_clock::now(), false);
+  RunPosted();
+  EXPECT_EQ(producer_->total_report_drops(), 3);
+}
+
+TEST_F(ReportAggregatorTest, TestRemovedProducer) {
+  auto other = aggregator_->CreateProducer(mock_report_transport_.GetFunc(),
+                                           GetPostFunc());
+  int report_call_count = 0;
+  EXPECT_CALL(mock_report_transport_, Report(_, _, _))
+      .WillRepeatedly(Invoke([&](const ReportRequest& request,
+                                 ReportResponse* response, DoneFunc on_done) {
+        report_call_count++;
+        on_done(Status::OK);
+      }));
+
+  producer_->Report(CreateReport(1));
+  aggregator_->RemoveProducer(producer_);
+  // Queued reports of a removed producer are sent by the remaining one.
+  Process(std::chrono::steady_clock::now(), true);
+  RunPosted();
+  EXPECT_EQ(report_call_count, 1);
+  EXPECT_EQ(producer_->total_remote_report_calls(), 0);
+  EXPECT_EQ(other->total_remote_report_calls(), 1);
+  EXPECT_EQ(producer_count(), 1);
+}
+
+TEST_F(ReportAggregatorTest, TestRemoveLastProducer) {
+  std::vector<int> batch_sizes;
+  EXPECT_CALL(mock_report_transport_, Report(_, _, _))
+      .WillRepeatedly(Invoke([&](const ReportRequest& request,
+                                 ReportResponse* response, DoneFunc on_done) {
+        batch_sizes.push_back(request.attributes_size());
+        on_done(Status::OK);
+      }));
+
+  producer_->Report(CreateReport(1));
+  Process(std::chrono::steady_clock::now(), false);
+  producer_->Report(CreateReport(2));
+  // The aggregated and the queued reports are sent on the transport of the
+  // last producer before it goes away.
+  aggregator_->RemoveProducer(producer_);
+  EXPECT_EQ(batch_sizes, std::vector<int>({2}));
+  EXPECT_TRUE(posted_.empty());
+  EXPECT_EQ(producer_->total_remote_report_calls(), 1);
+  EXPECT_EQ(producer_count(), 0);
+}
+
+TEST_F(ReportAggregatorTest, TestThreadWakesOnReport) {
+  Reset(ReportAggregatorOptions(100, 10));
+
+  std::mutex posted_mutex;
+  std::condition_variable posted_cv;
+  std::vector<std::function<void()>> posted;
+  auto producer = aggregator_->CreateProducer(
+      mock_report_transport_.GetFunc(), [&](std::function<void()> fn) {
+        std::lock_guard<std::mutex> lock(posted_mutex);
+        posted.push_back(fn);
+        posted_cv.notify_one();
+      });
+  aggregator_->RemoveProducer(producer_);
+  aggregator_->Start();
+
+  // The idle thread is woken by the report and sends it after the batch
+  // time, without a flush.
+  EXPECT_CALL(mock_report_transport_, Report(_, _, _)).Times(1);
+  producer->Report(CreateReport(1));
+  {
+    std::unique_lock<std::mutex> lock(posted_mutex);
+    ASSERT_TRUE(posted_cv.wait_for(lock, std::chrono::seconds(10),
+                                   [&]() { return !posted.empty(); }));
+  }
+  aggregator_.reset();
+  for (const auto& fn : posted) {
+    fn();
+  }
+}
+
+TEST_F(ReportAggregatorTest, TestAggregatorThread) {
+  Reset(ReportAggregatorOptions(100, 10));
+
+  std::atomic<int> report_entries{0};
+  EXPECT_CALL(mock_report_transport_, Report(_, _, _))
+      .WillRepeatedly(Invoke([&](const ReportRequest& request,
+                                 ReportResponse* response, DoneFunc on_done) {
+        report_entries += request.attributes_size();
+        on_done(Status::OK);
+      }));
+
+  // The posted functions are run on this thread only.
+  std::mutex posted_mutex;
+  std::vector<std::function<void()>> posted;
+  auto producer = aggregator_->CreateProducer(
+      mock_report_transport_.GetFunc(), [&](std::function<void()> fn) {
+        std::lock_guard<std::mutex> lock(posted_mutex);
+        posted.push_back(fn);
+      });
+  aggregator_->RemoveProducer(producer_);
+  aggregator_->Start();
+
+  for (int i = 0; i < 1000; ++i) {
+    producer->Report(CreateReport(i));
+  }
+  aggregator_.reset();
+
+  for (const auto& fn : posted) {
+    fn();
+  }
+  EXPECT_EQ(report_entries + producer->total_report_drops(), 1000);
+}
+
+}  // namespace mixerclient
+}  // namespace istio
@@ -39,7 +39,9 @@ ReportBatch::ReportBatch(const ReportOptions& options,
       transport_(transport),
       timer_create_(timer_create),
       compressor_(compressor),
-      batch_compressor_(compressor.CreateBatchCompressor()),
+      batch_compressor_(options.delta_encoding
+                            ? compressor.CreateDeltaBatchCompressor()
+                            : compressor.CreateBatchCompressor()),
       total_report_calls_(0),
       total_remote_report_calls_(0) {}
 
@@ -49,7 +51,10 @@ void ReportBatch::Report(
     const istio::mixerclient::SharedAttributesSharedPtr& attributes) {
   std::lock_guard<std::mutex> lock(mutex_);
   ++total_report_calls_;
-  batch_compressor_->Add(*attributes->attributes());
+  if (!batch_compressor_->Add(*attributes->attributes())) {
+    FlushWithLock();
+    batch_compressor_->Add(*attributes->attributes());
+  }
   if (batch_compressor_->size() >= options_.max_batch_entries) {
     FlushWithLock();
   } else {
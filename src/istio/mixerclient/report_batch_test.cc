@@ -132,5 +132,38 @@ TEST_F(ReportBatchTest, TestBatchReportWithTimeout) {
   EXPECT_EQ(report_call_count, 1);
 }
 
+TEST_F(ReportBatchTest, TestDeltaEncodingRemovedAttribute) {
+  ReportOptions options(10, 1000);
+  options.delta_encoding = true;
+  batch_.reset(new ReportBatch(options, mock_report_transport_.GetFunc(),
+                               GetTimerFunc(), compressor_));
+
+  std::vector<int> batch_sizes;
+  EXPECT_CALL(mock_report_transport_, Report(_, _, _))
+      .WillRepeatedly(Invoke([&](const ReportRequest& request,
+                                 ReportResponse* response, DoneFunc on_done) {
+        EXPECT_EQ(request.repeated_attributes_semantics(),
+                  ReportRequest::DELTA_ENCODING);
+        batch_sizes.push_back(request.attributes_size());
+        on_done(Status::OK);
+      }));
+
+  istio::mixerclient::SharedAttributesSharedPtr report{
+      new istio::mixerclient::SharedAttributes()};
+  utils::AttributesBuilder builder(report->attributes());
+  builder.AddInt64("request.size", 1);
+  builder.AddInt64("response.size", 2);
+  batch_->Report(report);
+  batch_->Report(report);
+
+  // A removed attribute can not be delta encoded, a new batch is started.
+  report->attributes()->mutable_attributes()->erase("response.size");
+  batch_->Report(report);
+  EXPECT_EQ(batch_sizes, std::vector<int>({2}));
+
+  batch_->Flush();
+  EXPECT_EQ(batch_sizes, std::vector<int>({2, 1}));
+}
+
 }  // namespace mixerclient
 }  // namespace istio
@@ -0,0 +1,83 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ISTIO_MIXERCLIENT_SPSC_QUEUE_H
+#define ISTIO_MIXERCLIENT_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace istio {
+namespace mixerclient {
+
+// A bounded lock-free queue with a single producer thread and a single
+// consumer thread. Push() may only be called by the producer and Pop() only
+// by the consumer. Neither of them blocks or allocates.
+template <class T>
+class SpscQueue {
+ public:
+  // One slot is kept empty to tell a full queue from an empty one.
+  explicit SpscQueue(size_t capacity) : slots_(capacity + 1) {}
+
+  // Push an item, return false if the queue is full.
+  bool Push(T&& item) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t next = Next(tail);
+    if (next == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    slots_[tail] = std::move(item);
+    tail_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Pop an item, return false if the queue is empty.
+  bool Pop(T* item) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *item = std::move(slots_[head]);
+    // Release whatever the moved-from slot still holds.
+    slots_[head] = T();
+    head_.store(Next(head), std::memory_order_release);
+    return true;
+  }
+
+  // Return true if the queue is empty. Exact only on the consumer thread.
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const { return slots_.size() - 1; }
+
+ private:
+  size_t Next(size_t index) const {
+    return index + 1 == slots_.size() ? 0 : index + 1;
+  }
+
+  std::vector<T> slots_;
+  // Read position, only written by the consumer.
+  alignas(64) std::atomic<size_t> head_{0};
+  // Write position, only written by the producer.
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace mixerclient
+}  // namespace istio
+
+#endif  // ISTIO_MIXERCLIENT_SPSC_QUEUE_H
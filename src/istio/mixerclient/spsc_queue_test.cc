@@ -0,0 +1,86 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/mixerclient/spsc_queue.h"
+
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace istio {
+namespace mixerclient {
+namespace {
+
+TEST(SpscQueueTest, TestPushPop) {
+  SpscQueue<int> q(3);
+  EXPECT_TRUE(q.Empty());
+  EXPECT_TRUE(q.Push(1));
+  EXPECT_TRUE(q.Push(2));
+  EXPECT_TRUE(q.Push(3));
+  EXPECT_FALSE(q.Push(4));
+
+  int value;
+  EXPECT_TRUE(q.Pop(&value));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(q.Push(5));
+  EXPECT_TRUE(q.Pop(&value));
+  EXPECT_EQ(value, 2);
+  EXPECT_TRUE(q.Pop(&value));
+  EXPECT_EQ(value, 3);
+  EXPECT_TRUE(q.Pop(&value));
+  EXPECT_EQ(value, 5);
+  EXPECT_FALSE(q.Pop(&value));
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(SpscQueueTest, TestPopReleasesSlot) {
+  SpscQueue<std::shared_ptr<int>> q(2);
+  auto item = std::make_shared<int>(1);
+  EXPECT_TRUE(q.Push(std::shared_ptr<int>(item)));
+  std::shared_ptr<int> value;
+  EXPECT_TRUE(q.Pop(&value));
+  value.reset();
+  EXPECT_EQ(item.use_count(), 1);
+}
+
+TEST(SpscQueueTest, TestTwoThreads) {
+  const int kCount = 10000;
+  SpscQueue<int> q(16);
+  std::thread producer([&q]() {
+    for (int i = 0; i < kCount; ++i) {
+      while (!q.Push(int(i))) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+  while (expected < kCount) {
+    int value;
+    if (q.Pop(&value)) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(q.Empty());
+}
+
+}  // namespace
+}  // namespace mixerclient
+}  // namespace istio
@@ -16,7 +16,8 @@
 #ifndef ISTIO_PREFETCH_CIRCULAR_QUEUE_H_
 #define ISTIO_PREFETCH_CIRCULAR_QUEUE_H_
 
-#include <functional>
+#include <cstddef>
+#include <limits>
 #include <vector>
 
 namespace istio {
@@ -24,13 +25,17 @@ namespace prefetch {
 
 // Define a circular FIFO queue
 // Supported classes should support copy operator.
+// The items are stored in a contiguous array of a power of two size, it
+// doubles when it is full, up to the max size.
 template <class T>
 class CircularQueue {
  public:
-  explicit CircularQueue(int size);
+  // The max size of 0 means the queue grows without a limit.
+  explicit CircularQueue(int size, int max_size = 0);
 
-  // Push an item to the tail
-  void Push(const T& v);
+  // Push an item to the tail. Return false, and the item is not pushed, if
+  // the queue already has max size items.
+  bool Push(const T& v);
 
   // Pop up an item from the head
   void Pop();
@@ -38,40 +43,75 @@ class CircularQueue {
   // Allow modifying the head item.
   T* Head();
 
-  // Calls the fn function for each element from head to tail.
-  void Iterate(std::function<bool(T&)> fn);
+  // Allow modifying the tail item.
+  T* Tail();
+
+  // The number of items.
+  int size() const { return count_; }
+
+  // Calls the fn function for each element from head to tail, until it
+  // returns false. The function is called as bool(T&), and inlined.
+  template <class Fn>
+  void Iterate(Fn fn);
 
  private:
+  // Double the array, moving the items to its start.
+  void Grow();
+
   std::vector<T> nodes_;
-  int head_;
-  int tail_;
-  int count_;
+  size_t mask_;
+  size_t head_;
+  size_t tail_;
+  size_t count_;
+  // The max number of items.
+  size_t max_size_;
 };
 
 template <class T>
-CircularQueue<T>::CircularQueue(int size)
-    : nodes_(size), head_(0), tail_(0), count_(0) {}
+CircularQueue<T>::CircularQueue(int size, int max_size)
+    : head_(0),
+      tail_(0),
+      count_(0),
+      max_size_(max_size > 0 ? max_size : std::numeric_limits<size_t>::max()) {
+  size_t capacity = 1;
+  while (capacity < size_t(size)) {
+    capacity *= 2;
+  }
+  nodes_.resize(capacity);
+  mask_ = capacity - 1;
+}
 
 template <class T>
-void CircularQueue<T>::Push(const T& v) {
-  if (head_ == tail_ && count_ > 0) {
-    size_t size = nodes_.size();
-    nodes_.resize(size * 2);
-    for (int i = 0; i <= head_; i++) {
-      // Use the copy operator of class T
-      nodes_[size + i] = nodes_[i];
-    }
-    tail_ += size;
+void CircularQueue<T>::Grow() {
+  std::vector<T> nodes(nodes_.size() * 2);
+  for (size_t i = 0; i < count_; i++) {
+    // Use the copy operator of class T
+    nodes[i] = nodes_[(head_ + i) & mask_];
+  }
+  nodes_.swap(nodes);
+  mask_ = nodes_.size() - 1;
+  head_ = 0;
+  tail_ = count_;
+}
+
+template <class T>
+bool CircularQueue<T>::Push(const T& v) {
+  if (count_ >= max_size_) {
+    return false;
+  }
+  if (count_ > mask_) {
+    Grow();
   }
   nodes_[tail_] = v;
-  tail_ = (tail_ + 1) % nodes_.size();
+  tail_ = (tail_ + 1) & mask_;
   count_++;
+  return true;
 }
 
 template <class T>
 void CircularQueue<T>::Pop() {
   if (count_ == 0) return;
-  head_ = (head_ + 1) % nodes_.size();
+  head_ = (head_ + 1) & mask_;
   count_--;
 }
 
@@ -82,12 +122,16 @@ T* CircularQueue<T>::Head() {
 }
 
 template <class T>
-void CircularQueue<T>::Iterate(std::function<bool(T&)> fn) {
-  if (count_ == 0) return;
-  int i = head_;
-  while (i != tail_) {
-    if (!fn(nodes_[i])) return;
-    i = (i + 1) % nodes_.size();
+T* CircularQueue<T>::Tail() {
+  if (count_ == 0) return nullptr;
+  return &nodes_[(tail_ - 1) & mask_];
+}
+
+template <class T>
+template <class Fn>
+void CircularQueue<T>::Iterate(Fn fn) {
+  for (size_t i = 0; i < count_; i++) {
+    if (!fn(nodes_[(head_ + i) & mask_])) return;
   }
 }
 
@@ -0,0 +1,153 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/istio/prefetch/circular_queue.h"
+
+namespace istio {
+namespace prefetch {
+namespace {
+
+// The previous queue, iterated through std::function, for comparison.
+template <class T>
+class LegacyCircularQueue {
+ public:
+  explicit LegacyCircularQueue(int size, int = 0)
+      : nodes_(size), head_(0), tail_(0), count_(0) {}
+
+  bool Push(const T& v) {
+    if (head_ == tail_ && count_ > 0) {
+      size_t size = nodes_.size();
+      nodes_.resize(size * 2);
+      for (int i = 0; i <= head_; i++) {
+        nodes_[size + i] = nodes_[i];
+      }
+      tail_ += size;
+    }
+    nodes_[tail_] = v;
+    tail_ = (tail_ + 1) % nodes_.size();
+    count_++;
+    return true;
+  }
+
+  void Pop() {
+    if (count_ == 0) return;
+    head_ = (head_ + 1) % nodes_.size();
+    count_--;
+  }
+
+  T* Head() {
+    if (count_ == 0) return nullptr;
+    return &nodes_[head_];
+  }
+
+  void Iterate(std::function<bool(T&)> fn) {
+    if (count_ == 0) return;
+    int i = head_;
+    while (i != tail_) {
+      if (!fn(nodes_[i])) return;
+      i = (i + 1) % nodes_.size();
+    }
+  }
+
+ private:
+  std::vector<T> nodes_;
+  int head_;
+  int tail_;
+  int count_;
+};
+
+// The same as the QuotaPrefetch slot.
+struct Slot {
+  int available;
+  std::chrono::time_point<std::chrono::system_clock> expire_time;
+  uint64_t id;
+};
+
+const int kInitQueueSize = 16;
+
+// Prefetched slots added and used up, as Add() and Substract() do.
+template <class Queue>
+void BM_PushPop(benchmark::State& state) {
+  Queue queue(kInitQueueSize, 1024);
+  const int slots = state.range(0);
+  uint64_t id = 0;
+  for (int i = 0; i < slots; ++i) {
+    queue.Push(Slot{10, {}, ++id});
+  }
+  for (auto _ : state) {
+    queue.Push(Slot{10, {}, ++id});
+    benchmark::DoNotOptimize(queue.Head());
+    queue.Pop();
+  }
+}
+
+// Sum of available amounts, as CountAvailable() does on every check.
+template <class Queue>
+void BM_IterateAll(benchmark::State& state) {
+  Queue queue(kInitQueueSize, 1024);
+  const int slots = state.range(0);
+  for (int i = 0; i < slots; ++i) {
+    queue.Push(Slot{i, {}, uint64_t(i)});
+  }
+  for (auto _ : state) {
+    int avail = 0;
+    queue.Iterate([&](Slot& slot) -> bool {
+      avail += slot.available;
+      return true;
+    });
+    benchmark::DoNotOptimize(avail);
+  }
+}
+
+// Find the slot by id, as FindSlotById() does on every response.
+template <class Queue>
+void BM_FindById(benchmark::State& state) {
+  Queue queue(kInitQueueSize, 1024);
+  const int slots = state.range(0);
+  for (int i = 0; i < slots; ++i) {
+    queue.Push(Slot{i, {}, uint64_t(i)});
+  }
+  const uint64_t target = slots / 2;
+  for (auto _ : state) {
+    Slot* found = nullptr;
+    queue.Iterate([&](Slot& slot) -> bool {
+      if (slot.id == target) {
+        found = &slot;
+        return false;
+      }
+      return true;
+    });
+    benchmark::DoNotOptimize(found);
+  }
+}
+
+// Below the initial size, the legacy queue does not visit a full array.
+BENCHMARK_TEMPLATE(BM_PushPop, LegacyCircularQueue<Slot>)->Arg(2)->Arg(12);
+BENCHMARK_TEMPLATE(BM_PushPop, CircularQueue<Slot>)->Arg(2)->Arg(12);
+BENCHMARK_TEMPLATE(BM_IterateAll, LegacyCircularQueue<Slot>)->Arg(2)->Arg(12);
+BENCHMARK_TEMPLATE(BM_IterateAll, CircularQueue<Slot>)->Arg(2)->Arg(12);
+BENCHMARK_TEMPLATE(BM_FindById, LegacyCircularQueue<Slot>)->Arg(2)->Arg(12);
+BENCHMARK_TEMPLATE(BM_FindById, CircularQueue<Slot>)->Arg(2)->Arg(12);
+
+}  // namespace
+}  // namespace prefetch
+}  // namespace istio
+
+BENCHMARK_MAIN();
@@ -69,6 +69,44 @@ TEST(CircularQueueTest, TestResize2) {
   ASSERT_RESULT(q, {3, 4, 5, 6, 7, 8, 9});
 }
 
+TEST(CircularQueueTest, TestFull) {
+  CircularQueue<int> q(4);
+  for (int i = 1; i < 5; i++) {
+    q.Push(i);
+  }
+  // All items are visited when the array is full.
+  ASSERT_RESULT(q, {1, 2, 3, 4});
+  EXPECT_EQ(*q.Head(), 1);
+  EXPECT_EQ(*q.Tail(), 4);
+}
+
+TEST(CircularQueueTest, TestMaxSize) {
+  CircularQueue<int> q(2, 5);
+  for (int i = 1; i < 6; i++) {
+    EXPECT_TRUE(q.Push(i));
+  }
+  EXPECT_FALSE(q.Push(6));
+  ASSERT_RESULT(q, {1, 2, 3, 4, 5});
+
+  q.Pop();
+  EXPECT_TRUE(q.Push(6));
+  EXPECT_EQ(q.size(), 5);
+  ASSERT_RESULT(q, {2, 3, 4, 5, 6});
+}
+
+TEST(CircularQueueTest, TestStopIterate) {
+  CircularQueue<int> q(3);
+  for (int i = 1; i < 6; i++) {
+    q.Push(i);
+  }
+  std::vector<int> v;
+  q.Iterate([&](int& i) -> bool {
+    v.push_back(i);
+    return i < 3;
+  });
+  ASSERT_EQ(v, std::vector<int>({1, 2, 3}));
+}
+
 }  // namespace
 }  // namespace prefetch
 }  // namespace istio
@@ -0,0 +1,171 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/istio/prefetch/demand_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "src/istio/prefetch/time_based_counter.h"
+
+using namespace std::chrono;
+
+namespace istio {
+namespace prefetch {
+namespace {
+
+// TimeBasedCounter window size
+const int kTimeBasedWindowSize = 20;
+
+// Default EWMA sample interval in milliseconds.
+const int kEwmaIntervalInMs = 50;
+
+// Default EWMA sample weight.
+const double kEwmaWeight = 0.2;
+
+// Default number of standard deviations added to the rate.
+const double kEwmaDeviations = 2.0;
+
+// Default time to cover before a round trip is measured, in milliseconds.
+const int kInitialRoundTripInMs = 500;
+
+// Default min prefetch amount.
+const int kMinPrefetchAmount = 10;
+
+// Idle intervals after which the rate is restarted.
+const int kEwmaMaxIdleIntervals = 100;
+
+class WindowCountEstimator : public DemandEstimator {
+ public:
+  WindowCountEstimator(milliseconds predict_window, int min_amount, Tick t)
+      : counter_(kTimeBasedWindowSize, predict_window, t),
+        min_amount_(min_amount) {}
+
+  void Inc(int amount, Tick t) override { counter_.Inc(amount, t); }
+
+  void OnResponse(milliseconds, Tick) override {}
+
+  int Desired(int extra, Tick t) override {
+    return std::max(counter_.Count(t) + extra, min_amount_);
+  }
+
+  Tick NextUpdate() const override { return counter_.RollTime(); }
+
+ private:
+  // The counter to count number of requests in the pass window.
+  TimeBasedCounter counter_;
+  int min_amount_;
+};
+
+class EwmaRateEstimator : public DemandEstimator {
+ public:
+  EwmaRateEstimator(const EwmaRateOptions& options, Tick t)
+      : options_(options),
+        interval_end_(t + options.interval),
+        round_trip_(options.initial_round_trip.count()) {}
+
+  void Inc(int amount, Tick t) override {
+    Roll(t);
+    count_ += amount;
+  }
+
+  void OnResponse(milliseconds round_trip, Tick) override {
+    if (!has_round_trip_) {
+      has_round_trip_ = true;
+      round_trip_ = round_trip.count();
+    } else {
+      round_trip_ += options_.weight * (round_trip.count() - round_trip_);
+    }
+  }
+
+  int Desired(int extra, Tick t) override {
+    Roll(t);
+    // Per millisecond rates. The rate of the current interval so far is a
+    // lower bound, it catches up with a burst before the interval ends.
+    double rate = mean_ + options_.deviations * std::sqrt(variance_);
+    rate = std::max(rate, double(count_ + extra) / options_.interval.count());
+    int desired = int(std::ceil(rate * 2 * round_trip_));
+    return std::max(desired, options_.min_amount);
+  }
+
+  Tick NextUpdate() const override { return interval_end_; }
+
+ private:
+  // Close the intervals ended by t.
+  void Roll(Tick t) {
+    if (t < interval_end_) {
+      return;
+    }
+    int intervals = 1 + (t - interval_end_) / options_.interval;
+    if (intervals > kEwmaMaxIdleIntervals) {
+      has_sample_ = false;
+      mean_ = variance_ = 0;
+    } else {
+      for (int i = 0; i < intervals; ++i) {
+        Sample(double(count_) / options_.interval.count());
+        count_ = 0;
+      }
+    }
+    count_ = 0;
+    interval_end_ += intervals * options_.interval;
+  }
+
+  void Sample(double rate) {
+    if (!has_sample_) {
+      has_sample_ = true;
+      mean_ = rate;
+      return;
+    }
+    double diff = rate - mean_;
+    mean_ += options_.weight * diff;
+    variance_ =
+        (1 - options_.weight) * (variance_ + options_.weight * diff * diff);
+  }
+
+  EwmaRateOptions options_;
+  // The amount checked in the current interval.
+  int count_{0};
+  Tick interval_end_;
+  // The average and variance of the per millisecond rate.
+  bool has_sample_{false};
+  double mean_{0};
+  double variance_{0};
+  // The average round trip in milliseconds.
+  bool has_round_trip_{false};
+  double round_trip_;
+};
+
+}  // namespace
+
+DemandEstimator::EwmaRateOptions::EwmaRateOptions()
+    : interval(kEwmaIntervalInMs),
+      weight(kEwmaWeight),
+      deviations(kEwmaDeviations),
+      initial_round_trip(kInitialRoundTripInMs),
+      min_amount(kMinPrefetchAmount) {}
+
+std::unique_ptr<DemandEstimator> DemandEstimator::CreateWindowCount(
+    milliseconds predict_window, int min_amount, Tick t) {
+  return std::unique_ptr<DemandEstimator>(
+      new WindowCountEstimator(predict_window, min_amount, t));
+}
+
+std::unique_ptr<DemandEstimator> DemandEstimator::CreateEwmaRate(
+    const EwmaRateOptions& options, Tick t) {
+  return std::unique_ptr<DemandEstimator>(new EwmaRateEstimator(options, t));
+}
+
+}  // namespace prefetch
+}  // namespace istio
@@ -0,0 +1,76 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/istio/prefetch/demand_estimator.h"
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono;
+
+namespace istio {
+namespace prefetch {
+namespace {
+
+DemandEstimator::Tick FakeTime(int t) {
+  return DemandEstimator::Tick(milliseconds(t));
+}
+
+TEST(DemandEstimatorTest, TestWindowCount) {
+  auto estimator =
+      DemandEstimator::CreateWindowCount(milliseconds(1000), 10, FakeTime(0));
+  EXPECT_EQ(estimator->Desired(0, FakeTime(0)), 10);
+  EXPECT_EQ(estimator->NextUpdate(), FakeTime(50));
+
+  estimator->Inc(30, FakeTime(10));
+  EXPECT_EQ(estimator->Desired(0, FakeTime(20)), 30);
+  EXPECT_EQ(estimator->Desired(5, FakeTime(20)), 35);
+
+  // The count is out of the window.
+  EXPECT_EQ(estimator->Desired(0, FakeTime(1100)), 10);
+  EXPECT_EQ(estimator->NextUpdate(), FakeTime(1150));
+}
+
+TEST(DemandEstimatorTest, TestEwmaRate) {
+  DemandEstimator::EwmaRateOptions options;
+  auto estimator = DemandEstimator::CreateEwmaRate(options, FakeTime(0));
+  EXPECT_EQ(estimator->Desired(0, FakeTime(0)), options.min_amount);
+
+  // A steady rate of one per millisecond.
+  int t = 0;
+  for (; t < 1000; ++t) {
+    estimator->Inc(1, FakeTime(t));
+  }
+  // Until a round trip is measured, cover two initial round trips.
+  EXPECT_EQ(estimator->Desired(0, FakeTime(t)), 1000);
+
+  estimator->OnResponse(milliseconds(20), FakeTime(t));
+  EXPECT_EQ(estimator->Desired(0, FakeTime(t)), 40);
+  EXPECT_EQ(estimator->NextUpdate(), FakeTime(1050));
+
+  // A burst in the current interval is covered before the interval ends.
+  estimator->Inc(500, FakeTime(t));
+  EXPECT_EQ(estimator->Desired(0, FakeTime(t)), 400);
+  EXPECT_EQ(estimator->Desired(500, FakeTime(t)), 800);
+
+  // The burst raises the average and adds variance.
+  EXPECT_GT(estimator->Desired(0, FakeTime(t + 50)), 40);
+
+  // The rate is restarted after a long idle time.
+  EXPECT_EQ(estimator->Desired(0, FakeTime(t + 60000)), options.min_amount);
+}
+
+}  // namespace
+}  // namespace prefetch
+}  // namespace istio
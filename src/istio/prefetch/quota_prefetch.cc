@@ -15,10 +15,10 @@
 
 #include "include/istio/prefetch/quota_prefetch.h"
 
+#include <atomic>
 #include <mutex>
 
 #include "src/istio/prefetch/circular_queue.h"
-#include "src/istio/prefetch/time_based_counter.h"
 #include "src/istio/utils/logger.h"
 
 using namespace std::chrono;
@@ -37,10 +37,10 @@ const int kMinPrefetchAmount = 10;
 const int kCloseWaitWindowInMs = 500;
 
 // Initiail Circular Queue size for prefetch pool.
-const int kInitQueueSize = 10;
+const int kInitQueueSize = 16;
 
-// TimeBasedCounter window size
-const int kTimeBasedWindowSize = 20;
+// Max Circular Queue size for prefetch pool.
+const int kMaxQueueSize = 1024;
 
 // Maximum expiration for prefetch amount.
 // It is only used when a prefetch amount is added to the pool
@@ -70,42 +70,69 @@ class QuotaPrefetchImpl : public QuotaPrefetch {
   };
 
   QuotaPrefetchImpl(TransportFunc transport, const Options& options, Tick t)
-      : queue_(kInitQueueSize),
-        counter_(kTimeBasedWindowSize, options.predict_window, t),
+      : queue_(kInitQueueSize, kMaxQueueSize),
+        estimator_(options.create_estimator
+                       ? options.create_estimator(t)
+                       : DemandEstimator::CreateWindowCount(
+                             options.predict_window,
+                             options.min_prefetch_amount, t)),
         mode_(OPEN),
         inflight_count_(0),
         transport_(transport),
         options_(options),
         next_slot_id_(0) {}
 
-  bool Check(int amount, Tick t) override;
+  bool Check(int amount, Tick t) override {
+    return Check(amount, transport_, t);
+  }
+
+  bool Check(int amount, TransportFunc transport, Tick t) override;
+
+  void MergeInto(const std::shared_ptr<QuotaPrefetch>& other,
+                 Tick t) override;
 
  private:
+  // Take the amount from the published available amount without locking.
+  bool FastCheck(int amount, Tick t);
+  // Take back the amount published for fast checks, and charge the slots
+  // and the estimator for what fast checks have used.
+  void Reclaim();
+  // Publish the available amount for fast checks.
+  void Publish(Tick t);
   // Count available token
   int CountAvailable(Tick t);
   // Check available count is bigger than minimum
   int CheckMinAvailable(int min, Tick t);
   // Check to see if need to do a prefetch.
-  void AttemptPrefetch(int amount, Tick t);
+  void AttemptPrefetch(int amount, const TransportFunc& transport, Tick t);
   // Make a prefetch call.
-  void Prefetch(int req_amount, bool use_not_granted, Tick t);
-  // Add the amount to the queue, and return slot id.
+  void Prefetch(int req_amount, bool use_not_granted,
+                const TransportFunc& transport, Tick t);
+  // Return true if checks can take the first amount available without a
+  // prefetch.
+  bool CanTakeWithoutPrefetch(int amount, int avail, Tick t);
+  // Add the amount to the queue, and return slot id. If the queue is full,
+  // the amount is merged into the last slot, which takes the new id.
   SlotId Add(int amount, Tick expiration);
   // Substract the amount from the queue.
   // Return the amount that could not be substracted.
   int Substract(int delta, Tick t);
   // On quota allocation response.
   void OnResponse(SlotId slot_id, int req_amount, int resp_amount,
-                  milliseconds expiration, Tick t);
+                  milliseconds expiration, Tick sent_time, Tick t);
   // Find the slot by id.
   Slot* FindSlotById(SlotId id);
+  // Move the available amount to merged_into_.
+  void MoveAvailable(Tick t);
+  // Add an amount moved from a merged object, or substract it if negative.
+  void Receive(int amount, Tick expire_time, Tick t);
 
   // The mutex guarding all member variables.
   std::mutex mutex_;
   // The FIFO queue to store prefetched amount.
   CircularQueue<Slot> queue_;
-  // The counter to count number of requests in the pass window.
-  TimeBasedCounter counter_;
+  // The estimator to size prefetch requests.
+  std::unique_ptr<DemandEstimator> estimator_;
   // The current mode.
   Mode mode_;
   // Last prefetch time.
@@ -118,6 +145,21 @@ class QuotaPrefetchImpl : public QuotaPrefetch {
   Options options_;
   // next slot id
   SlotId next_slot_id_;
+  // The object this one is merged into, if any.
+  std::shared_ptr<QuotaPrefetchImpl> merged_into_;
+
+  // The amount published for fast checks, and when.
+  int published_{0};
+  Tick published_time_;
+
+  // The state read by fast checks, written under the mutex. A fast check
+  // takes from fast_available_, the amount that can be checked without a
+  // prefetch, until fast_expire_time_, when a slot expires or the estimate
+  // is updated.
+  std::atomic<int> fast_available_{0};
+  std::atomic<Tick::rep> fast_expire_time_{0};
+  // The amount taken by fast checks, not given to estimator_ yet.
+  std::atomic<int> fast_count_{0};
 };
 
 int QuotaPrefetchImpl::CountAvailable(Tick t) {
@@ -143,7 +185,81 @@ int QuotaPrefetchImpl::CheckMinAvailable(int min, Tick t) {
   return avail >= min;
 }
 
-void QuotaPrefetchImpl::AttemptPrefetch(int amount, Tick t) {
+bool QuotaPrefetchImpl::FastCheck(int amount, Tick t) {
+  // Read the available amount first, the expire time is published before
+  // it.
+  int avail = fast_available_;
+  if (t.time_since_epoch().count() >= fast_expire_time_) {
+    return false;
+  }
+  while (avail >= amount) {
+    if (fast_available_.compare_exchange_weak(avail, avail - amount)) {
+      fast_count_ += amount;
+      return true;
+    }
+  }
+  return false;
+}
+
+void QuotaPrefetchImpl::Reclaim() {
+  int used = published_ - fast_available_.exchange(0);
+  published_ = 0;
+  if (used > 0) {
+    // Fast checks did not use any amount expired at the publish time.
+    Substract(used, published_time_);
+  }
+  int count = fast_count_.exchange(0);
+  if (count > 0) {
+    // Fast checks only run before the estimate is updated.
+    estimator_->Inc(count, published_time_);
+  }
+}
+
+bool QuotaPrefetchImpl::CanTakeWithoutPrefetch(int amount, int avail,
+                                               Tick t) {
+  // Same as AttemptPrefetch(), for the check that starts after the amount
+  // before it has been taken.
+  int taken = amount - 1;
+  return inflight_count_ > 0 ||
+         avail - taken >= estimator_->Desired(taken, t) / 2;
+}
+
+void QuotaPrefetchImpl::Publish(Tick t) {
+  int avail = 0;
+  Tick expire_time = estimator_->NextUpdate();
+  queue_.Iterate([&](Slot& slot) -> bool {
+    if (t < slot.expire_time) {
+      avail += slot.available;
+      expire_time = std::min(expire_time, slot.expire_time);
+    }
+    return true;
+  });
+
+  // Find the largest amount checks can take without a prefetch, the
+  // desired amount does not decrease as more amount is checked.
+  int low = 0;
+  int high = avail;
+  while (low < high) {
+    int mid = low + (high - low + 1) / 2;
+    if (CanTakeWithoutPrefetch(mid, avail, t)) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+  if (low <= 0) {
+    return;
+  }
+
+  published_ = low;
+  published_time_ = t;
+  fast_expire_time_ = expire_time.time_since_epoch().count();
+  fast_available_ = low;
+}
+
+void QuotaPrefetchImpl::AttemptPrefetch(int amount,
+                                        const TransportFunc& transport,
+                                        Tick t) {
   if (mode_ == CLOSE && (inflight_count_ > 0 ||
                          (duration_cast<milliseconds>(t - last_prefetch_time_) <
                           options_.close_wait_window))) {
@@ -151,19 +267,19 @@ void QuotaPrefetchImpl::AttemptPrefetch(int amount, Tick t) {
   }
 
   int avail = CountAvailable(t);
-  int pass_count = counter_.Count(t);
-  int desired = std::max(pass_count, options_.min_prefetch_amount);
+  int desired = estimator_->Desired(0, t);
   MIXER_TRACE(
       "Prefetch decision: available=%d, desired=%d, inflight_count=%d, "
       "requested=%d",
       avail, desired, inflight_count_, amount);
   if ((avail < desired / 2 && inflight_count_ == 0) || avail < amount) {
     bool use_not_granted = (avail == 0 && mode_ == OPEN);
-    Prefetch(std::max(amount, desired), use_not_granted, t);
+    Prefetch(std::max(amount, desired), use_not_granted, transport, t);
   }
 }
 
-void QuotaPrefetchImpl::Prefetch(int req_amount, bool use_not_granted, Tick t) {
+void QuotaPrefetchImpl::Prefetch(int req_amount, bool use_not_granted,
+                                 const TransportFunc& transport, Tick t) {
   SlotId slot_id = 0;
   if (use_not_granted) {
     // add the prefetch amount to available queue before it is granted.
@@ -174,11 +290,11 @@ void QuotaPrefetchImpl::Prefetch(int req_amount, bool use_not_granted, Tick t) {
 
   last_prefetch_time_ = t;
   ++inflight_count_;
-  transport_(
+  transport(
       req_amount,
-      [this, slot_id, req_amount](int resp_amount, milliseconds expiration,
-                                  Tick t1) {
-        OnResponse(slot_id, req_amount, resp_amount, expiration, t1);
+      [this, slot_id, req_amount, t](int resp_amount,
+                                     milliseconds expiration, Tick t1) {
+        OnResponse(slot_id, req_amount, resp_amount, expiration, t, t1);
       },
       t);
 }
@@ -197,7 +313,16 @@ QuotaPrefetchImpl::Slot* QuotaPrefetchImpl::FindSlotById(SlotId id) {
 
 QuotaPrefetchImpl::SlotId QuotaPrefetchImpl::Add(int amount, Tick expire_time) {
   SlotId id = ++next_slot_id_;
-  queue_.Push(Slot{amount, expire_time, id});
+  if (!queue_.Push(Slot{amount, expire_time, id})) {
+    // The queue is full, merge the amount into the last slot with the
+    // earlier expiration. The slot takes the new id, so it is not found by
+    // the id of a prefetch merged before, whose response then adjusts the
+    // oldest amounts instead.
+    Slot* tail = queue_.Tail();
+    tail->available += amount;
+    tail->expire_time = std::min(tail->expire_time, expire_time);
+    tail->id = id;
+  }
   return id;
 }
 
@@ -226,9 +351,11 @@ int QuotaPrefetchImpl::Substract(int delta, Tick t) {
 
 void QuotaPrefetchImpl::OnResponse(SlotId slot_id, int req_amount,
                                    int resp_amount, milliseconds expiration,
-                                   Tick t) {
+                                   Tick sent_time, Tick t) {
   std::lock_guard<std::mutex> lock(mutex_);
+  Reclaim();
   --inflight_count_;
+  estimator_->OnResponse(duration_cast<milliseconds>(t - sent_time), t);
 
   MIXER_DEBUG("OnResponse: req: %d, resp: %d, expire: %ld, id: %lu", req_amount,
               resp_amount, expiration.count(), slot_id);
@@ -254,7 +381,11 @@ void QuotaPrefetchImpl::OnResponse(SlotId slot_id, int req_amount,
       }
       if (delta > 0) {
         // Substract it from other prefetched amounts
-        Substract(delta, t);
+        delta = Substract(delta, t);
+      }
+      if (delta > 0 && merged_into_) {
+        // The amount was moved before it was denied.
+        merged_into_->Receive(-delta, t, t);
       }
     }
     // Adjust the expiration
@@ -273,13 +404,53 @@ void QuotaPrefetchImpl::OnResponse(SlotId slot_id, int req_amount,
   } else {
     mode_ = CLOSE;
   }
+  if (merged_into_) {
+    MoveAvailable(t);
+    return;
+  }
+  Publish(t);
+}
+
+void QuotaPrefetchImpl::MergeInto(const std::shared_ptr<QuotaPrefetch>& other,
+                                  Tick t) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Reclaim();
+  merged_into_ = std::static_pointer_cast<QuotaPrefetchImpl>(other);
+  MoveAvailable(t);
+}
+
+void QuotaPrefetchImpl::MoveAvailable(Tick t) {
+  Slot* n = queue_.Head();
+  while (n != nullptr) {
+    if (t < n->expire_time && n->available > 0) {
+      merged_into_->Receive(n->available, n->expire_time, t);
+    }
+    queue_.Pop();
+    n = queue_.Head();
+  }
 }
 
-bool QuotaPrefetchImpl::Check(int amount, Tick t) {
+void QuotaPrefetchImpl::Receive(int amount, Tick expire_time, Tick t) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Reclaim();
+  if (amount > 0) {
+    Add(amount, expire_time);
+  } else {
+    Substract(-amount, t);
+  }
+  Publish(t);
+}
+
+bool QuotaPrefetchImpl::Check(int amount, TransportFunc transport, Tick t) {
+  if (FastCheck(amount, t)) {
+    return true;
+  }
+
   std::lock_guard<std::mutex> lock(mutex_);
+  Reclaim();
 
-  AttemptPrefetch(amount, t);
-  counter_.Inc(amount, t);
+  AttemptPrefetch(amount, transport, t);
+  estimator_->Inc(amount, t);
   bool ret;
   if (amount == 1) {
     ret = Substract(amount, t) == 0;
@@ -292,6 +463,7 @@ bool QuotaPrefetchImpl::Check(int amount, Tick t) {
   if (!ret) {
     MIXER_DEBUG("Rejected amount: %d", amount);
   }
+  Publish(t);
   return ret;
 }
 
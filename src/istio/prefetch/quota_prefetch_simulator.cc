@@ -0,0 +1,214 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays traffic traces through QuotaPrefetch with simulated time, and
+// compares the demand estimators by remote calls and rejections.
+//
+// Usage: quota_prefetch_simulator [trace_file ...]
+// A trace file has one request per line, its time in milliseconds from the
+// start. Without trace files, generated traces are used. All runs are
+// deterministic.
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "include/istio/prefetch/quota_prefetch.h"
+
+using namespace std::chrono;
+using ::istio::prefetch::DemandEstimator;
+using ::istio::prefetch::QuotaPrefetch;
+using Tick = QuotaPrefetch::Tick;
+
+namespace istio {
+namespace prefetch {
+namespace {
+
+// Request times in milliseconds.
+struct Trace {
+  std::string name;
+  std::vector<int> times;
+};
+
+// The rate limit of the server, per second.
+const int kRateLimit = 100;
+
+// The trace duration in milliseconds.
+const int kDurationInMs = 60000;
+
+// Random arrivals with the rate per second given by the time, at most one
+// per millisecond.
+Trace Generate(const std::string& name, std::function<double(int)> rate) {
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> dist(0, 1);
+  Trace trace{name, {}};
+  for (int t = 0; t < kDurationInMs; ++t) {
+    if (dist(gen) < rate(t) / 1000.0) {
+      trace.times.push_back(t);
+    }
+  }
+  return trace;
+}
+
+std::vector<Trace> GenerateTraces() {
+  return {
+      Generate("steady_50%", [](int) { return kRateLimit * 0.5; }),
+      Generate("steady_150%", [](int) { return kRateLimit * 1.5; }),
+      // 1 second bursts at 4 times the limit, every 5 seconds.
+      Generate("bursty",
+               [](int t) { return t % 5000 < 1000 ? kRateLimit * 4.0 : 0; }),
+      // From idle to twice the limit.
+      Generate("ramp",
+               [](int t) { return 2.0 * kRateLimit * t / kDurationInMs; }),
+  };
+}
+
+bool ReadTrace(const std::string& file, Trace* trace) {
+  std::ifstream in(file);
+  if (!in) {
+    return false;
+  }
+  trace->name = file;
+  int t;
+  while (in >> t) {
+    trace->times.push_back(t);
+  }
+  return true;
+}
+
+// A rolling window rate limit server.
+class RateServer {
+ public:
+  RateServer(Tick t) : expire_time_(t) {}
+
+  int Alloc(int amount, milliseconds* expire, Tick t) {
+    if (t >= expire_time_) {
+      avail_ = kRateLimit;
+      expire_time_ = t + seconds(1);
+    }
+    int granted = std::min(amount, avail_);
+    avail_ -= granted;
+    *expire = duration_cast<milliseconds>(expire_time_ - t);
+    return granted;
+  }
+
+ private:
+  int avail_{0};
+  Tick expire_time_;
+};
+
+struct Result {
+  int passed{0};
+  int remote_calls{0};
+};
+
+Result Run(const Trace& trace, milliseconds round_trip,
+           const QuotaPrefetch::Options& options) {
+  Tick start;
+  RateServer server(start);
+  Result result;
+  // Pending responses by their delivery time.
+  std::list<std::pair<Tick, std::function<void(Tick)>>> pending;
+  auto client = QuotaPrefetch::Create(
+      [&](int amount, QuotaPrefetch::DoneFunc fn, Tick t) {
+        ++result.remote_calls;
+        pending.emplace_back(t + round_trip, [&server, amount, fn](Tick t1) {
+          milliseconds expire;
+          int granted = server.Alloc(amount, &expire, t1);
+          fn(granted, expire, t1);
+        });
+      },
+      options, start);
+
+  for (int time : trace.times) {
+    Tick t = start + milliseconds(time);
+    while (!pending.empty() && pending.front().first <= t) {
+      auto fn = std::move(pending.front().second);
+      Tick t1 = pending.front().first;
+      pending.pop_front();
+      fn(t1);
+    }
+    if (client->Check(1, t)) {
+      ++result.passed;
+    }
+  }
+  return result;
+}
+
+// The passed count if every request called the server.
+int RunIdeal(const Trace& trace) {
+  Tick start;
+  RateServer server(start);
+  int passed = 0;
+  for (int time : trace.times) {
+    milliseconds expire;
+    passed += server.Alloc(1, &expire, start + milliseconds(time));
+  }
+  return passed;
+}
+
+void Simulate(const Trace& trace) {
+  int ideal = RunIdeal(trace);
+  for (int round_trip : {10, 200}) {
+    QuotaPrefetch::Options window;
+    QuotaPrefetch::Options ewma;
+    ewma.create_estimator = [](Tick t) {
+      return DemandEstimator::CreateEwmaRate(
+          DemandEstimator::EwmaRateOptions(), t);
+    };
+    for (const auto& it : {std::make_pair("window", window),
+                           std::make_pair("ewma", ewma)}) {
+      Result result = Run(trace, milliseconds(round_trip), it.second);
+      int requests = trace.times.size();
+      printf("%-12s %6dms %-8s %8d %8d %8d %8.2f%% %8.2f%% %8d\n",
+             trace.name.c_str(), round_trip, it.first, requests,
+             result.passed, ideal,
+             100.0 * (requests - result.passed) / requests,
+             100.0 * (requests - ideal) / requests, result.remote_calls);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace prefetch
+}  // namespace istio
+
+int main(int argc, char** argv) {
+  std::vector<istio::prefetch::Trace> traces;
+  for (int i = 1; i < argc; ++i) {
+    istio::prefetch::Trace trace;
+    if (!istio::prefetch::ReadTrace(argv[i], &trace)) {
+      fprintf(stderr, "Failed to read trace: %s\n", argv[i]);
+      return 1;
+    }
+    traces.push_back(std::move(trace));
+  }
+  if (traces.empty()) {
+    traces = istio::prefetch::GenerateTraces();
+  }
+
+  printf("%-12s %8s %-8s %8s %8s %8s %9s %9s %8s\n", "trace", "rtt",
+         "estimator", "requests", "passed", "ideal", "rejected",
+         "ideal_rej", "calls");
+  for (const auto& trace : traces) {
+    istio::prefetch::Simulate(trace);
+  }
+  return 0;
+}
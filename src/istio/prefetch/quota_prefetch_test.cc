@@ -15,8 +15,11 @@
 
 #include "include/istio/prefetch/quota_prefetch.h"
 
+#include <atomic>
 #include <list>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -418,6 +421,95 @@ TEST_F(QuotaPrefetchTest, TestNotEnoughAmount) {
   delay_.OnTimer(t);
 }
 
+TEST_F(QuotaPrefetchTest, TestConcurrentChecks) {
+  Tick t;
+  QuotaPrefetch::Options options;
+  options.min_prefetch_amount = 100;
+  auto client = QuotaPrefetch::Create(GetTransportFunc(), options, t);
+  // Only 99 of the 100 prefetched are granted, the client does not prefetch
+  // again in the close wait window.
+  rate_server_ = std::unique_ptr<RateServer>(
+      new RollingWindow(99, milliseconds(60000), t));
+
+  EXPECT_TRUE(client->Check(1, t));
+  delay_.OnTimer(t);
+  t += milliseconds(1);
+
+  std::atomic<int> passed{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 100; ++j) {
+        if (client->Check(1, t)) {
+          ++passed;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Exactly the rest of the granted amount is used, by lock-free checks
+  // until half of the prefetch amount is left, then by locked checks.
+  EXPECT_EQ(passed, 98);
+}
+
+// A rate limit server granting one at a time.
+class OneAtATime : public RateServer {
+ public:
+  OneAtATime() : RateServer(1, milliseconds(3600000)) {}
+
+  int Alloc(int, milliseconds* expire, Tick) override {
+    *expire = window_;
+    return 1;
+  }
+};
+
+TEST_F(QuotaPrefetchTest, TestFullQueue) {
+  Tick t;
+  QuotaPrefetch::Options options;
+  options.close_wait_window = milliseconds(0);
+  auto client = QuotaPrefetch::Create(GetTransportFunc(), options, t);
+  rate_server_ = std::unique_ptr<RateServer>(new OneAtATime());
+
+  EXPECT_TRUE(client->Check(1, t));
+  delay_.OnTimer(t);
+
+  // Every check is larger than available, each adds a slot of 1 until the
+  // queue is full, then the amounts are merged into the last slot.
+  const int kSlots = 1100;
+  for (int i = 0; i < kSlots; ++i) {
+    EXPECT_FALSE(client->Check(kSlots + 1, t));
+    delay_.OnTimer(t);
+  }
+  EXPECT_TRUE(client->Check(kSlots, t));
+}
+
+TEST_F(QuotaPrefetchTest, TestMergeInto) {
+  Tick t;
+  QuotaPrefetch::Options options;
+  options.min_prefetch_amount = 100;
+  std::shared_ptr<QuotaPrefetch> target =
+      QuotaPrefetch::Create(GetTransportFunc(), options, t);
+  std::shared_ptr<QuotaPrefetch> client =
+      QuotaPrefetch::Create(GetTransportFunc(), options, t);
+  // The target is granted its 100, the client only 50 of its 100.
+  rate_server_ = std::unique_ptr<RateServer>(
+      new RollingWindow(150, milliseconds(60000), t));
+
+  EXPECT_TRUE(target->Check(1, t));
+  EXPECT_TRUE(client->Check(1, t));
+  // The client is merged before its prefetch response arrives.
+  client->MergeInto(target, t);
+  delay_.OnTimer(t);
+
+  // 99 left of the target's and 49 of the client's.
+  t += milliseconds(1);
+  EXPECT_FALSE(target->Check(149, t));
+  EXPECT_TRUE(target->Check(148, t));
+}
+
 }  // namespace
 }  // namespace prefetch
 }  // namespace istio
@@ -41,6 +41,10 @@ class TimeBasedCounter {
   // Get the count.
   int Count(Tick t);
 
+  // Get the time when the window rolls next, counts can be added with an
+  // earlier time stamp until then.
+  Tick RollTime() const { return last_time_ + slot_duration_; }
+
  private:
   // Clear the whole window
   void Clear(Tick t);
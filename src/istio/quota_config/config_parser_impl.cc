@@ -17,90 +17,133 @@
 
 using ::istio::mixer::v1::Attributes;
 using ::istio::mixer::v1::Attributes_AttributeValue;
-using ::istio::mixer::v1::config::client::AttributeMatch;
-using ::istio::mixer::v1::config::client::QuotaRule;
 using ::istio::mixer::v1::config::client::QuotaSpec;
 using ::istio::mixer::v1::config::client::StringMatch;
 
 namespace istio {
 namespace quota_config {
 
-ConfigParserImpl::ConfigParserImpl(const QuotaSpec& spec_pb)
-    : spec_pb_(spec_pb) {
-  // Build regex map
-  for (const auto& rule : spec_pb_.rules()) {
-    for (const auto& match : rule.match()) {
+ConfigParserImpl::ConfigParserImpl(const QuotaSpec& spec_pb) {
+  for (const auto& rule_pb : spec_pb.rules()) {
+    Rule rule;
+    for (const auto& match : rule_pb.match()) {
+      int index = match_clauses_.size();
+      match_clauses_.push_back(match.clause_size());
+      rule.matches.push_back(index);
       for (const auto& map_it : match.clause()) {
-        const auto& match = map_it.second;
-        if (match.match_type_case() == StringMatch::kRegex) {
-          regex_map_[match.regex()] = std::regex(match.regex());
-        }
+        AddClause(map_it.first, map_it.second, index);
       }
     }
+    for (const auto& quota : rule_pb.quotas()) {
+      rule.requirements.push_back({quota.quota(), quota.charge()});
+    }
+    rules_.push_back(std::move(rule));
   }
 }
 
-void ConfigParserImpl::GetRequirements(
-    const Attributes& attributes, std::vector<Requirement>* results) const {
-  for (const auto& rule : spec_pb_.rules()) {
-    bool matched = false;
-    for (const auto& match : rule.match()) {
-      if (MatchAttributes(match, attributes)) {
-        matched = true;
-        break;
-      }
+void ConfigParserImpl::AddClause(const std::string& name,
+                                 const StringMatch& string_match, int match) {
+  AttributeIndex* index = nullptr;
+  for (auto& it : attributes_) {
+    if (it.name == name) {
+      index = &it;
+      break;
     }
-    // If not match, applies to all requests.
-    if (matched || rule.match_size() == 0) {
-      for (const auto& quota : rule.quotas()) {
-        results->push_back({quota.quota(), quota.charge()});
+  }
+  if (!index) {
+    attributes_.emplace_back();
+    index = &attributes_.back();
+    index->name = name;
+  }
+
+  // Find the predicate of value, or add it.
+  auto find_or_add = [](std::vector<Predicate>* predicates,
+                        const std::string& value) -> Predicate& {
+    for (auto& predicate : *predicates) {
+      if (predicate.value == value) {
+        return predicate;
       }
     }
+    predicates->emplace_back();
+    predicates->back().value = value;
+    return predicates->back();
+  };
+
+  switch (string_match.match_type_case()) {
+    case StringMatch::kExact:
+      index->exact[string_match.exact()].push_back(match);
+      break;
+    case StringMatch::kPrefix:
+      find_or_add(&index->prefixes, string_match.prefix())
+          .matches.push_back(match);
+      break;
+    case StringMatch::kRegex: {
+      Predicate& predicate =
+          find_or_add(&index->regexes, string_match.regex());
+      if (predicate.matches.empty()) {
+        predicate.regex = std::regex(string_match.regex());
+      }
+      predicate.matches.push_back(match);
+    } break;
+    default:
+      // match_type not set case, an empty StringMatch, only requires the
+      // attribute.
+      index->any.push_back(match);
+      break;
   }
 }
 
-bool ConfigParserImpl::MatchAttributes(const AttributeMatch& match,
-                                       const Attributes& attributes) const {
-  const auto& attributes_map = attributes.attributes();
-  for (const auto& map_it : match.clause()) {
-    // map is attribute_name to StringMatch.
-    const std::string& name = map_it.first;
-    const auto& match = map_it.second;
+void ConfigParserImpl::GetRequirements(
+    const Attributes& attributes, std::vector<Requirement>* results) const {
+  // Number of satisfied clauses of each match.
+  std::vector<int> satisfied(match_clauses_.size(), 0);
+  auto satisfy = [&satisfied](const std::vector<int>& matches) {
+    for (int match : matches) {
+      ++satisfied[match];
+    }
+  };
 
+  const auto& attributes_map = attributes.attributes();
+  for (const auto& index : attributes_) {
     // Check if required attribure exists with string type.
-    const auto& it = attributes_map.find(name);
+    const auto& it = attributes_map.find(index.name);
     if (it == attributes_map.end() ||
         it->second.value_case() != Attributes_AttributeValue::kStringValue) {
-      return false;
+      continue;
     }
     const std::string& value = it->second.string_value();
 
-    switch (match.match_type_case()) {
-      case StringMatch::kExact:
-        if (value != match.exact()) {
-          return false;
-        }
-        break;
-      case StringMatch::kPrefix:
-        if (value.length() < match.prefix().length() ||
-            value.compare(0, match.prefix().length(), match.prefix()) != 0) {
-          return false;
-        }
-        break;
-      case StringMatch::kRegex: {
-        const auto& reg_it = regex_map_.find(match.regex());
-        // All regex should be pre-build.
-        GOOGLE_CHECK(reg_it != regex_map_.end());
-        if (!std::regex_match(value, reg_it->second)) {
-          return false;
-        }
-      } break;
-      default:
-        // match_type not set case, an empty StringMatch, ignore it.
+    const auto& exact_it = index.exact.find(value);
+    if (exact_it != index.exact.end()) {
+      satisfy(exact_it->second);
+    }
+    for (const auto& prefix : index.prefixes) {
+      if (value.compare(0, prefix.value.length(), prefix.value) == 0) {
+        satisfy(prefix.matches);
+      }
+    }
+    for (const auto& regex : index.regexes) {
+      if (std::regex_match(value, regex.regex)) {
+        satisfy(regex.matches);
+      }
+    }
+    satisfy(index.any);
+  }
+
+  for (const auto& rule : rules_) {
+    bool matched = rule.matches.empty();
+    for (int match : rule.matches) {
+      if (satisfied[match] == match_clauses_[match]) {
+        matched = true;
         break;
+      }
+    }
+    // If not match, applies to all requests.
+    if (matched) {
+      results->insert(results->end(), rule.requirements.begin(),
+                      rule.requirements.end());
     }
   }
-  return true;
 }
 
 std::unique_ptr<ConfigParser> ConfigParser::Create(
@@ -25,6 +25,12 @@ namespace istio {
 namespace quota_config {
 
 // An object to implement ConfigParser interface.
+//
+// The QuotaSpec is compiled into predicates indexed by the attribute they
+// test. Identical predicates are shared by all the rules using them. For a
+// request, each tested attribute is looked up once, its exact values are
+// found by a hash lookup, and each distinct prefix or regex is evaluated
+// once. A match is satisfied when all its predicates are.
 class ConfigParserImpl : public ConfigParser {
  public:
   ConfigParserImpl(
@@ -35,15 +41,41 @@ class ConfigParserImpl : public ConfigParser {
                        std::vector<Requirement>* results) const override;
 
  private:
-  // Check one attribute match.
-  bool MatchAttributes(
-      const ::istio::mixer::v1::config::client::AttributeMatch& match,
-      const ::istio::mixer::v1::Attributes& attributes) const;
-  // the spec proto.
-  const ::istio::mixer::v1::config::client::QuotaSpec& spec_pb_;
-
-  // Stored regex objects.
-  std::unordered_map<std::string, std::regex> regex_map_;
+  // A prefix or regex predicate and the matches it is a clause of.
+  struct Predicate {
+    std::string value;
+    std::regex regex;
+    std::vector<int> matches;
+  };
+
+  // The predicates on one attribute.
+  struct AttributeIndex {
+    std::string name;
+    // Exact value to the matches it is a clause of.
+    std::unordered_map<std::string, std::vector<int>> exact;
+    std::vector<Predicate> prefixes;
+    std::vector<Predicate> regexes;
+    // Matches with an empty StringMatch, any string value matches.
+    std::vector<int> any;
+  };
+
+  struct Rule {
+    // Indexes of the rule's matches, empty to apply to all requests.
+    std::vector<int> matches;
+    std::vector<Requirement> requirements;
+  };
+
+  // Add a clause of match to the index of attribute name.
+  void AddClause(
+      const std::string& name,
+      const ::istio::mixer::v1::config::client::StringMatch& string_match,
+      int match);
+
+  // Indexed attributes.
+  std::vector<AttributeIndex> attributes_;
+  // Number of clauses of each match.
+  std::vector<int> match_clauses_;
+  std::vector<Rule> rules_;
 };
 
 }  // namespace quota_config
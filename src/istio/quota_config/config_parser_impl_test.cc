@@ -88,6 +88,64 @@ rules {
 }
 )";
 
+const char kQuotaSharedMatch[] = R"(
+rules {
+  match {
+    clause {
+      key: "request.path"
+      value {
+        prefix: "/books"
+      }
+    }
+  }
+  quotas {
+    quota: "books"
+    charge: 1
+  }
+}
+rules {
+  match {
+    clause {
+      key: "request.path"
+      value {
+        prefix: "/books"
+      }
+    }
+    clause {
+      key: "request.http_method"
+      value {
+        exact: "POST"
+      }
+    }
+  }
+  quotas {
+    quota: "books-post"
+    charge: 2
+  }
+}
+rules {
+  match {
+    clause {
+      key: "request.path"
+      value {
+        regex: "/books/[0-9]+"
+      }
+    }
+  }
+  match {
+    clause {
+      key: "source.user"
+      value {
+      }
+    }
+  }
+  quotas {
+    quota: "book-or-user"
+    charge: 3
+  }
+}
+)";
+
 // Define similar data structure for quota requirement
 // But this one has operator== for comparison so that EXPECT_EQ
 // can directly use its vector.
@@ -170,6 +228,34 @@ TEST(ConfigParserTest, TestRegexMatch) {
   ASSERT_EQ(GetRequirements(*parser, attributes), QV({{"quota-name", 1}}));
 }
 
+TEST(ConfigParserTest, TestSharedPredicates) {
+  QuotaSpec quota_spec;
+  ASSERT_TRUE(TextFormat::ParseFromString(kQuotaSharedMatch, &quota_spec));
+  auto parser = ConfigParser::Create(quota_spec);
+
+  Attributes attributes;
+  AttributesBuilder builder(&attributes);
+  ASSERT_EQ(GetRequirements(*parser, attributes), QV());
+
+  builder.AddString("request.path", "/books");
+  ASSERT_EQ(GetRequirements(*parser, attributes), QV({{"books", 1}}));
+
+  builder.AddString("request.http_method", "POST");
+  ASSERT_EQ(GetRequirements(*parser, attributes),
+            QV({{"books", 1}, {"books-post", 2}}));
+
+  builder.AddString("request.path", "/books/12");
+  ASSERT_EQ(GetRequirements(*parser, attributes),
+            QV({{"books", 1}, {"books-post", 2}, {"book-or-user", 3}}));
+
+  // An empty StringMatch requires a string attribute.
+  attributes.mutable_attributes()->clear();
+  builder.AddInt64("source.user", 1);
+  ASSERT_EQ(GetRequirements(*parser, attributes), QV());
+  builder.AddString("source.user", "user");
+  ASSERT_EQ(GetRequirements(*parser, attributes), QV({{"book-or-user", 3}}));
+}
+
 }  // namespace
 }  // namespace quota_config
 }  // namespace istio
@@ -0,0 +1,114 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the hit throughput of ShardedLRUCache with a SimpleLRUCache
+// guarded by a mutex, when shared by several threads.
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "include/istio/utils/sharded_lru_cache.h"
+#include "include/istio/utils/simple_lru_cache.h"
+#include "include/istio/utils/simple_lru_cache_inl.h"
+
+namespace istio {
+namespace utils {
+namespace {
+
+const int kKeys = 4096;
+
+std::vector<std::string> CreateKeys() {
+  std::vector<std::string> keys;
+  for (int i = 0; i < kKeys; ++i) {
+    keys.push_back("check-signature-" + std::to_string(i * 7919));
+  }
+  return keys;
+}
+
+const std::vector<std::string>& Keys() {
+  static const auto* keys = new std::vector<std::string>(CreateKeys());
+  return *keys;
+}
+
+// SimpleLRUCache is not thread-safe, so every lookup takes the lock.
+class MutexLRUCache {
+ public:
+  MutexLRUCache() : cache_(kKeys) {
+    for (const auto& key : Keys()) {
+      cache_.Insert(key, new int(1), 1);
+    }
+  }
+  ~MutexLRUCache() { cache_.Clear(); }
+
+  bool Lookup(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SimpleLRUCache<std::string, int>::ScopedLookup lookup(&cache_, key);
+    return lookup.Found() && *lookup.value() == 1;
+  }
+
+ private:
+  std::mutex mutex_;
+  SimpleLRUCache<std::string, int> cache_;
+};
+
+class ShardedCache {
+ public:
+  // Each shard has room for all of its keys.
+  ShardedCache() : cache_(2 * kKeys) {
+    for (const auto& key : Keys()) {
+      cache_.Insert(key, new int(1), 1);
+    }
+  }
+
+  bool Lookup(const std::string& key) {
+    ShardedLRUCache<std::string, int>::ScopedLookup lookup(&cache_, key);
+    return lookup.Found() && *lookup.value() == 1;
+  }
+
+ private:
+  ShardedLRUCache<std::string, int> cache_;
+};
+
+template <class Cache>
+void BM_Hit(benchmark::State& state) {
+  static Cache* cache;
+  if (state.thread_index == 0) {
+    cache = new Cache();
+  }
+  const auto& keys = Keys();
+  size_t i = state.thread_index * 131;
+  int64_t hits = 0;
+  for (auto _ : state) {
+    hits += cache->Lookup(keys[i++ % kKeys]);
+  }
+  if (hits != state.iterations()) {
+    state.SkipWithError("missed");
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index == 0) {
+    delete cache;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_Hit, MutexLRUCache)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Hit, ShardedCache)->ThreadRange(1, 32)->UseRealTime();
+
+}  // namespace
+}  // namespace utils
+}  // namespace istio
+
+BENCHMARK_MAIN();
@@ -0,0 +1,180 @@
+/* Copyright 2020 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/istio/utils/sharded_lru_cache.h"
+
+#include <unistd.h>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace istio {
+namespace utils {
+namespace {
+
+// Counts the live values.
+std::atomic<int> live_values(0);
+
+struct TestValue {
+  explicit TestValue(int label) : label(label) { ++live_values; }
+  ~TestValue() { --live_values; }
+  int label;
+};
+
+typedef ShardedLRUCache<int, TestValue> TestCache;
+
+class ShardedLRUCacheTest : public ::testing::Test {
+ public:
+  void SetUp() override { live_values = 0; }
+  void TearDown() override { EXPECT_EQ(live_values, 0); }
+
+  int Lookup(TestCache* cache, int key) {
+    TestCache::ScopedLookup lookup(cache, key);
+    return lookup.Found() ? lookup.value()->label : -1;
+  }
+};
+
+TEST_F(ShardedLRUCacheTest, TestInsertLookup) {
+  TestCache cache(100);
+  EXPECT_EQ(Lookup(&cache, 1), -1);
+
+  cache.Insert(1, new TestValue(10), 1);
+  cache.Insert(2, new TestValue(20), 2);
+  EXPECT_EQ(Lookup(&cache, 1), 10);
+  EXPECT_EQ(Lookup(&cache, 2), 20);
+  EXPECT_EQ(cache.Entries(), 2);
+  EXPECT_EQ(cache.Size(), 3);
+
+  // Replace the value.
+  cache.Insert(1, new TestValue(11), 5);
+  EXPECT_EQ(Lookup(&cache, 1), 11);
+  EXPECT_EQ(cache.Entries(), 2);
+  EXPECT_EQ(cache.Size(), 7);
+  EXPECT_EQ(live_values, 2);
+
+  cache.Remove(1);
+  EXPECT_EQ(Lookup(&cache, 1), -1);
+  EXPECT_EQ(cache.Entries(), 1);
+  EXPECT_EQ(cache.Size(), 2);
+
+  cache.RemoveAll();
+  EXPECT_EQ(cache.Entries(), 0);
+  EXPECT_EQ(cache.Size(), 0);
+}
+
+TEST_F(ShardedLRUCacheTest, TestPinnedValueOutlivesRemove) {
+  TestCache cache(100);
+  cache.Insert(1, new TestValue(10), 1);
+  {
+    TestCache::ScopedLookup lookup(&cache, 1);
+    ASSERT_TRUE(lookup.Found());
+    cache.Remove(1);
+    cache.Insert(1, new TestValue(11), 1);
+    cache.Remove(1);
+    // The removed value is still pinned.
+    EXPECT_EQ(lookup.value()->label, 10);
+    EXPECT_EQ(live_values, 1);
+  }
+  EXPECT_EQ(live_values, 0);
+}
+
+TEST_F(ShardedLRUCacheTest, TestClockEviction) {
+  // One shard of 4 units.
+  TestCache cache(4, 1);
+  for (int i = 0; i < 4; ++i) {
+    cache.Insert(i, new TestValue(i), 1);
+  }
+  // Referenced entries get a second chance.
+  EXPECT_EQ(Lookup(&cache, 0), 0);
+  EXPECT_EQ(Lookup(&cache, 2), 2);
+
+  cache.Insert(4, new TestValue(4), 1);
+  EXPECT_EQ(Lookup(&cache, 1), -1);
+  cache.Insert(5, new TestValue(5), 1);
+  EXPECT_EQ(Lookup(&cache, 3), -1);
+
+  EXPECT_EQ(Lookup(&cache, 0), 0);
+  EXPECT_EQ(Lookup(&cache, 2), 2);
+  EXPECT_EQ(cache.Entries(), 4);
+  EXPECT_EQ(cache.Size(), 4);
+  EXPECT_EQ(live_values, 4);
+
+  // A large entry evicts as many as needed.
+  cache.Insert(6, new TestValue(6), 3);
+  EXPECT_EQ(cache.Entries(), 2);
+  EXPECT_EQ(cache.Size(), 4);
+  EXPECT_EQ(Lookup(&cache, 6), 6);
+}
+
+TEST_F(ShardedLRUCacheTest, TestShardedSize) {
+  TestCache cache(64, 5);
+  EXPECT_EQ(cache.NumShards(), 8);
+  for (int i = 0; i < 1000; ++i) {
+    cache.Insert(i, new TestValue(i), 1);
+  }
+  EXPECT_LE(cache.Size(), 64);
+  EXPECT_EQ(cache.Size(), cache.Entries());
+  EXPECT_EQ(Lookup(&cache, 999), 999);
+}
+
+TEST_F(ShardedLRUCacheTest, TestAgeBasedEviction) {
+  TestCache cache(100);
+  cache.SetAgeBasedEviction(0.001);
+  cache.Insert(1, new TestValue(10), 1);
+  usleep(5000);
+  cache.Insert(2, new TestValue(20), 1);
+
+  // Expired entries are misses but still counted until removed.
+  EXPECT_EQ(Lookup(&cache, 1), -1);
+  EXPECT_EQ(cache.Entries(), 2);
+
+  cache.RemoveExpiredEntries();
+  EXPECT_LE(cache.Entries(), 1);
+  EXPECT_EQ(live_values, cache.Entries());
+}
+
+TEST_F(ShardedLRUCacheTest, TestConcurrentAccess) {
+  const int kThreads = 8;
+  const int kKeys = 256;
+  TestCache cache(kKeys / 2, 4);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&cache, t]() {
+      for (int i = 0; i < 20000; ++i) {
+        int key = (i * 7 + t) % kKeys;
+        TestCache::ScopedLookup lookup(&cache, key);
+        if (lookup.Found()) {
+          EXPECT_EQ(lookup.value()->label, key);
+        } else if (i % 5 == 0) {
+          cache.Remove(key);
+        } else {
+          cache.Insert(key, new TestValue(key), 1);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(cache.Size(), kKeys / 2);
+  EXPECT_EQ(live_values, cache.Entries());
+  cache.RemoveAll();
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace istio